@@ -0,0 +1,2129 @@
+#ifndef _INTVEC_
+#define _INTVEC_
+
+#include <stdlib.h>
+#include <assert.h>
+
+#ifndef CORE_STAGED_CHECK
+#   ifdef _CORE_H_
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) CORE_FATAL_ERROR(msg); } while(0)
+#   else
+#       include <stdio.h>
+#       include <stdlib.h>
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg); abort(); } } while(0)
+#   endif
+#endif /*CORE_STAGED_CHECK*/
+
+typedef struct {
+    int * items;
+    unsigned long len;
+    unsigned long cap;
+} IntVec;
+
+void intvec_ensure_capacity(IntVec * vec, unsigned long capacity) {
+    if(vec->items == NULL || vec->cap <= 0) {
+        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), "vec capacity overflow");
+        vec->cap = capacity;
+        vec->items = malloc(vec->cap * sizeof(vec->items[0]));
+        CORE_STAGED_CHECK(vec->items != NULL || capacity == 0, "vec allocation failed");
+        vec->len = 0;
+    } else if(vec->cap < capacity) {
+        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / 2 / sizeof(vec->items[0]), "vec capacity overflow");
+        vec->cap = capacity * 2;
+        vec->items = realloc(vec->items, vec->cap * sizeof(vec->items[0]));
+        CORE_STAGED_CHECK(vec->items != NULL, "vec allocation failed");
+    }
+    assert(vec->cap >= capacity);
+}
+
+#ifdef _CORE_H_
+void intvec_ensure_capacity_via_arena(IntVec * vec, core_Arena * arena, unsigned long capacity) {
+    if(vec->items == NULL || vec->cap <= 0) {
+        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), "vec capacity overflow");
+        vec->cap = capacity;
+        vec->items = core_arena_check_alloc(core_arena_alloc(arena, vec->cap * sizeof(vec->items[0])));
+        vec->len = 0;
+    } else if(vec->cap < capacity) {
+        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / 2 / sizeof(vec->items[0]), "vec capacity overflow");
+        vec->cap = capacity * 2;
+        vec->items = core_arena_check_alloc(core_arena_realloc(arena, vec->items, vec->cap * sizeof(vec->items[0])));
+    }
+    assert(vec->cap >= capacity);
+}
+#endif /*_CORE_H_*/
+
+#ifdef _CORE_H_
+void intvec_init_aligned_via_arena(IntVec * vec, core_Arena * arena, unsigned long capacity, unsigned long align) {
+    assert(vec->items == NULL || vec->cap <= 0);
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), "vec capacity overflow");
+    vec->cap = capacity;
+    vec->items = core_arena_check_alloc(core_arena_alloc_aligned(arena, vec->cap * sizeof(vec->items[0]), align));
+    vec->len = 0;
+}
+#endif /*_CORE_H_*/
+
+void intvec_append(IntVec * vec, int item) {
+    intvec_ensure_capacity(vec, vec->len + 1);
+    vec->items[vec->len++] = item;
+}
+
+#ifdef _CORE_H_
+void intvec_append_via_arena(IntVec * vec, core_Arena * arena, int item) {
+    intvec_ensure_capacity_via_arena(vec, arena, vec->len + 1);
+    vec->items[vec->len++] = item;
+}
+#endif /*_CORE_H_*/
+
+void intvec_free(IntVec * vec) {
+    if(vec->items != NULL || vec->cap > 0) {
+        free(vec->items);
+    }
+    vec->len = 0;
+    vec->cap = 0;
+    vec->items = NULL;
+}
+
+void intvec_append_n_times(IntVec * vec, int item, unsigned long times) {
+    unsigned long i = 0;
+    intvec_ensure_capacity(vec, vec->len + times);
+    for(i = 0; i < times; ++i) {
+        vec->items[vec->len + i] = item;
+    }
+    vec->len += times;
+}
+
+void intvec_ensure_length(IntVec * vec, int default_value, unsigned long minimum_length) {
+    if(vec->len >= minimum_length) return;
+    intvec_append_n_times(vec, default_value, minimum_length - vec->len);
+    assert(vec->len >= minimum_length);
+}
+
+int intvec_get(IntVec * vec, unsigned long index) {
+    assert(index < vec->len);
+    return vec->items[index];
+}
+
+int intvec_pop(IntVec * vec) {
+    assert(vec->len > 0);
+    return vec->items[--vec->len];
+}
+
+#endif /*_INTVEC_*/
+
+#ifndef _INTSORT_
+#define _INTSORT_
+
+#define INT_SORT_LESS(a, b) ((a) < (b))
+
+void _intarray_insertion_sort(int * items, long lo, long hi) {
+    long i = 0;
+    long j = 0;
+    int tmp;
+    for(i = lo + 1; i <= hi; ++i) {
+        tmp = items[i];
+        for(j = i; j > lo && INT_SORT_LESS(tmp, items[j - 1]); --j) {
+            items[j] = items[j - 1];
+        }
+        items[j] = tmp;
+    }
+}
+
+void _intarray_sift_down(int * items, long root, long len) {
+    int tmp = items[root];
+    long child = 0;
+    while((child = 2 * root + 1) < len) {
+        if(child + 1 < len && INT_SORT_LESS(items[child], items[child + 1])) ++child;
+        if(!INT_SORT_LESS(tmp, items[child])) break;
+        items[root] = items[child];
+        root = child;
+    }
+    items[root] = tmp;
+}
+
+void _intarray_heap_sort(int * items, long len) {
+    long i = 0;
+    int tmp;
+    for(i = len / 2 - 1; i >= 0; --i) {
+        _intarray_sift_down(items, i, len);
+    }
+    for(i = len - 1; i > 0; --i) {
+        tmp = items[0];
+        items[0] = items[i];
+        items[i] = tmp;
+        _intarray_sift_down(items, 0, i);
+    }
+}
+
+/*quicksort that falls back to heapsort when the recursion gets too deep and to insertion sort for short ranges*/
+void _intarray_intro_sort(int * items, long lo, long hi, int depth) {
+    long i = 0;
+    long j = 0;
+    long mid = 0;
+    int pivot;
+    int tmp;
+    while(hi - lo > 16) {
+        if(depth-- == 0) {
+            _intarray_heap_sort(items + lo, hi - lo + 1);
+            return;
+        }
+        mid = lo + (hi - lo) / 2;
+        if(INT_SORT_LESS(items[mid], items[lo])) { tmp = items[mid]; items[mid] = items[lo]; items[lo] = tmp; }
+        if(INT_SORT_LESS(items[hi], items[mid])) { tmp = items[hi]; items[hi] = items[mid]; items[mid] = tmp; }
+        if(INT_SORT_LESS(items[mid], items[lo])) { tmp = items[mid]; items[mid] = items[lo]; items[lo] = tmp; }
+        pivot = items[mid];
+        i = lo - 1;
+        j = hi + 1;
+        for(;;) {
+            do ++i; while(INT_SORT_LESS(items[i], pivot));
+            do --j; while(INT_SORT_LESS(pivot, items[j]));
+            if(i >= j) break;
+            tmp = items[i];
+            items[i] = items[j];
+            items[j] = tmp;
+        }
+        /*recurse into the smaller half so the stack stays O(log n)*/
+        if(j - lo < hi - j) {
+            _intarray_intro_sort(items, lo, j, depth);
+            lo = j + 1;
+        } else {
+            _intarray_intro_sort(items, j + 1, hi, depth);
+            hi = j;
+        }
+    }
+    _intarray_insertion_sort(items, lo, hi);
+}
+
+void intarray_sort(int * items, unsigned long len) {
+    int depth = 0;
+    unsigned long n = 0;
+    for(n = len; n > 1; n >>= 1) depth += 2;
+    if(len > 1) _intarray_intro_sort(items, 0, (long)len - 1, depth);
+}
+
+/*index of the first item not less than key*/
+unsigned long intarray_lower_bound(int * items, unsigned long len, int key) {
+    unsigned long lo = 0;
+    unsigned long step = 0;
+    while(len > 0) {
+        step = len / 2;
+        if(INT_SORT_LESS(items[lo + step], key)) {
+            lo += step + 1;
+            len -= step + 1;
+        } else {
+            len = step;
+        }
+    }
+    return lo;
+}
+
+/*index of the first item greater than key*/
+unsigned long intarray_upper_bound(int * items, unsigned long len, int key) {
+    unsigned long lo = 0;
+    unsigned long step = 0;
+    while(len > 0) {
+        step = len / 2;
+        if(!INT_SORT_LESS(key, items[lo + step])) {
+            lo += step + 1;
+            len -= step + 1;
+        } else {
+            len = step;
+        }
+    }
+    return lo;
+}
+
+#ifdef _INTVEC_
+void intvec_sort(IntVec * vec) {
+    intarray_sort(vec->items, vec->len);
+}
+
+unsigned long intvec_lower_bound(IntVec * vec, int key) {
+    return intarray_lower_bound(vec->items, vec->len, key);
+}
+
+unsigned long intvec_upper_bound(IntVec * vec, int key) {
+    return intarray_upper_bound(vec->items, vec->len, key);
+}
+#endif /*_INTVEC_*/
+
+#endif /*_INTSORT_*/
+
+#ifndef _INTRADIXSORT_
+#define _INTRADIXSORT_
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef CORE_STAGED_CHECK
+#   ifdef _CORE_H_
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) CORE_FATAL_ERROR(msg); } while(0)
+#   else
+#       include <stdio.h>
+#       include <stdlib.h>
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg); abort(); } } while(0)
+#   endif
+#endif /*CORE_STAGED_CHECK*/
+
+void intarray_radix_sort(int * items, unsigned long len, int * scratch) {
+    unsigned long counts[256];
+    unsigned long i = 0;
+    unsigned long total = 0;
+    unsigned long count = 0;
+    unsigned int pass = 0;
+    unsigned int shift = 0;
+    unsigned int flip = 0;
+    int * src = items;
+    int * dst = scratch;
+    int * tmp = NULL;
+    if(len < 2) return;
+    for(pass = 0; pass < sizeof(int); ++pass) {
+        shift = pass * 8;
+        /*flipping the sign bit orders negative numbers first*/
+        flip = pass + 1 == sizeof(int) ? 128U : 0U;
+        memset(counts, 0, sizeof(counts));
+        for(i = 0; i < len; ++i) {
+            ++counts[(((unsigned int)(src[i] >> shift)) & 0xffU) ^ flip];
+        }
+        /*skip the pass if every key has the same digit*/
+        if(counts[(((unsigned int)(src[0] >> shift)) & 0xffU) ^ flip] == len) continue;
+        for(i = 0, total = 0; i < 256; ++i) {
+            count = counts[i];
+            counts[i] = total;
+            total += count;
+        }
+        for(i = 0; i < len; ++i) {
+            dst[counts[(((unsigned int)(src[i] >> shift)) & 0xffU) ^ flip]++] = src[i];
+        }
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if(src != items) memcpy(items, src, len * sizeof(items[0]));
+}
+
+#ifdef _INTVEC_
+void intvec_radix_sort(IntVec * vec) {
+    int * scratch = NULL;
+    if(vec->len < 2) return;
+    scratch = malloc(vec->len * sizeof(vec->items[0]));
+    CORE_STAGED_CHECK(scratch != NULL, "radix sort allocation failed");
+    intarray_radix_sort(vec->items, vec->len, scratch);
+    free(scratch);
+}
+
+#ifdef _CORE_H_
+void intvec_radix_sort_via_arena(IntVec * vec, core_Arena * arena) {
+    int * scratch = NULL;
+    if(vec->len < 2) return;
+    scratch = core_arena_check_alloc(core_arena_alloc(arena, vec->len * sizeof(vec->items[0])));
+    intarray_radix_sort(vec->items, vec->len, scratch);
+    core_arena_reclaim_memory(arena, scratch);
+}
+#endif /*_CORE_H_*/
+#endif /*_INTVEC_*/
+
+#endif /*_INTRADIXSORT_*/
+
+#ifndef _LONGSORT_
+#define _LONGSORT_
+
+#define LONG_SORT_LESS(a, b) (LONG_GREATER(a, b))
+
+void _longarray_insertion_sort(long * items, long lo, long hi) {
+    long i = 0;
+    long j = 0;
+    long tmp;
+    for(i = lo + 1; i <= hi; ++i) {
+        tmp = items[i];
+        for(j = i; j > lo && LONG_SORT_LESS(tmp, items[j - 1]); --j) {
+            items[j] = items[j - 1];
+        }
+        items[j] = tmp;
+    }
+}
+
+void _longarray_sift_down(long * items, long root, long len) {
+    long tmp = items[root];
+    long child = 0;
+    while((child = 2 * root + 1) < len) {
+        if(child + 1 < len && LONG_SORT_LESS(items[child], items[child + 1])) ++child;
+        if(!LONG_SORT_LESS(tmp, items[child])) break;
+        items[root] = items[child];
+        root = child;
+    }
+    items[root] = tmp;
+}
+
+void _longarray_heap_sort(long * items, long len) {
+    long i = 0;
+    long tmp;
+    for(i = len / 2 - 1; i >= 0; --i) {
+        _longarray_sift_down(items, i, len);
+    }
+    for(i = len - 1; i > 0; --i) {
+        tmp = items[0];
+        items[0] = items[i];
+        items[i] = tmp;
+        _longarray_sift_down(items, 0, i);
+    }
+}
+
+/*quicksort that falls back to heapsort when the recursion gets too deep and to insertion sort for short ranges*/
+void _longarray_intro_sort(long * items, long lo, long hi, int depth) {
+    long i = 0;
+    long j = 0;
+    long mid = 0;
+    long pivot;
+    long tmp;
+    while(hi - lo > 16) {
+        if(depth-- == 0) {
+            _longarray_heap_sort(items + lo, hi - lo + 1);
+            return;
+        }
+        mid = lo + (hi - lo) / 2;
+        if(LONG_SORT_LESS(items[mid], items[lo])) { tmp = items[mid]; items[mid] = items[lo]; items[lo] = tmp; }
+        if(LONG_SORT_LESS(items[hi], items[mid])) { tmp = items[hi]; items[hi] = items[mid]; items[mid] = tmp; }
+        if(LONG_SORT_LESS(items[mid], items[lo])) { tmp = items[mid]; items[mid] = items[lo]; items[lo] = tmp; }
+        pivot = items[mid];
+        i = lo - 1;
+        j = hi + 1;
+        for(;;) {
+            do ++i; while(LONG_SORT_LESS(items[i], pivot));
+            do --j; while(LONG_SORT_LESS(pivot, items[j]));
+            if(i >= j) break;
+            tmp = items[i];
+            items[i] = items[j];
+            items[j] = tmp;
+        }
+        /*recurse into the smaller half so the stack stays O(log n)*/
+        if(j - lo < hi - j) {
+            _longarray_intro_sort(items, lo, j, depth);
+            lo = j + 1;
+        } else {
+            _longarray_intro_sort(items, j + 1, hi, depth);
+            hi = j;
+        }
+    }
+    _longarray_insertion_sort(items, lo, hi);
+}
+
+void longarray_sort(long * items, unsigned long len) {
+    int depth = 0;
+    unsigned long n = 0;
+    for(n = len; n > 1; n >>= 1) depth += 2;
+    if(len > 1) _longarray_intro_sort(items, 0, (long)len - 1, depth);
+}
+
+/*index of the first item not less than key*/
+unsigned long longarray_lower_bound(long * items, unsigned long len, long key) {
+    unsigned long lo = 0;
+    unsigned long step = 0;
+    while(len > 0) {
+        step = len / 2;
+        if(LONG_SORT_LESS(items[lo + step], key)) {
+            lo += step + 1;
+            len -= step + 1;
+        } else {
+            len = step;
+        }
+    }
+    return lo;
+}
+
+/*index of the first item greater than key*/
+unsigned long longarray_upper_bound(long * items, unsigned long len, long key) {
+    unsigned long lo = 0;
+    unsigned long step = 0;
+    while(len > 0) {
+        step = len / 2;
+        if(!LONG_SORT_LESS(key, items[lo + step])) {
+            lo += step + 1;
+            len -= step + 1;
+        } else {
+            len = step;
+        }
+    }
+    return lo;
+}
+
+#ifdef _LONGVEC_
+void longvec_sort(LongVec * vec) {
+    longarray_sort(vec->items, vec->len);
+}
+
+unsigned long longvec_lower_bound(LongVec * vec, long key) {
+    return longarray_lower_bound(vec->items, vec->len, key);
+}
+
+unsigned long longvec_upper_bound(LongVec * vec, long key) {
+    return longarray_upper_bound(vec->items, vec->len, key);
+}
+#endif /*_LONGVEC_*/
+
+#endif /*_LONGSORT_*/
+
+#ifndef _INTNUMERIC_
+#define _INTNUMERIC_
+
+#include <assert.h>
+
+#define INT_NUMERIC_EQ(a, b) ((a) <= (b) && (a) >= (b))
+
+void intarray_fill(int * items, unsigned long len, int value) {
+    unsigned long i = 0;
+    for(i = 0; i < len; ++i) {
+        items[i] = value;
+    }
+}
+
+/*returns len when value is not found*/
+unsigned long intarray_find(int * items, unsigned long len, int value) {
+    unsigned long i = 0;
+    unsigned long k = 0;
+    int hit = 0;
+    for(; i + 8 <= len; i += 8) {
+        for(k = 0, hit = 0; k < 8; ++k) hit |= INT_NUMERIC_EQ(items[i + k], value);
+        if(hit) break;
+    }
+    for(; i < len; ++i) {
+        if(INT_NUMERIC_EQ(items[i], value)) return i;
+    }
+    return len;
+}
+
+unsigned long intarray_count(int * items, unsigned long len, int value) {
+    unsigned long i = 0;
+    unsigned long result = 0;
+    for(i = 0; i < len; ++i) {
+        result += (unsigned long)INT_NUMERIC_EQ(items[i], value);
+    }
+    return result;
+}
+
+int intarray_min(int * items, unsigned long len) {
+    int lanes[8];
+    unsigned long i = 0;
+    unsigned long k = 0;
+    assert(len > 0);
+    for(k = 0; k < 8; ++k) lanes[k] = items[0];
+    for(; i + 8 <= len; i += 8) {
+        for(k = 0; k < 8; ++k) lanes[k] = items[i + k] < lanes[k] ? items[i + k] : lanes[k];
+    }
+    for(; i < len; ++i) lanes[0] = items[i] < lanes[0] ? items[i] : lanes[0];
+    for(k = 1; k < 8; ++k) lanes[0] = lanes[k] < lanes[0] ? lanes[k] : lanes[0];
+    return lanes[0];
+}
+
+int intarray_max(int * items, unsigned long len) {
+    int lanes[8];
+    unsigned long i = 0;
+    unsigned long k = 0;
+    assert(len > 0);
+    for(k = 0; k < 8; ++k) lanes[k] = items[0];
+    for(; i + 8 <= len; i += 8) {
+        for(k = 0; k < 8; ++k) lanes[k] = items[i + k] > lanes[k] ? items[i + k] : lanes[k];
+    }
+    for(; i < len; ++i) lanes[0] = items[i] > lanes[0] ? items[i] : lanes[0];
+    for(k = 1; k < 8; ++k) lanes[0] = lanes[k] > lanes[0] ? lanes[k] : lanes[0];
+    return lanes[0];
+}
+
+/*summed in the element type, so integer sums can overflow*/
+int intarray_sum(int * items, unsigned long len) {
+    int lanes[8] = {0};
+    unsigned long i = 0;
+    unsigned long k = 0;
+    for(; i + 8 <= len; i += 8) {
+        for(k = 0; k < 8; ++k) lanes[k] = (int)(lanes[k] + items[i + k]);
+    }
+    for(; i < len; ++i) lanes[0] = (int)(lanes[0] + items[i]);
+    for(k = 1; k < 8; ++k) lanes[0] = (int)(lanes[0] + lanes[k]);
+    return lanes[0];
+}
+
+/*dst may be the same array as lhs or rhs*/
+void intarray_add(int * dst, int * lhs, int * rhs, unsigned long len) {
+    unsigned long i = 0;
+    for(i = 0; i < len; ++i) {
+        dst[i] = (int)(lhs[i] + rhs[i]);
+    }
+}
+
+void intarray_scale(int * items, unsigned long len, int factor) {
+    unsigned long i = 0;
+    for(i = 0; i < len; ++i) {
+        items[i] = (int)(items[i] * factor);
+    }
+}
+
+#ifdef _INTVEC_
+void intvec_fill(IntVec * vec, int value) {
+    intarray_fill(vec->items, vec->len, value);
+}
+
+unsigned long intvec_find(IntVec * vec, int value) {
+    return intarray_find(vec->items, vec->len, value);
+}
+
+unsigned long intvec_count(IntVec * vec, int value) {
+    return intarray_count(vec->items, vec->len, value);
+}
+
+int intvec_min(IntVec * vec) {
+    return intarray_min(vec->items, vec->len);
+}
+
+int intvec_max(IntVec * vec) {
+    return intarray_max(vec->items, vec->len);
+}
+
+int intvec_sum(IntVec * vec) {
+    return intarray_sum(vec->items, vec->len);
+}
+
+void intvec_add(IntVec * dst, IntVec * lhs, IntVec * rhs) {
+    assert(dst->len == lhs->len && lhs->len == rhs->len);
+    intarray_add(dst->items, lhs->items, rhs->items, dst->len);
+}
+
+void intvec_scale(IntVec * vec, int factor) {
+    intarray_scale(vec->items, vec->len, factor);
+}
+#endif /*_INTVEC_*/
+
+#endif /*_INTNUMERIC_*/
+
+#ifndef _DOUBLEVEC_
+#define _DOUBLEVEC_
+
+#include <stdlib.h>
+#include <assert.h>
+
+#ifndef CORE_STAGED_CHECK
+#   ifdef _CORE_H_
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) CORE_FATAL_ERROR(msg); } while(0)
+#   else
+#       include <stdio.h>
+#       include <stdlib.h>
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg); abort(); } } while(0)
+#   endif
+#endif /*CORE_STAGED_CHECK*/
+
+typedef struct {
+    double * items;
+    unsigned long len;
+    unsigned long cap;
+} DoubleVec;
+
+void doublevec_ensure_capacity(DoubleVec * vec, unsigned long capacity) {
+    if(vec->items == NULL || vec->cap <= 0) {
+        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), "vec capacity overflow");
+        vec->cap = capacity;
+        vec->items = malloc(vec->cap * sizeof(vec->items[0]));
+        CORE_STAGED_CHECK(vec->items != NULL || capacity == 0, "vec allocation failed");
+        vec->len = 0;
+    } else if(vec->cap < capacity) {
+        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / 2 / sizeof(vec->items[0]), "vec capacity overflow");
+        vec->cap = capacity * 2;
+        vec->items = realloc(vec->items, vec->cap * sizeof(vec->items[0]));
+        CORE_STAGED_CHECK(vec->items != NULL, "vec allocation failed");
+    }
+    assert(vec->cap >= capacity);
+}
+
+#ifdef _CORE_H_
+void doublevec_ensure_capacity_via_arena(DoubleVec * vec, core_Arena * arena, unsigned long capacity) {
+    if(vec->items == NULL || vec->cap <= 0) {
+        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), "vec capacity overflow");
+        vec->cap = capacity;
+        vec->items = core_arena_check_alloc(core_arena_alloc(arena, vec->cap * sizeof(vec->items[0])));
+        vec->len = 0;
+    } else if(vec->cap < capacity) {
+        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / 2 / sizeof(vec->items[0]), "vec capacity overflow");
+        vec->cap = capacity * 2;
+        vec->items = core_arena_check_alloc(core_arena_realloc(arena, vec->items, vec->cap * sizeof(vec->items[0])));
+    }
+    assert(vec->cap >= capacity);
+}
+#endif /*_CORE_H_*/
+
+#ifdef _CORE_H_
+void doublevec_init_aligned_via_arena(DoubleVec * vec, core_Arena * arena, unsigned long capacity, unsigned long align) {
+    assert(vec->items == NULL || vec->cap <= 0);
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), "vec capacity overflow");
+    vec->cap = capacity;
+    vec->items = core_arena_check_alloc(core_arena_alloc_aligned(arena, vec->cap * sizeof(vec->items[0]), align));
+    vec->len = 0;
+}
+#endif /*_CORE_H_*/
+
+void doublevec_append(DoubleVec * vec, double item) {
+    doublevec_ensure_capacity(vec, vec->len + 1);
+    vec->items[vec->len++] = item;
+}
+
+#ifdef _CORE_H_
+void doublevec_append_via_arena(DoubleVec * vec, core_Arena * arena, double item) {
+    doublevec_ensure_capacity_via_arena(vec, arena, vec->len + 1);
+    vec->items[vec->len++] = item;
+}
+#endif /*_CORE_H_*/
+
+void doublevec_free(DoubleVec * vec) {
+    if(vec->items != NULL || vec->cap > 0) {
+        free(vec->items);
+    }
+    vec->len = 0;
+    vec->cap = 0;
+    vec->items = NULL;
+}
+
+void doublevec_append_n_times(DoubleVec * vec, double item, unsigned long times) {
+    unsigned long i = 0;
+    doublevec_ensure_capacity(vec, vec->len + times);
+    for(i = 0; i < times; ++i) {
+        vec->items[vec->len + i] = item;
+    }
+    vec->len += times;
+}
+
+void doublevec_ensure_length(DoubleVec * vec, double default_value, unsigned long minimum_length) {
+    if(vec->len >= minimum_length) return;
+    doublevec_append_n_times(vec, default_value, minimum_length - vec->len);
+    assert(vec->len >= minimum_length);
+}
+
+double doublevec_get(DoubleVec * vec, unsigned long index) {
+    assert(index < vec->len);
+    return vec->items[index];
+}
+
+double doublevec_pop(DoubleVec * vec) {
+    assert(vec->len > 0);
+    return vec->items[--vec->len];
+}
+
+#endif /*_DOUBLEVEC_*/
+
+#ifndef _DOUBLENUMERIC_
+#define _DOUBLENUMERIC_
+
+#include <assert.h>
+
+#define DOUBLE_NUMERIC_EQ(a, b) ((a) <= (b) && (a) >= (b))
+
+void doublearray_fill(double * items, unsigned long len, double value) {
+    unsigned long i = 0;
+    for(i = 0; i < len; ++i) {
+        items[i] = value;
+    }
+}
+
+/*returns len when value is not found*/
+unsigned long doublearray_find(double * items, unsigned long len, double value) {
+    unsigned long i = 0;
+    unsigned long k = 0;
+    int hit = 0;
+    for(; i + 8 <= len; i += 8) {
+        for(k = 0, hit = 0; k < 8; ++k) hit |= DOUBLE_NUMERIC_EQ(items[i + k], value);
+        if(hit) break;
+    }
+    for(; i < len; ++i) {
+        if(DOUBLE_NUMERIC_EQ(items[i], value)) return i;
+    }
+    return len;
+}
+
+unsigned long doublearray_count(double * items, unsigned long len, double value) {
+    unsigned long i = 0;
+    unsigned long result = 0;
+    for(i = 0; i < len; ++i) {
+        result += (unsigned long)DOUBLE_NUMERIC_EQ(items[i], value);
+    }
+    return result;
+}
+
+double doublearray_min(double * items, unsigned long len) {
+    double lanes[8];
+    unsigned long i = 0;
+    unsigned long k = 0;
+    assert(len > 0);
+    for(k = 0; k < 8; ++k) lanes[k] = items[0];
+    for(; i + 8 <= len; i += 8) {
+        for(k = 0; k < 8; ++k) lanes[k] = items[i + k] < lanes[k] ? items[i + k] : lanes[k];
+    }
+    for(; i < len; ++i) lanes[0] = items[i] < lanes[0] ? items[i] : lanes[0];
+    for(k = 1; k < 8; ++k) lanes[0] = lanes[k] < lanes[0] ? lanes[k] : lanes[0];
+    return lanes[0];
+}
+
+double doublearray_max(double * items, unsigned long len) {
+    double lanes[8];
+    unsigned long i = 0;
+    unsigned long k = 0;
+    assert(len > 0);
+    for(k = 0; k < 8; ++k) lanes[k] = items[0];
+    for(; i + 8 <= len; i += 8) {
+        for(k = 0; k < 8; ++k) lanes[k] = items[i + k] > lanes[k] ? items[i + k] : lanes[k];
+    }
+    for(; i < len; ++i) lanes[0] = items[i] > lanes[0] ? items[i] : lanes[0];
+    for(k = 1; k < 8; ++k) lanes[0] = lanes[k] > lanes[0] ? lanes[k] : lanes[0];
+    return lanes[0];
+}
+
+/*summed in the element type, so integer sums can overflow*/
+double doublearray_sum(double * items, unsigned long len) {
+    double lanes[8] = {0};
+    unsigned long i = 0;
+    unsigned long k = 0;
+    for(; i + 8 <= len; i += 8) {
+        for(k = 0; k < 8; ++k) lanes[k] = (double)(lanes[k] + items[i + k]);
+    }
+    for(; i < len; ++i) lanes[0] = (double)(lanes[0] + items[i]);
+    for(k = 1; k < 8; ++k) lanes[0] = (double)(lanes[0] + lanes[k]);
+    return lanes[0];
+}
+
+/*dst may be the same array as lhs or rhs*/
+void doublearray_add(double * dst, double * lhs, double * rhs, unsigned long len) {
+    unsigned long i = 0;
+    for(i = 0; i < len; ++i) {
+        dst[i] = (double)(lhs[i] + rhs[i]);
+    }
+}
+
+void doublearray_scale(double * items, unsigned long len, double factor) {
+    unsigned long i = 0;
+    for(i = 0; i < len; ++i) {
+        items[i] = (double)(items[i] * factor);
+    }
+}
+
+#ifdef _DOUBLEVEC_
+void doublevec_fill(DoubleVec * vec, double value) {
+    doublearray_fill(vec->items, vec->len, value);
+}
+
+unsigned long doublevec_find(DoubleVec * vec, double value) {
+    return doublearray_find(vec->items, vec->len, value);
+}
+
+unsigned long doublevec_count(DoubleVec * vec, double value) {
+    return doublearray_count(vec->items, vec->len, value);
+}
+
+double doublevec_min(DoubleVec * vec) {
+    return doublearray_min(vec->items, vec->len);
+}
+
+double doublevec_max(DoubleVec * vec) {
+    return doublearray_max(vec->items, vec->len);
+}
+
+double doublevec_sum(DoubleVec * vec) {
+    return doublearray_sum(vec->items, vec->len);
+}
+
+void doublevec_add(DoubleVec * dst, DoubleVec * lhs, DoubleVec * rhs) {
+    assert(dst->len == lhs->len && lhs->len == rhs->len);
+    doublearray_add(dst->items, lhs->items, rhs->items, dst->len);
+}
+
+void doublevec_scale(DoubleVec * vec, double factor) {
+    doublearray_scale(vec->items, vec->len, factor);
+}
+#endif /*_DOUBLEVEC_*/
+
+#endif /*_DOUBLENUMERIC_*/
+
+#ifndef _INTSMALLVEC_
+#define _INTSMALLVEC_
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef CORE_STAGED_CHECK
+#   ifdef _CORE_H_
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) CORE_FATAL_ERROR(msg); } while(0)
+#   else
+#       include <stdio.h>
+#       include <stdlib.h>
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg); abort(); } } while(0)
+#   endif
+#endif /*CORE_STAGED_CHECK*/
+
+typedef struct {
+    int * items;
+    unsigned long len;
+    unsigned long cap;
+    int inline_items[4];
+} IntSmallVec;
+
+int * intsmallvec_items(IntSmallVec * vec) {
+    return vec->items == NULL ? vec->inline_items : vec->items;
+}
+
+unsigned long intsmallvec_capacity(IntSmallVec * vec) {
+    return vec->items == NULL ? 4UL : vec->cap;
+}
+
+void intsmallvec_ensure_capacity(IntSmallVec * vec, unsigned long capacity) {
+    if(capacity <= intsmallvec_capacity(vec)) return;
+    if(capacity < intsmallvec_capacity(vec) * 2) capacity = intsmallvec_capacity(vec) * 2;
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), "smallvec capacity overflow");
+    if(vec->items == NULL) {
+        vec->items = malloc(capacity * sizeof(vec->items[0]));
+        CORE_STAGED_CHECK(vec->items != NULL, "smallvec allocation failed");
+        memcpy(vec->items, vec->inline_items, vec->len * sizeof(vec->items[0]));
+    } else {
+        vec->items = realloc(vec->items, capacity * sizeof(vec->items[0]));
+        CORE_STAGED_CHECK(vec->items != NULL, "smallvec allocation failed");
+    }
+    vec->cap = capacity;
+}
+
+#ifdef _CORE_H_
+void intsmallvec_ensure_capacity_via_arena(IntSmallVec * vec, core_Arena * arena, unsigned long capacity) {
+    if(capacity <= intsmallvec_capacity(vec)) return;
+    if(capacity < intsmallvec_capacity(vec) * 2) capacity = intsmallvec_capacity(vec) * 2;
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), "smallvec capacity overflow");
+    if(vec->items == NULL) {
+        vec->items = core_arena_check_alloc(core_arena_alloc(arena, capacity * sizeof(vec->items[0])));
+        memcpy(vec->items, vec->inline_items, vec->len * sizeof(vec->items[0]));
+    } else {
+        vec->items = core_arena_check_alloc(core_arena_realloc(arena, vec->items, capacity * sizeof(vec->items[0])));
+    }
+    vec->cap = capacity;
+}
+#endif /*_CORE_H_*/
+
+void intsmallvec_append(IntSmallVec * vec, int item) {
+    intsmallvec_ensure_capacity(vec, vec->len + 1);
+    intsmallvec_items(vec)[vec->len++] = item;
+}
+
+#ifdef _CORE_H_
+void intsmallvec_append_via_arena(IntSmallVec * vec, core_Arena * arena, int item) {
+    intsmallvec_ensure_capacity_via_arena(vec, arena, vec->len + 1);
+    intsmallvec_items(vec)[vec->len++] = item;
+}
+#endif /*_CORE_H_*/
+
+int intsmallvec_get(IntSmallVec * vec, unsigned long index) {
+    assert(index < vec->len);
+    return intsmallvec_items(vec)[index];
+}
+
+int intsmallvec_pop(IntSmallVec * vec) {
+    assert(vec->len > 0);
+    return intsmallvec_items(vec)[--vec->len];
+}
+
+/*only for vecs grown with smallvec_append, arena backed ones are freed with the arena*/
+void intsmallvec_free(IntSmallVec * vec) {
+    free(vec->items);
+    vec->items = NULL;
+    vec->len = 0;
+    vec->cap = 0;
+}
+
+#endif /*_INTSMALLVEC_*/
+
+#ifndef _INTSLICE_
+#define _INTSLICE_
+
+#include <assert.h>
+
+typedef struct {
+   int * ptr;
+   unsigned long len;
+} IntSlice;
+
+IntSlice intslice_init(int * items, unsigned long count) {
+    IntSlice result = {0};
+    result.ptr = items;
+    result.len = count;
+    return result;
+}
+
+#define INTSLICE_FROM_ARRAY(array) intslice_init(array, (sizeof(array) / sizeof(array[0])))
+
+IntSlice intslice_get_first_n_items(IntSlice slice, unsigned long n) {
+    IntSlice result = slice;
+    assert(n <= slice.len);
+    result.len = n;
+    return result;
+}
+
+IntSlice intslice_get_last_n_items(IntSlice slice, unsigned long n) {
+    IntSlice result = slice;
+    assert(n <= slice.len);
+    result.len = n;
+    result.ptr += slice.len - n;
+    return result;
+}
+
+IntSlice intslice_trim_first_n_items(IntSlice slice, unsigned long n) {
+    IntSlice result = slice;
+    assert(n <= slice.len);
+    result.len = slice.len - n;
+    result.ptr += n;
+    return result;
+}
+
+IntSlice intslice_trim_last_n_items(IntSlice slice, unsigned long n) {
+    IntSlice result = slice;
+    assert(n <= slice.len);
+    result.len = slice.len - n;
+    return result;
+}
+
+#endif /*_INTSLICE_*/
+
+#ifndef _LONGSLICE_
+#define _LONGSLICE_
+
+#include <assert.h>
+
+typedef struct {
+   long * ptr;
+   unsigned long len;
+} LongSlice;
+
+LongSlice longslice_init(long * items, unsigned long count) {
+    LongSlice result = {0};
+    result.ptr = items;
+    result.len = count;
+    return result;
+}
+
+#define LONGSLICE_FROM_ARRAY(array) longslice_init(array, (sizeof(array) / sizeof(array[0])))
+
+LongSlice longslice_get_first_n_items(LongSlice slice, unsigned long n) {
+    LongSlice result = slice;
+    assert(n <= slice.len);
+    result.len = n;
+    return result;
+}
+
+LongSlice longslice_get_last_n_items(LongSlice slice, unsigned long n) {
+    LongSlice result = slice;
+    assert(n <= slice.len);
+    result.len = n;
+    result.ptr += slice.len - n;
+    return result;
+}
+
+LongSlice longslice_trim_first_n_items(LongSlice slice, unsigned long n) {
+    LongSlice result = slice;
+    assert(n <= slice.len);
+    result.len = slice.len - n;
+    result.ptr += n;
+    return result;
+}
+
+LongSlice longslice_trim_last_n_items(LongSlice slice, unsigned long n) {
+    LongSlice result = slice;
+    assert(n <= slice.len);
+    result.len = slice.len - n;
+    return result;
+}
+
+#endif /*_LONGSLICE_*/
+
+#ifndef _PARTICLE_SOA_
+#define _PARTICLE_SOA_
+
+#include <stdlib.h>
+#include <assert.h>
+
+#ifndef CORE_STAGED_CHECK
+#   ifdef _CORE_H_
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) CORE_FATAL_ERROR(msg); } while(0)
+#   else
+#       include <stdio.h>
+#       include <stdlib.h>
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg); abort(); } } while(0)
+#   endif
+#endif /*CORE_STAGED_CHECK*/
+
+typedef struct {
+    int id;
+    long weight;
+    double x;
+} Particle;
+
+typedef struct {
+    int * id;
+    long * weight;
+    double * x;
+    unsigned long len;
+    unsigned long cap;
+} ParticleSoa;
+
+void particlesoa_ensure_capacity(ParticleSoa * soa, unsigned long capacity) {
+    if(soa->cap >= capacity) return;
+    CORE_STAGED_CHECK(soa->cap <= (unsigned long)-1 / 2, "soa capacity overflow");
+    if(capacity < soa->cap * 2) capacity = soa->cap * 2;
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(soa->id[0]), "soa capacity overflow");
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(soa->weight[0]), "soa capacity overflow");
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(soa->x[0]), "soa capacity overflow");
+    soa->id = realloc(soa->id, capacity * sizeof(soa->id[0]));
+    CORE_STAGED_CHECK(soa->id != NULL, "soa allocation failed");
+    soa->weight = realloc(soa->weight, capacity * sizeof(soa->weight[0]));
+    CORE_STAGED_CHECK(soa->weight != NULL, "soa allocation failed");
+    soa->x = realloc(soa->x, capacity * sizeof(soa->x[0]));
+    CORE_STAGED_CHECK(soa->x != NULL, "soa allocation failed");
+    soa->cap = capacity;
+}
+
+#ifdef _CORE_H_
+void particlesoa_ensure_capacity_via_arena(ParticleSoa * soa, core_Arena * arena, unsigned long capacity) {
+    if(soa->cap >= capacity) return;
+    CORE_STAGED_CHECK(soa->cap <= (unsigned long)-1 / 2, "soa capacity overflow");
+    if(capacity < soa->cap * 2) capacity = soa->cap * 2;
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(soa->id[0]), "soa capacity overflow");
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(soa->weight[0]), "soa capacity overflow");
+    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(soa->x[0]), "soa capacity overflow");
+    soa->id = soa->cap == 0
+        ? core_arena_check_alloc(core_arena_alloc(arena, capacity * sizeof(soa->id[0])))
+        : core_arena_check_alloc(core_arena_realloc(arena, soa->id, capacity * sizeof(soa->id[0])));
+    soa->weight = soa->cap == 0
+        ? core_arena_check_alloc(core_arena_alloc(arena, capacity * sizeof(soa->weight[0])))
+        : core_arena_check_alloc(core_arena_realloc(arena, soa->weight, capacity * sizeof(soa->weight[0])));
+    soa->x = soa->cap == 0
+        ? core_arena_check_alloc(core_arena_alloc(arena, capacity * sizeof(soa->x[0])))
+        : core_arena_check_alloc(core_arena_realloc(arena, soa->x, capacity * sizeof(soa->x[0])));
+    soa->cap = capacity;
+}
+#endif /*_CORE_H_*/
+
+void particlesoa_push(ParticleSoa * soa, Particle item) {
+    particlesoa_ensure_capacity(soa, soa->len + 1);
+    soa->id[soa->len] = item.id;
+    soa->weight[soa->len] = item.weight;
+    soa->x[soa->len] = item.x;
+    ++soa->len;
+}
+
+#ifdef _CORE_H_
+void particlesoa_push_via_arena(ParticleSoa * soa, core_Arena * arena, Particle item) {
+    particlesoa_ensure_capacity_via_arena(soa, arena, soa->len + 1);
+    soa->id[soa->len] = item.id;
+    soa->weight[soa->len] = item.weight;
+    soa->x[soa->len] = item.x;
+    ++soa->len;
+}
+#endif /*_CORE_H_*/
+
+Particle particlesoa_get(ParticleSoa * soa, unsigned long index) {
+    Particle result;
+    assert(index < soa->len);
+    result.id = soa->id[index];
+    result.weight = soa->weight[index];
+    result.x = soa->x[index];
+    return result;
+}
+
+/*moves the last record into the hole, so order is not kept*/
+void particlesoa_swap_remove(ParticleSoa * soa, unsigned long index) {
+    assert(index < soa->len);
+    --soa->len;
+    soa->id[index] = soa->id[soa->len];
+    soa->weight[index] = soa->weight[soa->len];
+    soa->x[index] = soa->x[soa->len];
+}
+
+/*only for containers grown with soa_push, arena backed ones are freed with the arena*/
+void particlesoa_free(ParticleSoa * soa) {
+    free(soa->id);
+    soa->id = NULL;
+    free(soa->weight);
+    soa->weight = NULL;
+    free(soa->x);
+    soa->x = NULL;
+    soa->len = 0;
+    soa->cap = 0;
+}
+
+#ifdef _INTSLICE_
+IntSlice particlesoa_id(ParticleSoa * soa) {
+    IntSlice result;
+    result.ptr = soa->id;
+    result.len = soa->len;
+    return result;
+}
+#endif /*_INTSLICE_*/
+
+#ifdef _LONGSLICE_
+LongSlice particlesoa_weight(ParticleSoa * soa) {
+    LongSlice result;
+    result.ptr = soa->weight;
+    result.len = soa->len;
+    return result;
+}
+#endif /*_LONGSLICE_*/
+
+#ifdef _DOUBLESLICE_
+DoubleSlice particlesoa_x(ParticleSoa * soa) {
+    DoubleSlice result;
+    result.ptr = soa->x;
+    result.len = soa->len;
+    return result;
+}
+#endif /*_DOUBLESLICE_*/
+
+#endif /*_PARTICLE_SOA_*/
+
+#ifndef _INTDEQUE_
+#define _INTDEQUE_
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef CORE_STAGED_CHECK
+#   ifdef _CORE_H_
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) CORE_FATAL_ERROR(msg); } while(0)
+#   else
+#       include <stdio.h>
+#       include <stdlib.h>
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg); abort(); } } while(0)
+#   endif
+#endif /*CORE_STAGED_CHECK*/
+
+typedef struct {
+    int * items;
+    unsigned long head;
+    unsigned long len;
+    unsigned long cap;
+    int fixed;
+} IntDeque;
+
+void intdeque_init_fixed(IntDeque * deque, int * buffer, unsigned long capacity) {
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+    deque->items = buffer;
+    deque->head = 0;
+    deque->len = 0;
+    deque->cap = capacity;
+    deque->fixed = 1;
+}
+
+/*grows to a power of two and unwraps the items to the start of the new buffer*/
+int intdeque_ensure_capacity(IntDeque * deque, unsigned long capacity) {
+    int * items = NULL;
+    unsigned long cap = deque->cap == 0 ? 8 : deque->cap;
+    unsigned long first = 0;
+    if(capacity <= deque->cap) return 0;
+    if(deque->fixed) return 1;
+    CORE_STAGED_CHECK(capacity <= ((unsigned long)-1 / 2 + 1) / sizeof(items[0]), "deque capacity overflow");
+    while(cap < capacity) cap *= 2;
+    items = malloc(cap * sizeof(items[0]));
+    CORE_STAGED_CHECK(items != NULL, "deque allocation failed");
+    if(deque->len > 0) {
+        first = deque->cap - deque->head < deque->len ? deque->cap - deque->head : deque->len;
+        memcpy(items, deque->items + deque->head, first * sizeof(items[0]));
+        memcpy(items + first, deque->items, (deque->len - first) * sizeof(items[0]));
+    }
+    free(deque->items);
+    deque->items = items;
+    deque->head = 0;
+    deque->cap = cap;
+    return 0;
+}
+
+int intdeque_push_back(IntDeque * deque, int item) {
+    if(intdeque_ensure_capacity(deque, deque->len + 1)) return 1;
+    deque->items[(deque->head + deque->len) & (deque->cap - 1)] = item;
+    ++deque->len;
+    return 0;
+}
+
+int intdeque_push_front(IntDeque * deque, int item) {
+    if(intdeque_ensure_capacity(deque, deque->len + 1)) return 1;
+    deque->head = (deque->head - 1) & (deque->cap - 1);
+    deque->items[deque->head] = item;
+    ++deque->len;
+    return 0;
+}
+
+int intdeque_pop_front(IntDeque * deque, int * result) {
+    if(deque->len == 0) return 1;
+    if(result != NULL) *result = deque->items[deque->head];
+    deque->head = (deque->head + 1) & (deque->cap - 1);
+    --deque->len;
+    return 0;
+}
+
+int intdeque_pop_back(IntDeque * deque, int * result) {
+    if(deque->len == 0) return 1;
+    --deque->len;
+    if(result != NULL) *result = deque->items[(deque->head + deque->len) & (deque->cap - 1)];
+    return 0;
+}
+
+/*index 0 is the front*/
+int intdeque_get(IntDeque * deque, unsigned long index) {
+    assert(index < deque->len);
+    return deque->items[(deque->head + index) & (deque->cap - 1)];
+}
+
+/*all or nothing, the span is copied with at most two memcpys*/
+int intdeque_push_back_n(IntDeque * deque, int * items, unsigned long count) {
+    unsigned long tail = 0;
+    unsigned long first = 0;
+    if(count == 0) return 0;
+    if(intdeque_ensure_capacity(deque, deque->len + count)) return 1;
+    tail = (deque->head + deque->len) & (deque->cap - 1);
+    first = deque->cap - tail < count ? deque->cap - tail : count;
+    memcpy(deque->items + tail, items, first * sizeof(items[0]));
+    memcpy(deque->items, items + first, (count - first) * sizeof(items[0]));
+    deque->len += count;
+    return 0;
+}
+
+/*pops up to count items off the front into result and returns how many were popped*/
+unsigned long intdeque_pop_front_n(IntDeque * deque, int * result, unsigned long count) {
+    unsigned long first = 0;
+    if(count > deque->len) count = deque->len;
+    if(count == 0) return 0;
+    first = deque->cap - deque->head < count ? deque->cap - deque->head : count;
+    memcpy(result, deque->items + deque->head, first * sizeof(result[0]));
+    memcpy(result + first, deque->items, (count - first) * sizeof(result[0]));
+    deque->head = (deque->head + count) & (deque->cap - 1);
+    deque->len -= count;
+    return count;
+}
+
+/*fixed deques leave the caller's buffer alone*/
+void intdeque_free(IntDeque * deque) {
+    if(!deque->fixed) free(deque->items);
+    deque->items = NULL;
+    deque->head = 0;
+    deque->len = 0;
+    deque->cap = 0;
+    deque->fixed = 0;
+}
+
+#endif /*_INTDEQUE_*/
+
+#ifndef _PAIRSORT_
+#define _PAIRSORT_
+
+#define PAIR_SORT_LESS(a, b) (PAIR_KEY_LESS(a, b))
+
+void _pairarray_insertion_sort(Pair * items, long lo, long hi) {
+    long i = 0;
+    long j = 0;
+    Pair tmp;
+    for(i = lo + 1; i <= hi; ++i) {
+        tmp = items[i];
+        for(j = i; j > lo && PAIR_SORT_LESS(tmp, items[j - 1]); --j) {
+            items[j] = items[j - 1];
+        }
+        items[j] = tmp;
+    }
+}
+
+void _pairarray_sift_down(Pair * items, long root, long len) {
+    Pair tmp = items[root];
+    long child = 0;
+    while((child = 2 * root + 1) < len) {
+        if(child + 1 < len && PAIR_SORT_LESS(items[child], items[child + 1])) ++child;
+        if(!PAIR_SORT_LESS(tmp, items[child])) break;
+        items[root] = items[child];
+        root = child;
+    }
+    items[root] = tmp;
+}
+
+void _pairarray_heap_sort(Pair * items, long len) {
+    long i = 0;
+    Pair tmp;
+    for(i = len / 2 - 1; i >= 0; --i) {
+        _pairarray_sift_down(items, i, len);
+    }
+    for(i = len - 1; i > 0; --i) {
+        tmp = items[0];
+        items[0] = items[i];
+        items[i] = tmp;
+        _pairarray_sift_down(items, 0, i);
+    }
+}
+
+/*quicksort that falls back to heapsort when the recursion gets too deep and to insertion sort for short ranges*/
+void _pairarray_intro_sort(Pair * items, long lo, long hi, int depth) {
+    long i = 0;
+    long j = 0;
+    long mid = 0;
+    Pair pivot;
+    Pair tmp;
+    while(hi - lo > 16) {
+        if(depth-- == 0) {
+            _pairarray_heap_sort(items + lo, hi - lo + 1);
+            return;
+        }
+        mid = lo + (hi - lo) / 2;
+        if(PAIR_SORT_LESS(items[mid], items[lo])) { tmp = items[mid]; items[mid] = items[lo]; items[lo] = tmp; }
+        if(PAIR_SORT_LESS(items[hi], items[mid])) { tmp = items[hi]; items[hi] = items[mid]; items[mid] = tmp; }
+        if(PAIR_SORT_LESS(items[mid], items[lo])) { tmp = items[mid]; items[mid] = items[lo]; items[lo] = tmp; }
+        pivot = items[mid];
+        i = lo - 1;
+        j = hi + 1;
+        for(;;) {
+            do ++i; while(PAIR_SORT_LESS(items[i], pivot));
+            do --j; while(PAIR_SORT_LESS(pivot, items[j]));
+            if(i >= j) break;
+            tmp = items[i];
+            items[i] = items[j];
+            items[j] = tmp;
+        }
+        /*recurse into the smaller half so the stack stays O(log n)*/
+        if(j - lo < hi - j) {
+            _pairarray_intro_sort(items, lo, j, depth);
+            lo = j + 1;
+        } else {
+            _pairarray_intro_sort(items, j + 1, hi, depth);
+            hi = j;
+        }
+    }
+    _pairarray_insertion_sort(items, lo, hi);
+}
+
+void pairarray_sort(Pair * items, unsigned long len) {
+    int depth = 0;
+    unsigned long n = 0;
+    for(n = len; n > 1; n >>= 1) depth += 2;
+    if(len > 1) _pairarray_intro_sort(items, 0, (long)len - 1, depth);
+}
+
+/*index of the first item not less than key*/
+unsigned long pairarray_lower_bound(Pair * items, unsigned long len, Pair key) {
+    unsigned long lo = 0;
+    unsigned long step = 0;
+    while(len > 0) {
+        step = len / 2;
+        if(PAIR_SORT_LESS(items[lo + step], key)) {
+            lo += step + 1;
+            len -= step + 1;
+        } else {
+            len = step;
+        }
+    }
+    return lo;
+}
+
+/*index of the first item greater than key*/
+unsigned long pairarray_upper_bound(Pair * items, unsigned long len, Pair key) {
+    unsigned long lo = 0;
+    unsigned long step = 0;
+    while(len > 0) {
+        step = len / 2;
+        if(!PAIR_SORT_LESS(key, items[lo + step])) {
+            lo += step + 1;
+            len -= step + 1;
+        } else {
+            len = step;
+        }
+    }
+    return lo;
+}
+
+#ifdef _PAIRVEC_
+void pairvec_sort(PairVec * vec) {
+    pairarray_sort(vec->items, vec->len);
+}
+
+unsigned long pairvec_lower_bound(PairVec * vec, Pair key) {
+    return pairarray_lower_bound(vec->items, vec->len, key);
+}
+
+unsigned long pairvec_upper_bound(PairVec * vec, Pair key) {
+    return pairarray_upper_bound(vec->items, vec->len, key);
+}
+#endif /*_PAIRVEC_*/
+
+#endif /*_PAIRSORT_*/
+
+#ifndef _PAIRPARALLEL_SORT_
+#define _PAIRPARALLEL_SORT_
+
+#ifdef CORE_THREADS_AVAILABLE
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+void _pairarray_merge(Pair * dst, const Pair * lhs, unsigned long lhs_len, const Pair * rhs, unsigned long rhs_len) {
+    unsigned long i = 0;
+    unsigned long j = 0;
+    while(i < lhs_len && j < rhs_len) {
+        if(PAIR_SORT_LESS(rhs[j], lhs[i])) *dst++ = rhs[j++];
+        else *dst++ = lhs[i++];
+    }
+    while(i < lhs_len) *dst++ = lhs[i++];
+    while(j < rhs_len) *dst++ = rhs[j++];
+}
+
+/*how many of the first k items of the merge of lhs and rhs come from lhs*/
+unsigned long _pairarray_merge_split(const Pair * lhs, unsigned long lhs_len, const Pair * rhs, unsigned long rhs_len, unsigned long k) {
+    unsigned long lo = k > rhs_len ? k - rhs_len : 0;
+    unsigned long hi = k < lhs_len ? k : lhs_len;
+    unsigned long i = 0;
+    while(lo < hi) {
+        i = lo + (hi - lo) / 2;
+        if(!PAIR_SORT_LESS(rhs[k - i - 1], lhs[i])) lo = i + 1;
+        else hi = i;
+    }
+    return lo;
+}
+
+void _pairarray_merge_sort(Pair * items, Pair * scratch, unsigned long len) {
+    unsigned long width = 16;
+    unsigned long lo = 0;
+    unsigned long mid = 0;
+    unsigned long hi = 0;
+    Pair * src = items;
+    Pair * dst = scratch;
+    Pair * tmp = NULL;
+    for(lo = 0; lo < len; lo += width) {
+        hi = lo + width < len ? lo + width : len;
+        _pairarray_insertion_sort(items, (long)lo, (long)hi - 1);
+    }
+    for(; width < len; width *= 2) {
+        for(lo = 0; lo < len; lo += 2 * width) {
+            mid = lo + width < len ? lo + width : len;
+            hi = mid + width < len ? mid + width : len;
+            _pairarray_merge(dst + lo, src + lo, mid - lo, src + mid, hi - mid);
+        }
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if(src != items) memcpy(items, src, len * sizeof(items[0]));
+}
+
+typedef struct {
+    Pair * items;
+    Pair * scratch;
+    Pair * src;
+    Pair * dst;
+    unsigned long len;
+    unsigned long width;
+    unsigned long pieces;
+} _PairParallelSort;
+
+void _pairarray_parallel_sort_runs(void * ctx, unsigned long index) {
+    _PairParallelSort * sort = ctx;
+    unsigned long lo = index * sort->width;
+    unsigned long hi = lo + sort->width < sort->len ? lo + sort->width : sort->len;
+    _pairarray_merge_sort(sort->items + lo, sort->scratch + lo, hi - lo);
+}
+
+void _pairarray_parallel_sort_merge(void * ctx, unsigned long index) {
+    _PairParallelSort * sort = ctx;
+    unsigned long lo = index / sort->pieces * 2 * sort->width;
+    unsigned long mid = lo + sort->width < sort->len ? lo + sort->width : sort->len;
+    unsigned long hi = mid + sort->width < sort->len ? mid + sort->width : sort->len;
+    unsigned long piece = index % sort->pieces;
+    unsigned long k0 = (unsigned long)_core_parallel_split(hi - lo, sort->pieces, piece);
+    unsigned long k1 = (unsigned long)_core_parallel_split(hi - lo, sort->pieces, piece + 1);
+    unsigned long i0 = _pairarray_merge_split(sort->src + lo, mid - lo, sort->src + mid, hi - mid, k0);
+    unsigned long i1 = _pairarray_merge_split(sort->src + lo, mid - lo, sort->src + mid, hi - mid, k1);
+    _pairarray_merge(sort->dst + lo + k0, sort->src + lo + i0, i1 - i0, sort->src + mid + (k0 - i0), (k1 - i1) - (k0 - i0));
+}
+
+void _pairarray_parallel_sort_copy_back(void * ctx, unsigned long index) {
+    _PairParallelSort * sort = ctx;
+    unsigned long lo = (unsigned long)_core_parallel_split(sort->len, sort->pieces, index);
+    unsigned long hi = (unsigned long)_core_parallel_split(sort->len, sort->pieces, index + 1);
+    memcpy(sort->items + lo, sort->src + lo, (hi - lo) * sizeof(sort->items[0]));
+}
+
+/*stable merge sort, a NULL pool sorts on the calling thread. the result is the same for any pool*/
+void pairarray_parallel_sort(Pair * items, unsigned long len, core_ThreadPool * pool) {
+    unsigned long threads = core_thread_pool_thread_count(pool);
+    unsigned long runs = len / CORE_PARALLEL_GRAIN < threads ? len / CORE_PARALLEL_GRAIN : threads;
+    _PairParallelSort sort;
+    Pair * tmp = NULL;
+    if(len < 2) return;
+    if(len > (unsigned long)-1 / sizeof(items[0])) {
+        CORE_FATAL_ERROR("parallel sort size overflow");
+    }
+    memset(&sort, 0, sizeof(sort));
+    sort.items = items;
+    sort.scratch = malloc(len * sizeof(items[0]));
+    if(sort.scratch == NULL) {
+        CORE_FATAL_ERROR("parallel sort out of memory");
+    }
+    sort.len = len;
+    if(runs == 0) runs = 1;
+    sort.width = (len + runs - 1) / runs;
+    runs = (len + sort.width - 1) / sort.width;
+    core_thread_pool_run(pool, _pairarray_parallel_sort_runs, &sort, runs);
+    sort.src = items;
+    sort.dst = sort.scratch;
+    while(sort.width < len) {
+        runs = (len - 1) / (2 * sort.width) + 1;
+        sort.pieces = (threads + runs - 1) / runs;
+        core_thread_pool_run(pool, _pairarray_parallel_sort_merge, &sort, runs * sort.pieces);
+        tmp = sort.src;
+        sort.src = sort.dst;
+        sort.dst = tmp;
+        sort.width = sort.width > (len + 1) / 2 ? len : sort.width * 2;
+    }
+    if(sort.src != items) {
+        sort.pieces = threads;
+        core_thread_pool_run(pool, _pairarray_parallel_sort_copy_back, &sort, threads);
+    }
+    free(sort.scratch);
+}
+
+void pairarray_stable_sort(Pair * items, unsigned long len) {
+    pairarray_parallel_sort(items, len, NULL);
+}
+
+#ifdef _PAIRVEC_
+void pairvec_parallel_sort(PairVec * vec, core_ThreadPool * pool) {
+    pairarray_parallel_sort(vec->items, vec->len, pool);
+}
+
+void pairvec_stable_sort(PairVec * vec) {
+    pairarray_stable_sort(vec->items, vec->len);
+}
+#endif /*_PAIRVEC_*/
+
+#endif /*CORE_THREADS_AVAILABLE*/
+#endif /*_PAIRPARALLEL_SORT_*/
+
+#ifndef _DOUBLEPARALLEL_PREFIX_SUM_
+#define _DOUBLEPARALLEL_PREFIX_SUM_
+
+#ifdef CORE_THREADS_AVAILABLE
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*out[i] is the sum of in[0..i] when inclusive and of in[0..i) otherwise. in may equal out.
+  floating point blocks are totalled before they are scanned, the same additions the parallel
+  version does. integer types, where 0.5 truncates to 0, take a single pass*/
+void doublearray_prefix_sum(const double * in, double * out, unsigned long len, core_Bool inclusive) {
+    const core_Bool blocked = (double)0.5 > 0;
+    unsigned long lo = 0;
+    unsigned long hi = 0;
+    unsigned long i = 0;
+    double offset = 0;
+    double total;
+    double acc;
+    double item;
+    for(lo = 0; lo < len; lo = hi) {
+        hi = !blocked || len - lo < CORE_PARALLEL_GRAIN ? len : lo + CORE_PARALLEL_GRAIN;
+        total = 0;
+        if(blocked) for(i = lo; i < hi; ++i) total += in[i];
+        acc = offset;
+        for(i = lo; i < hi; ++i) {
+            item = in[i];
+            if(inclusive) acc += item;
+            out[i] = acc;
+            if(!inclusive) acc += item;
+        }
+        offset += total;
+    }
+}
+
+typedef struct {
+    const double * in;
+    double * out;
+    unsigned long len;
+    unsigned long blocks;
+    core_Bool inclusive;
+    double * sums;
+} _DoubleParallelPrefixSum;
+
+void _doublearray_parallel_prefix_sum_total(void * ctx, unsigned long index) {
+    _DoubleParallelPrefixSum * scan = ctx;
+    unsigned long lo = index * CORE_PARALLEL_GRAIN;
+    unsigned long hi = scan->len - lo < CORE_PARALLEL_GRAIN ? scan->len : lo + CORE_PARALLEL_GRAIN;
+    double acc = 0;
+    for(; lo < hi; ++lo) acc += scan->in[lo];
+    scan->sums[index] = acc;
+}
+
+/*carries on from the sum of every block before this one*/
+void _doublearray_parallel_prefix_sum_scan(void * ctx, unsigned long index) {
+    _DoubleParallelPrefixSum * scan = ctx;
+    unsigned long lo = index * CORE_PARALLEL_GRAIN;
+    unsigned long hi = scan->len - lo < CORE_PARALLEL_GRAIN ? scan->len : lo + CORE_PARALLEL_GRAIN;
+    double acc = scan->sums[index];
+    double item;
+    for(; lo < hi; ++lo) {
+        item = scan->in[lo];
+        if(scan->inclusive) acc += item;
+        scan->out[lo] = acc;
+        if(!scan->inclusive) acc += item;
+    }
+}
+
+void doublearray_parallel_prefix_sum(const double * in, double * out, unsigned long len, core_Bool inclusive, core_ThreadPool * pool) {
+    _DoubleParallelPrefixSum scan;
+    unsigned long i = 0;
+    double running = 0;
+    double tmp;
+    if(len == 0) return;
+    memset(&scan, 0, sizeof(scan));
+    scan.in = in;
+    scan.out = out;
+    scan.len = len;
+    scan.inclusive = inclusive;
+    scan.blocks = (len - 1) / CORE_PARALLEL_GRAIN + 1;
+    scan.sums = malloc(scan.blocks * sizeof(scan.sums[0]));
+    if(scan.sums == NULL) {
+        CORE_FATAL_ERROR("parallel prefix sum out of memory");
+    }
+    core_thread_pool_run(pool, _doublearray_parallel_prefix_sum_total, &scan, scan.blocks - 1);
+    for(i = 0; i + 1 < scan.blocks; ++i) {
+        tmp = scan.sums[i];
+        scan.sums[i] = running;
+        running += tmp;
+    }
+    scan.sums[scan.blocks - 1] = running;
+    core_thread_pool_run(pool, _doublearray_parallel_prefix_sum_scan, &scan, scan.blocks);
+    free(scan.sums);
+}
+
+#ifdef _DOUBLEVEC_
+void doublevec_parallel_prefix_sum(DoubleVec * vec, core_Bool inclusive, core_ThreadPool * pool) {
+    doublearray_parallel_prefix_sum(vec->items, vec->items, vec->len, inclusive, pool);
+}
+
+void doublevec_prefix_sum(DoubleVec * vec, core_Bool inclusive) {
+    doublearray_prefix_sum(vec->items, vec->items, vec->len, inclusive);
+}
+#endif /*_DOUBLEVEC_*/
+
+#endif /*CORE_THREADS_AVAILABLE*/
+#endif /*_DOUBLEPARALLEL_PREFIX_SUM_*/
+
+#ifndef _INTPARALLEL_PREFIX_SUM_
+#define _INTPARALLEL_PREFIX_SUM_
+
+#ifdef CORE_THREADS_AVAILABLE
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*out[i] is the sum of in[0..i] when inclusive and of in[0..i) otherwise. in may equal out.
+  floating point blocks are totalled before they are scanned, the same additions the parallel
+  version does. integer types, where 0.5 truncates to 0, take a single pass*/
+void intarray_prefix_sum(const int * in, int * out, unsigned long len, core_Bool inclusive) {
+    const core_Bool blocked = (int)0.5 > 0;
+    unsigned long lo = 0;
+    unsigned long hi = 0;
+    unsigned long i = 0;
+    int offset = 0;
+    int total;
+    int acc;
+    int item;
+    for(lo = 0; lo < len; lo = hi) {
+        hi = !blocked || len - lo < CORE_PARALLEL_GRAIN ? len : lo + CORE_PARALLEL_GRAIN;
+        total = 0;
+        if(blocked) for(i = lo; i < hi; ++i) total += in[i];
+        acc = offset;
+        for(i = lo; i < hi; ++i) {
+            item = in[i];
+            if(inclusive) acc += item;
+            out[i] = acc;
+            if(!inclusive) acc += item;
+        }
+        offset += total;
+    }
+}
+
+typedef struct {
+    const int * in;
+    int * out;
+    unsigned long len;
+    unsigned long blocks;
+    core_Bool inclusive;
+    int * sums;
+} _IntParallelPrefixSum;
+
+void _intarray_parallel_prefix_sum_total(void * ctx, unsigned long index) {
+    _IntParallelPrefixSum * scan = ctx;
+    unsigned long lo = index * CORE_PARALLEL_GRAIN;
+    unsigned long hi = scan->len - lo < CORE_PARALLEL_GRAIN ? scan->len : lo + CORE_PARALLEL_GRAIN;
+    int acc = 0;
+    for(; lo < hi; ++lo) acc += scan->in[lo];
+    scan->sums[index] = acc;
+}
+
+/*carries on from the sum of every block before this one*/
+void _intarray_parallel_prefix_sum_scan(void * ctx, unsigned long index) {
+    _IntParallelPrefixSum * scan = ctx;
+    unsigned long lo = index * CORE_PARALLEL_GRAIN;
+    unsigned long hi = scan->len - lo < CORE_PARALLEL_GRAIN ? scan->len : lo + CORE_PARALLEL_GRAIN;
+    int acc = scan->sums[index];
+    int item;
+    for(; lo < hi; ++lo) {
+        item = scan->in[lo];
+        if(scan->inclusive) acc += item;
+        scan->out[lo] = acc;
+        if(!scan->inclusive) acc += item;
+    }
+}
+
+void intarray_parallel_prefix_sum(const int * in, int * out, unsigned long len, core_Bool inclusive, core_ThreadPool * pool) {
+    _IntParallelPrefixSum scan;
+    unsigned long i = 0;
+    int running = 0;
+    int tmp;
+    if(len == 0) return;
+    memset(&scan, 0, sizeof(scan));
+    scan.in = in;
+    scan.out = out;
+    scan.len = len;
+    scan.inclusive = inclusive;
+    scan.blocks = (len - 1) / CORE_PARALLEL_GRAIN + 1;
+    scan.sums = malloc(scan.blocks * sizeof(scan.sums[0]));
+    if(scan.sums == NULL) {
+        CORE_FATAL_ERROR("parallel prefix sum out of memory");
+    }
+    core_thread_pool_run(pool, _intarray_parallel_prefix_sum_total, &scan, scan.blocks - 1);
+    for(i = 0; i + 1 < scan.blocks; ++i) {
+        tmp = scan.sums[i];
+        scan.sums[i] = running;
+        running += tmp;
+    }
+    scan.sums[scan.blocks - 1] = running;
+    core_thread_pool_run(pool, _intarray_parallel_prefix_sum_scan, &scan, scan.blocks);
+    free(scan.sums);
+}
+
+#ifdef _INTVEC_
+void intvec_parallel_prefix_sum(IntVec * vec, core_Bool inclusive, core_ThreadPool * pool) {
+    intarray_parallel_prefix_sum(vec->items, vec->items, vec->len, inclusive, pool);
+}
+
+void intvec_prefix_sum(IntVec * vec, core_Bool inclusive) {
+    intarray_prefix_sum(vec->items, vec->items, vec->len, inclusive);
+}
+#endif /*_INTVEC_*/
+
+#endif /*CORE_THREADS_AVAILABLE*/
+#endif /*_INTPARALLEL_PREFIX_SUM_*/
+
+#ifndef _INTTOINTMAP_
+#define _INTTOINTMAP_
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#ifndef CORE_STAGED_CHECK
+#   ifdef _CORE_H_
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) CORE_FATAL_ERROR(msg); } while(0)
+#   else
+#       include <stdio.h>
+#       include <stdlib.h>
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg); abort(); } } while(0)
+#   endif
+#endif /*CORE_STAGED_CHECK*/
+
+#define INTTOINT_MAP_HASH(key) (_inttointmap_hash_mix((unsigned long)(size_t)(key)))
+#define INTTOINT_MAP_EQ(a, b) ((a) == (b))
+/*0 marks an empty slot, full ones hold the high bit and the top 7 bits of the hash*/
+#define INTTOINT_MAP_CTRL(hash) ((unsigned char)(0x80 | ((hash) >> (sizeof(unsigned long) * CHAR_BIT - 7))))
+
+typedef struct {
+    unsigned long hash;
+    int key;
+    int value;
+} IntToIntMapEntry;
+
+/*entries and ctrl share one block, cap is 0 or a power of two*/
+typedef struct {
+    unsigned char * ctrl;
+    IntToIntMapEntry * entries;
+    unsigned long len;
+    unsigned long cap;
+} IntToIntMap;
+
+unsigned long _inttointmap_hash_mix(unsigned long hash) {
+#if ULONG_MAX > 0xffffffffUL
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdUL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53UL;
+    hash ^= hash >> 33;
+#else
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bUL;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35UL;
+    hash ^= hash >> 16;
+#endif
+    return hash;
+}
+
+/*slot holding key, or the empty slot where it would go*/
+unsigned long _inttointmap_probe(const IntToIntMap * map, int key, unsigned long hash) {
+    const unsigned long mask = map->cap - 1;
+    const unsigned char ctrl = INTTOINT_MAP_CTRL(hash);
+    unsigned long i = hash & mask;
+    for(; map->ctrl[i] != 0; i = (i + 1) & mask) {
+        if(map->ctrl[i] != ctrl || map->entries[i].hash != hash) continue;
+        if(INTTOINT_MAP_EQ(map->entries[i].key, key)) break;
+    }
+    return i;
+}
+
+/*grows the table so count entries fit below 3/4 full*/
+void inttointmap_reserve(IntToIntMap * map, unsigned long count) {
+    IntToIntMap new = {0};
+    unsigned long i = 0;
+    unsigned long j = 0;
+    CORE_STAGED_CHECK(count <= (unsigned long)-1 / 4, "map capacity overflow");
+    if(map->cap != 0 && count * 4 <= map->cap * 3) return;
+    new.cap = map->cap == 0 ? 16 : map->cap;
+    while(count * 4 > new.cap * 3) {
+        CORE_STAGED_CHECK(new.cap <= (unsigned long)-1 / 2 / (sizeof(new.entries[0]) + 1), "map capacity overflow");
+        new.cap *= 2;
+    }
+    new.len = map->len;
+    new.entries = malloc(new.cap * (sizeof(new.entries[0]) + 1));
+    CORE_STAGED_CHECK(new.entries != NULL, "map allocation failed");
+    new.ctrl = (unsigned char *)(new.entries + new.cap);
+    memset(new.ctrl, 0, new.cap);
+    for(i = 0; i < map->cap; ++i) {
+        if(map->ctrl[i] == 0) continue;
+        for(j = map->entries[i].hash & (new.cap - 1); new.ctrl[j] != 0; j = (j + 1) & (new.cap - 1));
+        new.ctrl[j] = map->ctrl[i];
+        new.entries[j] = map->entries[i];
+    }
+    free(map->entries);
+    *map = new;
+}
+
+int * inttointmap_get(const IntToIntMap * map, int key) {
+    unsigned long i = 0;
+    if(map->len == 0) return NULL;
+    i = _inttointmap_probe(map, key, INTTOINT_MAP_HASH(key));
+    return map->ctrl[i] == 0 ? NULL : &map->entries[i].value;
+}
+
+void inttointmap_set(IntToIntMap * map, int key, int value) {
+    const unsigned long hash = INTTOINT_MAP_HASH(key);
+    unsigned long i = 0;
+    if(map->cap != 0) {
+        i = _inttointmap_probe(map, key, hash);
+        if(map->ctrl[i] != 0) {
+            map->entries[i].value = value;
+            return;
+        }
+    }
+    if(map->cap == 0 || (map->len + 1) * 4 > map->cap * 3) {
+        inttointmap_reserve(map, map->len + 1);
+        i = _inttointmap_probe(map, key, hash);
+    }
+    map->ctrl[i] = INTTOINT_MAP_CTRL(hash);
+    map->entries[i].hash = hash;
+    map->entries[i].key = key;
+    map->entries[i].value = value;
+    map->len++;
+}
+
+/*returns 1 if key was there. later entries of the probe run are shifted back into the hole
+  unless that would put them before their home slot*/
+int inttointmap_remove(IntToIntMap * map, int key) {
+    unsigned long mask = 0;
+    unsigned long home = 0;
+    unsigned long i = 0;
+    unsigned long j = 0;
+    if(map->len == 0) return 0;
+    i = _inttointmap_probe(map, key, INTTOINT_MAP_HASH(key));
+    if(map->ctrl[i] == 0) return 0;
+    mask = map->cap - 1;
+    for(j = (i + 1) & mask; map->ctrl[j] != 0; j = (j + 1) & mask) {
+        home = map->entries[j].hash & mask;
+        if(((j - home) & mask) >= ((j - i) & mask)) {
+            map->ctrl[i] = map->ctrl[j];
+            map->entries[i] = map->entries[j];
+            i = j;
+        }
+    }
+    map->ctrl[i] = 0;
+    map->len--;
+    return 1;
+}
+
+void inttointmap_clear(IntToIntMap * map) {
+    if(map->cap != 0) memset(map->ctrl, 0, map->cap);
+    map->len = 0;
+}
+
+void inttointmap_free(IntToIntMap * map) {
+    free(map->entries);
+    memset(map, 0, sizeof(*map));
+}
+
+#endif /*_INTTOINTMAP_*/
+
+#ifndef _PAIRTODOUBLEMAP_
+#define _PAIRTODOUBLEMAP_
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#ifndef CORE_STAGED_CHECK
+#   ifdef _CORE_H_
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) CORE_FATAL_ERROR(msg); } while(0)
+#   else
+#       include <stdio.h>
+#       include <stdlib.h>
+#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg); abort(); } } while(0)
+#   endif
+#endif /*CORE_STAGED_CHECK*/
+
+#define PAIRTODOUBLE_MAP_HASH(key) (_pairtodoublemap_hash_mix((unsigned long)PAIR_KEY_HASH(key)))
+#define PAIRTODOUBLE_MAP_EQ(a, b) (PAIR_EQ(a, b))
+/*0 marks an empty slot, full ones hold the high bit and the top 7 bits of the hash*/
+#define PAIRTODOUBLE_MAP_CTRL(hash) ((unsigned char)(0x80 | ((hash) >> (sizeof(unsigned long) * CHAR_BIT - 7))))
+
+typedef struct {
+    unsigned long hash;
+    Pair key;
+    double value;
+} PairToDoubleMapEntry;
+
+/*entries and ctrl share one block, cap is 0 or a power of two*/
+typedef struct {
+    unsigned char * ctrl;
+    PairToDoubleMapEntry * entries;
+    unsigned long len;
+    unsigned long cap;
+} PairToDoubleMap;
+
+unsigned long _pairtodoublemap_hash_mix(unsigned long hash) {
+#if ULONG_MAX > 0xffffffffUL
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdUL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53UL;
+    hash ^= hash >> 33;
+#else
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bUL;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35UL;
+    hash ^= hash >> 16;
+#endif
+    return hash;
+}
+
+/*slot holding key, or the empty slot where it would go*/
+unsigned long _pairtodoublemap_probe(const PairToDoubleMap * map, Pair key, unsigned long hash) {
+    const unsigned long mask = map->cap - 1;
+    const unsigned char ctrl = PAIRTODOUBLE_MAP_CTRL(hash);
+    unsigned long i = hash & mask;
+    for(; map->ctrl[i] != 0; i = (i + 1) & mask) {
+        if(map->ctrl[i] != ctrl || map->entries[i].hash != hash) continue;
+        if(PAIRTODOUBLE_MAP_EQ(map->entries[i].key, key)) break;
+    }
+    return i;
+}
+
+/*grows the table so count entries fit below 3/4 full*/
+void pairtodoublemap_reserve(PairToDoubleMap * map, unsigned long count) {
+    PairToDoubleMap new = {0};
+    unsigned long i = 0;
+    unsigned long j = 0;
+    CORE_STAGED_CHECK(count <= (unsigned long)-1 / 4, "map capacity overflow");
+    if(map->cap != 0 && count * 4 <= map->cap * 3) return;
+    new.cap = map->cap == 0 ? 16 : map->cap;
+    while(count * 4 > new.cap * 3) {
+        CORE_STAGED_CHECK(new.cap <= (unsigned long)-1 / 2 / (sizeof(new.entries[0]) + 1), "map capacity overflow");
+        new.cap *= 2;
+    }
+    new.len = map->len;
+    new.entries = malloc(new.cap * (sizeof(new.entries[0]) + 1));
+    CORE_STAGED_CHECK(new.entries != NULL, "map allocation failed");
+    new.ctrl = (unsigned char *)(new.entries + new.cap);
+    memset(new.ctrl, 0, new.cap);
+    for(i = 0; i < map->cap; ++i) {
+        if(map->ctrl[i] == 0) continue;
+        for(j = map->entries[i].hash & (new.cap - 1); new.ctrl[j] != 0; j = (j + 1) & (new.cap - 1));
+        new.ctrl[j] = map->ctrl[i];
+        new.entries[j] = map->entries[i];
+    }
+    free(map->entries);
+    *map = new;
+}
+
+double * pairtodoublemap_get(const PairToDoubleMap * map, Pair key) {
+    unsigned long i = 0;
+    if(map->len == 0) return NULL;
+    i = _pairtodoublemap_probe(map, key, PAIRTODOUBLE_MAP_HASH(key));
+    return map->ctrl[i] == 0 ? NULL : &map->entries[i].value;
+}
+
+void pairtodoublemap_set(PairToDoubleMap * map, Pair key, double value) {
+    const unsigned long hash = PAIRTODOUBLE_MAP_HASH(key);
+    unsigned long i = 0;
+    if(map->cap != 0) {
+        i = _pairtodoublemap_probe(map, key, hash);
+        if(map->ctrl[i] != 0) {
+            map->entries[i].value = value;
+            return;
+        }
+    }
+    if(map->cap == 0 || (map->len + 1) * 4 > map->cap * 3) {
+        pairtodoublemap_reserve(map, map->len + 1);
+        i = _pairtodoublemap_probe(map, key, hash);
+    }
+    map->ctrl[i] = PAIRTODOUBLE_MAP_CTRL(hash);
+    map->entries[i].hash = hash;
+    map->entries[i].key = key;
+    map->entries[i].value = value;
+    map->len++;
+}
+
+/*returns 1 if key was there. later entries of the probe run are shifted back into the hole
+  unless that would put them before their home slot*/
+int pairtodoublemap_remove(PairToDoubleMap * map, Pair key) {
+    unsigned long mask = 0;
+    unsigned long home = 0;
+    unsigned long i = 0;
+    unsigned long j = 0;
+    if(map->len == 0) return 0;
+    i = _pairtodoublemap_probe(map, key, PAIRTODOUBLE_MAP_HASH(key));
+    if(map->ctrl[i] == 0) return 0;
+    mask = map->cap - 1;
+    for(j = (i + 1) & mask; map->ctrl[j] != 0; j = (j + 1) & mask) {
+        home = map->entries[j].hash & mask;
+        if(((j - home) & mask) >= ((j - i) & mask)) {
+            map->ctrl[i] = map->ctrl[j];
+            map->entries[i] = map->entries[j];
+            i = j;
+        }
+    }
+    map->ctrl[i] = 0;
+    map->len--;
+    return 1;
+}
+
+void pairtodoublemap_clear(PairToDoubleMap * map) {
+    if(map->cap != 0) memset(map->ctrl, 0, map->cap);
+    map->len = 0;
+}
+
+void pairtodoublemap_free(PairToDoubleMap * map) {
+    free(map->entries);
+    memset(map, 0, sizeof(*map));
+}
+
+#endif /*_PAIRTODOUBLEMAP_*/
+
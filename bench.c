@@ -0,0 +1,397 @@
+#define CORE_IMPLEMENTATION
+#include "core.h"
+#include <sys/time.h>
+#include <sys/resource.h>
+
+/*allocator micro benchmarks, build with `make bench` so the numbers are not skewed by the sanitizers*/
+
+#define BENCH_ALLOCS 2000000
+#define BENCH_GROW_BYTES (16 * 1024 * 1024)
+#define BENCH_APPENDS 20000000
+#define BENCH_MIXED_LIVE 4096
+#define BENCH_MIXED_OPS 4000000
+#define BENCH_SORT_ITEMS 4000000
+#define BENCH_HASHMAP_KEYS 1000000
+#define BENCH_READER_THREADS 8
+#define BENCH_READER_GETS 1000000
+
+static volatile size_t bench_sink = 0;
+static void * bench_ptrs[BENCH_MIXED_LIVE];
+
+static double bench_now(void) {
+    struct timeval now = {0};
+    gettimeofday(&now, NULL);
+    return (double)now.tv_sec + (double)now.tv_usec * 1e-6;
+}
+
+static long bench_peak_rss_kb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static void bench_report(const char * name, double seconds, long ops) {
+    printf("%-34s %10.2f ns/op %10.2f Mops/s %10ld KiB peak rss\n",
+           name,
+           seconds * 1e9 / (double)ops,
+           (double)ops / seconds * 1e-6,
+           bench_peak_rss_kb());
+}
+
+static unsigned long bench_rand_state = 2463534242UL;
+static unsigned long bench_rand(void) {
+    /*xorshift, good enough to pick sizes and slots*/
+    bench_rand_state ^= (bench_rand_state << 13) & 0xffffffffUL;
+    bench_rand_state ^= bench_rand_state >> 17;
+    bench_rand_state ^= (bench_rand_state << 5) & 0xffffffffUL;
+    return bench_rand_state;
+}
+
+static size_t bench_mixed_size(void) {
+    /*mostly small objects with the occasional big one*/
+    const unsigned long r = bench_rand();
+    if(r % 64 == 0) return 1024 + (size_t)(r % 16384);
+    return 8 + (size_t)(r % 248);
+}
+
+static void bench_fixed_alloc(void) {
+    core_Arena a = {0};
+    void ** ptrs = malloc(sizeof(void *) * BENCH_ALLOCS);
+    double start;
+    long i;
+
+    start = bench_now();
+    for(i = 0; i < BENCH_ALLOCS; ++i) {
+        char * p = core_arena_alloc(&a, 32);
+        p[0] = (char)i;
+        bench_sink += (size_t)p[0];
+    }
+    bench_report("arena alloc 32B", bench_now() - start, BENCH_ALLOCS);
+    core_arena_free(&a);
+
+    start = bench_now();
+    for(i = 0; i < BENCH_ALLOCS; ++i) {
+        char * p = malloc(32);
+        p[0] = (char)i;
+        bench_sink += (size_t)p[0];
+        ptrs[i] = p;
+    }
+    for(i = 0; i < BENCH_ALLOCS; ++i) free(ptrs[i]);
+    bench_report("malloc+free 32B", bench_now() - start, BENCH_ALLOCS);
+    free(ptrs);
+}
+
+static void bench_alloc_reclaim(void) {
+    core_Arena a = {0};
+    double start;
+    long i;
+
+    start = bench_now();
+    for(i = 0; i < BENCH_ALLOCS; ++i) {
+        char * p = core_arena_alloc(&a, 64);
+        char * q = core_arena_alloc(&a, 64);
+        p[0] = (char)i;
+        q[0] = (char)i;
+        bench_sink += (size_t)(p[0] + q[0]);
+        core_arena_reclaim_memory(&a, p);
+        core_arena_reclaim_memory(&a, q);
+    }
+    bench_report("arena alloc/reclaim 2x64B", bench_now() - start, BENCH_ALLOCS * 2);
+    core_arena_free(&a);
+
+    start = bench_now();
+    for(i = 0; i < BENCH_ALLOCS; ++i) {
+        char * p = malloc(64);
+        char * q = malloc(64);
+        p[0] = (char)i;
+        q[0] = (char)i;
+        bench_sink += (size_t)(p[0] + q[0]);
+        free(p);
+        free(q);
+    }
+    bench_report("malloc/free 2x64B", bench_now() - start, BENCH_ALLOCS * 2);
+}
+
+static void bench_realloc_grow(void) {
+    core_Arena a = {0};
+    char * p = NULL;
+    double start;
+    size_t len;
+    long ops = 0;
+
+    start = bench_now();
+    p = core_arena_alloc(&a, 16);
+    for(len = 32; len <= BENCH_GROW_BYTES; len += 16) {
+        p = core_arena_realloc(&a, p, len);
+        p[len - 1] = (char)len;
+        ++ops;
+    }
+    bench_sink += (size_t)p[BENCH_GROW_BYTES - 1];
+    bench_report("arena realloc +16B to 16MiB", bench_now() - start, ops);
+    core_arena_free(&a);
+
+    ops = 0;
+    start = bench_now();
+    p = malloc(16);
+    for(len = 32; len <= BENCH_GROW_BYTES; len += 16) {
+        p = realloc(p, len);
+        p[len - 1] = (char)len;
+        ++ops;
+    }
+    bench_sink += (size_t)p[BENCH_GROW_BYTES - 1];
+    bench_report("realloc +16B to 16MiB", bench_now() - start, ops);
+    free(p);
+}
+
+static void bench_vec_append(void) {
+    core_Arena a = {0};
+    core_Vec(int) vec = {0};
+    int * items = NULL;
+    long len = 0;
+    long cap = 0;
+    double start;
+    long i;
+
+    start = bench_now();
+    for(i = 0; i < BENCH_APPENDS; ++i) {
+        core_vec_append(&vec, &a, (int)i);
+    }
+    bench_sink += (size_t)vec.items[vec.len - 1];
+    bench_report("core_vec_append int", bench_now() - start, BENCH_APPENDS);
+    core_arena_free(&a);
+
+    start = bench_now();
+    for(i = 0; i < BENCH_APPENDS; ++i) {
+        if(len >= cap) {
+            cap = cap * 2 + 8;
+            items = realloc(items, sizeof(int) * (size_t)cap);
+        }
+        items[len++] = (int)i;
+    }
+    bench_sink += (size_t)items[len - 1];
+    bench_report("realloc doubling append int", bench_now() - start, BENCH_APPENDS);
+    free(items);
+}
+
+static void bench_mixed(void) {
+    core_Arena a = {0};
+    double start;
+    long i;
+
+    memset(bench_ptrs, 0, sizeof(bench_ptrs));
+    bench_rand_state = 2463534242UL;
+    start = bench_now();
+    for(i = 0; i < BENCH_MIXED_OPS; ++i) {
+        const size_t slot = (size_t)(bench_rand() % BENCH_MIXED_LIVE);
+        const size_t size = bench_mixed_size();
+        if(bench_ptrs[slot] != NULL) core_arena_reclaim_memory(&a, bench_ptrs[slot]);
+        bench_ptrs[slot] = core_arena_alloc(&a, size);
+        ((char *)bench_ptrs[slot])[size - 1] = (char)i;
+    }
+    bench_report("arena mixed alloc/reclaim", bench_now() - start, BENCH_MIXED_OPS);
+    core_arena_free(&a);
+
+    memset(bench_ptrs, 0, sizeof(bench_ptrs));
+    bench_rand_state = 2463534242UL;
+    start = bench_now();
+    for(i = 0; i < BENCH_MIXED_OPS; ++i) {
+        const size_t slot = (size_t)(bench_rand() % BENCH_MIXED_LIVE);
+        const size_t size = bench_mixed_size();
+        free(bench_ptrs[slot]);
+        bench_ptrs[slot] = malloc(size);
+        ((char *)bench_ptrs[slot])[size - 1] = (char)i;
+    }
+    bench_report("malloc mixed alloc/free", bench_now() - start, BENCH_MIXED_OPS);
+    for(i = 0; i < BENCH_MIXED_LIVE; ++i) free(bench_ptrs[i]);
+}
+
+static void bench_parallel_sort(void) {
+    core_ThreadPool pool;
+    int * items = malloc(sizeof(int) * BENCH_SORT_ITEMS);
+    double start;
+    long i;
+
+    core_thread_pool_init(&pool, 0);
+    bench_rand_state = 2463534242UL;
+    for(i = 0; i < BENCH_SORT_ITEMS; ++i) items[i] = (int)(bench_rand() >> 1);
+    start = bench_now();
+    qsort(items, BENCH_SORT_ITEMS, sizeof(int), core_compare_int);
+    bench_report("qsort int", bench_now() - start, BENCH_SORT_ITEMS);
+
+    bench_rand_state = 2463534242UL;
+    for(i = 0; i < BENCH_SORT_ITEMS; ++i) items[i] = (int)(bench_rand() >> 1);
+    start = bench_now();
+    core_parallel_sort(items, BENCH_SORT_ITEMS, sizeof(int), core_compare_int, &pool);
+    bench_report("core_parallel_sort int", bench_now() - start, BENCH_SORT_ITEMS);
+
+    for(i = 0; i < BENCH_SORT_ITEMS; ++i) items[i] = (int)(i & 0xff);
+    start = bench_now();
+    core_parallel_prefix_sum(items, items, BENCH_SORT_ITEMS, sizeof(int), core_add_int, CORE_FALSE, &pool);
+    bench_report("core_parallel_prefix_sum int", bench_now() - start, BENCH_SORT_ITEMS);
+    bench_sink += (size_t)items[BENCH_SORT_ITEMS - 1];
+
+    printf("(%lu threads)\n", core_thread_pool_thread_count(&pool));
+    core_thread_pool_free(&pool);
+    free(items);
+}
+
+static void bench_hashmap(void) {
+    core_Arena a = {0};
+    core_Hashmap(long) hm = {0};
+    char key[32];
+    double start;
+    long i;
+
+    start = bench_now();
+    for(i = 0; i < BENCH_HASHMAP_KEYS; ++i) {
+        sprintf(key, "key_%ld", i);
+        core_hashmap_set(&hm, &a, key, i);
+    }
+    bench_report("core_hashmap_set new keys", bench_now() - start, BENCH_HASHMAP_KEYS);
+
+    start = bench_now();
+    for(i = 0; i < BENCH_HASHMAP_KEYS; ++i) {
+        sprintf(key, "key_%ld", (long)(bench_rand() % BENCH_HASHMAP_KEYS));
+        bench_sink += (size_t)*core_hashmap_get(&hm, key);
+    }
+    bench_report("core_hashmap_get hits", bench_now() - start, BENCH_HASHMAP_KEYS);
+
+    start = bench_now();
+    for(i = 0; i < BENCH_HASHMAP_KEYS; ++i) {
+        sprintf(key, "miss_%lu", bench_rand());
+        bench_sink += core_hashmap_get(&hm, key) == NULL;
+    }
+    bench_report("core_hashmap_get misses", bench_now() - start, BENCH_HASHMAP_KEYS);
+
+    start = bench_now();
+    for(i = 0; i < BENCH_HASHMAP_KEYS; ++i) {
+        sprintf(key, "key_%ld", i);
+        bench_sink += core_hashmap_remove(&hm, &a, key);
+    }
+    bench_report("core_hashmap_remove", bench_now() - start, BENCH_HASHMAP_KEYS);
+    core_arena_free(&a);
+}
+
+/*reserved also reserves keys, values and hashes, which incremental resize does not amortise*/
+static void bench_hashmap_worst_set(core_Bool incremental, core_Bool reserved) {
+    core_Arena a = {0};
+    core_Hashmap(long) hm = {0};
+    char key[32];
+    double start, worst = 0;
+    long i;
+
+    if(incremental) core_hashmap_enable_incremental_resize(&hm);
+    if(reserved) {
+        core_vec_reserve(&hm.keys, &a, BENCH_HASHMAP_KEYS);
+        core_vec_reserve(&hm.values, &a, BENCH_HASHMAP_KEYS);
+        core_vec_reserve(&hm.buckets.hashes, &a, BENCH_HASHMAP_KEYS);
+    }
+    start = bench_now();
+    for(i = 0; i < BENCH_HASHMAP_KEYS; ++i) {
+        double set_start;
+        sprintf(key, "key_%ld", i);
+        set_start = bench_now();
+        core_hashmap_set(&hm, &a, key, i);
+        set_start = bench_now() - set_start;
+        if(set_start > worst) worst = set_start;
+    }
+    bench_report(
+        reserved ? "core_hashmap_set reserved" : incremental ? "core_hashmap_set incremental" : "core_hashmap_set timed",
+        bench_now() - start, BENCH_HASHMAP_KEYS
+    );
+    printf("(worst single set %.1f us)\n", worst * 1e6);
+    core_arena_free(&a);
+}
+
+static void bench_concurrent_hashmap(void) {
+    core_ConcurrentHashmap hm;
+    char key[32];
+    double start;
+    long i, value;
+
+    core_concurrent_hashmap_init(&hm, sizeof(long), 0);
+    start = bench_now();
+    for(i = 0; i < BENCH_HASHMAP_KEYS; ++i) {
+        sprintf(key, "key_%ld", i);
+        core_concurrent_hashmap_set(&hm, key, &i);
+    }
+    bench_report("core_concurrent_hashmap_set", bench_now() - start, BENCH_HASHMAP_KEYS);
+
+    start = bench_now();
+    for(i = 0; i < BENCH_HASHMAP_KEYS; ++i) {
+        sprintf(key, "key_%ld", (long)(bench_rand() % BENCH_HASHMAP_KEYS));
+        if(core_concurrent_hashmap_get(&hm, key, &value)) bench_sink += (size_t)value;
+    }
+    bench_report("core_concurrent_hashmap_get hits", bench_now() - start, BENCH_HASHMAP_KEYS);
+    core_concurrent_hashmap_free(&hm);
+}
+
+typedef struct {
+    core_ConcurrentHashmap * map;
+    char (*keys)[16];
+    unsigned long rng;
+    size_t sum;
+} BenchReader;
+
+static void * bench_reader(void * arg) {
+    BenchReader * r = arg;
+    long i, value;
+    for(i = 0; i < BENCH_READER_GETS; ++i) {
+        r->rng = r->rng * 6364136223846793005UL + 1442695040888963407UL;
+        if(core_concurrent_hashmap_get(r->map, r->keys[(r->rng >> 24) % BENCH_HASHMAP_KEYS], &value)) r->sum += (size_t)value;
+    }
+    return NULL;
+}
+
+/*the same gets spread over more and more threads, Mops/s should grow with the number of cores*/
+static void bench_concurrent_hashmap_readers(void) {
+    core_ConcurrentHashmap hm;
+    char (*keys)[16] = malloc(sizeof(*keys) * BENCH_HASHMAP_KEYS);
+    pthread_t threads[BENCH_READER_THREADS];
+    BenchReader readers[BENCH_READER_THREADS];
+    char name[64];
+    double start;
+    long i;
+    int n, t;
+
+    core_concurrent_hashmap_init(&hm, sizeof(long), 0);
+    for(i = 0; i < BENCH_HASHMAP_KEYS; ++i) {
+        sprintf(keys[i], "key_%ld", i);
+        core_concurrent_hashmap_set(&hm, keys[i], &i);
+    }
+    for(n = 1; n <= BENCH_READER_THREADS; n *= 2) {
+        start = bench_now();
+        for(t = 0; t < n; ++t) {
+            readers[t].map = &hm;
+            readers[t].keys = keys;
+            readers[t].rng = (unsigned long)t * 7919 + 1;
+            readers[t].sum = 0;
+            pthread_create(&threads[t], NULL, bench_reader, &readers[t]);
+        }
+        for(t = 0; t < n; ++t) {
+            pthread_join(threads[t], NULL);
+            bench_sink += readers[t].sum;
+        }
+        sprintf(name, "core_concurrent_hashmap_get %d thr", n);
+        bench_report(name, bench_now() - start, (long)n * BENCH_READER_GETS);
+    }
+    core_concurrent_hashmap_free(&hm);
+    free(keys);
+}
+
+int main(void) {
+    /*peak rss only ever grows, so each line shows the high water mark up to that benchmark*/
+    bench_fixed_alloc();
+    bench_alloc_reclaim();
+    bench_realloc_grow();
+    bench_vec_append();
+    bench_mixed();
+    bench_parallel_sort();
+    bench_hashmap();
+    bench_hashmap_worst_set(CORE_FALSE, CORE_FALSE);
+    bench_hashmap_worst_set(CORE_TRUE, CORE_FALSE);
+    bench_hashmap_worst_set(CORE_TRUE, CORE_TRUE);
+    bench_concurrent_hashmap();
+    bench_concurrent_hashmap_readers();
+    return 0;
+}
@@ -126,6 +126,36 @@ SOFTWARE.
 #endif /* CLANG GCC */
 
 
+/**** THREAD LOCAL ****/
+#if defined(CORE_C11) || defined(CORE_C17)
+#   define CORE_THREAD_LOCAL _Thread_local
+#elif defined(CORE_C23)
+#   define CORE_THREAD_LOCAL thread_local
+#elif defined(CORE_CLANG) || defined(CORE_GCC) || defined(CORE_TCC)
+#   define CORE_THREAD_LOCAL __thread
+#elif defined(CORE_MSVC)
+#   define CORE_THREAD_LOCAL __declspec(thread)
+#else
+#   define CORE_THREAD_LOCAL
+#endif /*CORE_THREAD_LOCAL*/
+
+
+/**** ATOMIC ****/
+#if defined(CORE_CLANG) || defined(CORE_GCC)
+#   define CORE_ATOMICS_AVAILABLE
+#   define CORE_ATOMIC_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#   define CORE_ATOMIC_STORE(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#   define CORE_ATOMIC_LOAD_RELAXED(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#   define CORE_ATOMIC_STORE_RELAXED(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+#   define CORE_ATOMIC_FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#   define CORE_ATOMIC_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#   define CORE_ATOMIC_FENCE_SEQ_CST() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#   define CORE_ATOMIC_FETCH_ADD(ptr, value) __atomic_fetch_add(ptr, value, __ATOMIC_ACQ_REL)
+#   define CORE_ATOMIC_CAS(ptr, expected_ptr, desired) \
+        __atomic_compare_exchange_n(ptr, expected_ptr, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#endif /*defined(CORE_CLANG) || defined(CORE_GCC)*/
+
+
 /**** ANSI ****/
 #define CORE_ANSI_RED     "\x1b[31m"
 #define CORE_ANSI_GREEN   "\x1b[32m"
@@ -201,6 +231,31 @@ void core_errprint(const char * fmt, ...)
 #define CORE_ARRAY_LEN(array) (int)(sizeof(array) / sizeof(array[0]))
 
 
+/**** LIKELY ****/
+#if defined(__GNUC__) || defined(__clang__)
+#    define CORE_LIKELY_TRUE(expr)  __builtin_expect(expr, 1)
+#    define CORE_LIKELY_FALSE(expr) __builtin_expect(expr, 0)
+#else
+#    define CORE_LIKELY_TRUE(expr) expr
+#    define CORE_LIKELY_FALSE(expr) expr
+#endif /*defined(__GNUC__) || defined(__clang__)*/
+
+/**** MINMAX ****/
+#define CORE_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define CORE_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CORE_MIN3(a, b, c) CORE_MIN(CORE_MIN(a, b), c)
+#define CORE_MAX3(a, b, c) CORE_MAX(CORE_MAX(a, b), c)
+
+/**** ALIGNOF ****/
+#if defined(__GNUC__) || defined(__clang__)
+#    define CORE_ALIGNOF(type) __alignof__(type)
+#elif defined(_MSC_VER)
+#    define CORE_ALIGNOF(type) __alignof(type)
+#else
+#    define CORE_ALIGNOF(type) ((size_t)&((struct { char c; type member; } *)0)->member)
+#endif /*defined(__GNUC__) || defined(__clang__)*/
+
+
 /**** EXIT ****/
 #ifdef CORE_IMPLEMENTATION
 #define CORE_ON_EXIT_MAX_FUNCTIONS 64
@@ -322,772 +377,2698 @@ void _core_profiler_log(const char * event_name, char begin_or_end, const char *
 
 
 /**** ARENA ****/
+#ifndef CORE_ARENA_CHUNK_SIZE
+#   define CORE_ARENA_CHUNK_SIZE (64 * 1024)
+#endif /*CORE_ARENA_CHUNK_SIZE*/
+#ifndef CORE_ARENA_CHUNK_SIZE_MAX
+#   define CORE_ARENA_CHUNK_SIZE_MAX (64 * 1024 * 1024)
+#endif /*CORE_ARENA_CHUNK_SIZE_MAX*/
+#ifndef CORE_ARENA_ALIGNMENT
+#   define CORE_ARENA_ALIGNMENT 16
+#endif /*CORE_ARENA_ALIGNMENT*/
+#ifndef CORE_ARENA_SIZE_CLASSES
+#   define CORE_ARENA_SIZE_CLASSES 96
+#endif /*CORE_ARENA_SIZE_CLASSES*/
+#define CORE_ARENA_EXACT_CLASS_MAX 1024
+#ifndef CORE_CACHE_LINE_SIZE
+#   define CORE_CACHE_LINE_SIZE 64
+#endif /*CORE_CACHE_LINE_SIZE*/
+#ifndef CORE_ARENA_CALLSITES_MAX
+#   define CORE_ARENA_CALLSITES_MAX 256
+#endif /*CORE_ARENA_CALLSITES_MAX*/
+#define CORE_ARENA_HISTOGRAM_BUCKETS 32
+
+/*CORE_ARENA_DEBUG attributes allocations to their callsite and needs the stats*/
+#if defined(CORE_ARENA_DEBUG) && !defined(CORE_ARENA_STATS)
+#   define CORE_ARENA_STATS
+#endif /*defined(CORE_ARENA_DEBUG) && !defined(CORE_ARENA_STATS)*/
+
+#define CORE_ARENA_ALIGN_UP(n, align) (((size_t)(n) + ((size_t)(align) - 1)) & ~((size_t)(align) - 1))
+
+/*header stored directly in front of every allocation*/
 typedef struct core_Allocation {
-    struct core_Allocation * next;
-    void * mem;
     size_t len;
+    unsigned int offset; /*distance from the start of a large chunk's data to the header*/
+    unsigned char align_log2; /*0 unless the block was asked for with core_arena_alloc_aligned*/
     core_Bool active;
+    core_Bool large;
 } core_Allocation;
 
+/*chunks are carved up by bumping the used counter, large allocations get a chunk of their own*/
+typedef struct core_ArenaChunk {
+    struct core_ArenaChunk * next;
+    struct core_ArenaChunk * prev;
+    size_t cap;
+    size_t used;
+    unsigned long serial;
+} core_ArenaChunk;
+
 typedef struct {
-    core_Allocation * head;
+    const char * file;
+    int line;
+    unsigned long count;
+    size_t bytes;
+} core_ArenaCallsite;
+
+typedef struct {
+    size_t bytes_requested;   /*total bytes asked for by callers*/
+    size_t bytes_allocated;   /*total bytes handed out, including headers and padding*/
+    size_t bytes_used;        /*bytes currently carved out of chunks and large allocations*/
+    size_t bytes_free_listed; /*part of bytes_used sitting in free lists waiting for reuse*/
+    size_t bytes_reserved;    /*bytes currently held from malloc*/
+    size_t peak_used;
+    size_t peak_reserved;
+    unsigned long alloc_count;
+    unsigned long realloc_count;
+    unsigned long realloc_in_place_count;
+    unsigned long reclaim_count;
+    unsigned long histogram[CORE_ARENA_HISTOGRAM_BUCKETS]; /*requests by power of two size*/
+#ifdef CORE_ARENA_DEBUG
+    core_ArenaCallsite callsites[CORE_ARENA_CALLSITES_MAX];
+    unsigned long callsites_dropped;
+#endif /*CORE_ARENA_DEBUG*/
+} core_ArenaStats;
+
+/*chunk memory callbacks, alloc may return NULL which makes the arena allocation fail*/
+typedef struct core_ArenaAllocator {
+    void * (*alloc)(void * ctx, size_t bytes);
+    void (*free)(void * ctx, void * ptr, size_t bytes);
+    void * ctx;
+} core_ArenaAllocator;
+
+/*what a buffer backed arena does once the buffer is full*/
+typedef enum {
+    CORE_ARENA_OVERFLOW_FAIL,  /*allocations return NULL, containers die, see core_arena_check_alloc*/
+    CORE_ARENA_OVERFLOW_CHAIN  /*further chunks come from the allocator*/
+} core_ArenaOverflow;
+
+typedef struct {
+    core_ArenaChunk * head;
+    core_ArenaChunk * large;
+    core_ArenaChunk * spare;
+    size_t chunk_size;
+    unsigned long large_serial;
+    void * free_lists[CORE_ARENA_SIZE_CLASSES];
+    struct core_Pool * pools; /*shared pools handed out by core_arena_pool*/
+    const core_ArenaAllocator * allocator; /*NULL uses malloc and free*/
+    char * buffer;            /*caller supplied chunk that is never freed*/
+    core_ArenaOverflow overflow;
+    char * virtual_base;      /*start of the reserved address range, NULL unless core_arena_init_virtual was used*/
+    size_t virtual_reserved;
+    unsigned int virtual_flags;
+    core_ArenaChunk * floor_chunk; /*position of the latest mark, blocks starting below it never grow in place*/
+    size_t floor_used;
+#ifdef CORE_ARENA_STATS
+    core_ArenaStats stats;
+#endif /*CORE_ARENA_STATS*/
     long magic_number;
 } core_Arena;
 
-core_Allocation * core_arena_allocation_new(size_t bytes)
+/*position in an arena that can be rewound to with core_arena_rewind*/
+typedef struct {
+    core_ArenaChunk * chunk;
+    size_t used;
+    unsigned long large_serial;
+    core_ArenaChunk * floor_chunk; /*floor before the mark was taken, restored by the rewind*/
+    size_t floor_used;
+} core_ArenaMark;
+
+#define CORE_ARENA_HEADER_SIZE CORE_ARENA_ALIGN_UP(sizeof(core_Allocation), CORE_ARENA_ALIGNMENT)
+#define CORE_ARENA_CHUNK_HEADER_SIZE CORE_ARENA_ALIGN_UP(sizeof(core_ArenaChunk), CORE_ARENA_ALIGNMENT)
+#define CORE_ARENA_CHUNK_DATA(chunk) ((char *)(chunk) + CORE_ARENA_CHUNK_HEADER_SIZE)
+#define CORE_ARENA_ALLOCATION(ptr) ((core_Allocation *)(void *)((char *)(ptr) - CORE_ARENA_HEADER_SIZE))
+#define CORE_ARENA_FREE_LIST_NEXT(ptr) (*(void **)(ptr))
+#define CORE_ARENA_LARGE_CHUNK(header) ((core_ArenaChunk *)(void *)((char *)(header) - (header)->offset - CORE_ARENA_CHUNK_HEADER_SIZE))
+
+unsigned int core_log2_floor(size_t n)
 #ifdef CORE_IMPLEMENTATION
 {
-    core_Allocation * ptr = malloc(sizeof(core_Allocation));
-    assert(ptr);
-    ptr->mem = malloc(bytes);
-    assert(ptr->mem);
-    ptr->len = bytes;
-    ptr->active = CORE_TRUE;
-    ptr->next = NULL;
-    return ptr;
+    unsigned int result = 0;
+    assert(n > 0);
+#if defined(CORE_CLANG) || defined(CORE_GCC)
+    result = (unsigned int)(sizeof(unsigned long) * CHAR_BIT - 1) - (unsigned int)__builtin_clzl((unsigned long)n);
+#else
+    while(n >>= 1) ++result;
+#endif /*defined(CORE_CLANG) || defined(CORE_GCC)*/
+    return result;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-CORE_NODISCARD
-void * core_arena_alloc(core_Arena * a, const size_t bytes)
+/*lengths up to CORE_ARENA_EXACT_CLASS_MAX each get their own free list, past that
+  the free list CORE_ARENA_EXACT_CLASSES + k holds blocks with a length in
+  [2^k * CORE_ARENA_EXACT_CLASS_MAX, 2^(k+1) * CORE_ARENA_EXACT_CLASS_MAX)*/
+#define CORE_ARENA_EXACT_CLASSES (CORE_ARENA_EXACT_CLASS_MAX / CORE_ARENA_ALIGNMENT)
+
+/*the list a block of len goes on when it is reclaimed*/
+unsigned int _core_arena_free_class(size_t len)
 #ifdef CORE_IMPLEMENTATION
 {
-    core_Allocation * ptr = NULL;
-
-    /*Some safety checks to help find bugs*/
-    if(a->magic_number == 0) {
-        /*Probably a new allocation, so make sure it is zeroed */
-        if(a->head != NULL) {
-            CORE_FATAL_ERROR("Your arena allocator has not been properly zeroed");
-        }
-
-        /*update the magic number to show the arena has been initialized*/
-        a->magic_number = (long)0xDEADBEEF;
-    } else if(a->magic_number == (long)0xDEADBEEF) {
-        /*if the magic number is DEADBEEF, the arena head should not be NULL*/
-        assert(a->head != NULL && "Improperly initialized arena");
-    } else {
-        /*if the magic number is not 0 or DEADBEEF, then the arena has probably not been zeroed*/
-        CORE_FATAL_ERROR("Your arena allocator has not been properly zeroed");
-    }
-    if(a->head == NULL) {
-        core_Allocation * head = core_arena_allocation_new(bytes);
-        a->head = head;
-        return a->head->mem;
-    }
-   ptr = a->head;
-    for(;ptr->next != NULL; ptr = ptr->next) {
-        if(!ptr->active && ptr->len >= bytes) {
-            ptr->active = CORE_TRUE;
-            return ptr->mem;
-        }
-    }
-    assert(ptr != NULL);
-    assert(ptr->next == NULL);
-    {
-        core_Allocation * next =  core_arena_allocation_new(bytes);
-        ptr->next = next;
-        return next->mem;
-    }
+    unsigned int size_class;
+    if(len <= CORE_ARENA_EXACT_CLASS_MAX) return (unsigned int)(len / CORE_ARENA_ALIGNMENT) - 1;
+    size_class = CORE_ARENA_EXACT_CLASSES + core_log2_floor(len) - core_log2_floor(CORE_ARENA_EXACT_CLASS_MAX);
+    return CORE_MIN(size_class, CORE_ARENA_SIZE_CLASSES - 1);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-void core_arena_reclaim_memory(core_Arena * a, void * ptr) /*Equivalent to free(ptr)*/
+/*the first list where every block is at least len long*/
+unsigned int _core_arena_alloc_class(size_t len)
 #ifdef CORE_IMPLEMENTATION
 {
-    core_Allocation * node = NULL;
-    assert(ptr != NULL);
-    for(node = a->head; node != NULL && node->mem != ptr; node = node->next);
-    assert(node != NULL);
-    assert(node->mem == ptr);
-    node->active = CORE_FALSE;
+    if(len <= CORE_ARENA_EXACT_CLASS_MAX) return (unsigned int)(len / CORE_ARENA_ALIGNMENT) - 1;
+    return CORE_ARENA_EXACT_CLASSES + core_log2_floor(len - 1) + 1 - core_log2_floor(CORE_ARENA_EXACT_CLASS_MAX);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-CORE_NODISCARD
-void * core_arena_realloc(core_Arena * a, void * ptr, const size_t bytes)
+/*prefers the list len itself would be freed to when the block on top of it is big enough,
+  so a freed mid-size block is reused by the next request of about its size*/
+unsigned int _core_arena_reuse_class(core_Arena * a, size_t len)
 #ifdef CORE_IMPLEMENTATION
 {
-    core_Allocation * node = NULL;
-    core_Allocation * new = NULL;
-    assert(ptr != NULL);
-    for(node = a->head; node != NULL && node->mem != ptr; node = node->next);
-    assert(node != NULL);
-    assert(node->mem == ptr);
-    assert(bytes >= node->len);
-    node->active = CORE_FALSE;
-    new = core_arena_allocation_new(bytes);
-    assert(new);
-    assert(new->len >= node->len);
-    memcpy(new->mem, node->mem, node->len);
-    new->next = a->head;
-    a->head = new;
-    return new->mem;
+    const unsigned int size_class = _core_arena_free_class(len);
+    void * ptr = a->free_lists[size_class];
+    if(ptr != NULL && CORE_ARENA_ALLOCATION(ptr)->len >= len) return size_class;
+    return _core_arena_alloc_class(len);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
-    
-    
-void core_arena_free(core_Arena * a)
+
+#ifdef CORE_ARENA_STATS
+void _core_arena_stats_alloc(core_Arena * a, size_t requested, size_t len)
 #ifdef CORE_IMPLEMENTATION
 {
-    core_Allocation * ptr = NULL;
-    if(a->head == NULL) return;
-    for(ptr = a->head;;) {
-        core_Allocation * next = ptr->next;
-        free(ptr->mem);
-        free(ptr);
-        if(next == NULL) return;
-        ptr = next;
-    }
+    ++a->stats.alloc_count;
+    a->stats.bytes_requested += requested;
+    a->stats.bytes_allocated += CORE_ARENA_HEADER_SIZE + len;
+    ++a->stats.histogram[requested == 0 ? 0 : CORE_MIN(core_log2_floor(requested), CORE_ARENA_HISTOGRAM_BUCKETS - 1)];
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-char * core_arena_strdup(core_Arena * arena, const char * str)
+void _core_arena_stats_carve(core_Arena * a, size_t bytes)
 #ifdef CORE_IMPLEMENTATION
 {
-    unsigned long len = strlen(str);
-    char * mem = core_arena_alloc(arena, len + 1);
-    memcpy(mem, str, len + 1);
-    assert(mem[len] == 0);
-    return mem;
+    a->stats.bytes_used += bytes;
+    a->stats.peak_used = CORE_MAX(a->stats.peak_used, a->stats.bytes_used);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-/**** SLICE ****/
-#define core_Slice(Type) struct {Type * ptr; unsigned int len;}
-
-
-/**** VEC ****/
-#define core_Vec(Type) struct {Type * items; int len; int cap; }
-
-#define core_vec_append(vec, arena, item) do { \
-    if((vec)->cap <= 0) { \
-        (vec)->cap = 8; \
-        (vec)->len = 0; \
-        (vec)->items = core_arena_alloc(arena, sizeof(item) * (unsigned int)(vec)->cap); \
-    } else if((vec)->len + 1 >= (int)(vec)->cap) {                      \
-        (vec)->cap = (vec)->cap * 2 + 1; \
-        (vec)->items = core_arena_realloc(arena, (vec)->items, (int)sizeof(item) * (unsigned int)(vec)->cap); \
-    } \
-    (vec)->items[(vec)->len++] = item; \
-} while (0)
-
-#define core_vec_copy_items(dst, src, arena) do { \
-    int _i_; \
-    for(_i_ = 0; _i_ < (src)->len; ++i) { \
-        core_vec_append(dst, arena, (src)->items[i]); \
-    } \
-} while(0)
-
-#define core_vec_append_unique(vec, arena, item, equality_function) do {                 \
-    int _i_;                                                                    \
-    for(_i_ = 0; _i_ < (vec)->len; ++_i_) {                                              \
-        if(equality_function(item, (vec)->items[_i_])) goto core_vec_append_unique_skip; \
-    }                                                                                    \
-    core_vec_append(vec, arena, item);                                                   \
-        core_vec_append_unique_skip: ;                                 \
-} while(0)
-
-typedef core_Vec(const char *) core_StrVec;
-typedef core_Vec(int) core_IntVec;
-
-
-/**** CTYPE ****/
-core_Bool core_isidentifier(char ch)
+void _core_arena_stats_reserve(core_Arena * a, size_t bytes)
 #ifdef CORE_IMPLEMENTATION
 {
-    return isalpha(ch) || isdigit(ch) || ch == '_';
+    a->stats.bytes_reserved += bytes;
+    a->stats.peak_reserved = CORE_MAX(a->stats.peak_reserved, a->stats.bytes_reserved);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+#   define _CORE_ARENA_STATS(stmt) do { stmt; } while(0)
+#else
+#   define _core_arena_stats_alloc(a, requested, len)
+#   define _core_arena_stats_carve(a, bytes)
+#   define _core_arena_stats_reserve(a, bytes)
+#   define _CORE_ARENA_STATS(stmt)
+#endif /*CORE_ARENA_STATS*/
+
+/*allocator NULL uses malloc, returns NULL when the allocator does*/
+core_ArenaChunk * _core_arena_chunk_alloc_from(const core_ArenaAllocator * allocator, size_t cap)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaChunk * chunk = allocator != NULL
+        ? allocator->alloc(allocator->ctx, CORE_ARENA_CHUNK_HEADER_SIZE + cap)
+        : malloc(CORE_ARENA_CHUNK_HEADER_SIZE + cap);
+    if(chunk == NULL) return NULL;
+    chunk->next = NULL;
+    chunk->prev = NULL;
+    chunk->cap = cap;
+    chunk->used = 0;
+    chunk->serial = 0;
+    return chunk;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-/**** SYMBOL ****/
-#ifndef CORE_SYMBOL_MAX_LEN
-#   define CORE_SYMBOL_MAX_LEN 128
-#endif /*CORE_SYMBOL_MAX_LEN*/
-#ifndef CORE_MAX_SYMBOLS
-#   define CORE_MAX_SYMBOLS 2048
-#endif /*CORE_MAX_SYMBOLS*/
-
-typedef int core_Symbol;
-typedef struct {
-    char symbols[CORE_MAX_SYMBOLS][CORE_SYMBOL_MAX_LEN];
-    int count;
-} core_Symbols;
-
-core_Symbol core_symbol_intern(core_Symbols * state, const char * str)
+/*a standalone malloc backed chunk, aborts when malloc fails*/
+core_ArenaChunk * core_arena_chunk_new(size_t cap)
 #ifdef CORE_IMPLEMENTATION
 {
-    int i = 0;
-    int result = -1;
-    for(i = 0; i < state->count; ++i) {
-        if(strcmp(state->symbols[i], str) == 0) return i;
+    core_ArenaChunk * chunk = _core_arena_chunk_alloc_from(NULL, cap);
+    if(chunk == NULL) {
+        CORE_FATAL_ERROR("Failed to allocate an arena chunk");
     }
-    strncpy(state->symbols[state->count], str, CORE_SYMBOL_MAX_LEN - 1);
-    result = state->count;
-    ++state->count;
-    return result;
+    return chunk;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-const char * core_symbol_get(core_Symbols * state, core_Symbol sym)
+core_ArenaChunk * _core_arena_chunk_alloc(core_Arena * a, size_t cap)
 #ifdef CORE_IMPLEMENTATION
 {
-    assert(sym < state->count);
-    return state->symbols[sym];
+    if(a->buffer != NULL && a->overflow == CORE_ARENA_OVERFLOW_FAIL) return NULL;
+    return _core_arena_chunk_alloc_from(a->allocator, cap);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-/**** PEEK ****/
-char core_peek(FILE * fp)
+void _core_arena_chunk_release(core_Arena * a, core_ArenaChunk * chunk)
 #ifdef CORE_IMPLEMENTATION
 {
-    char ch = (char)fgetc(fp);
-    ungetc(ch, fp);
-    return ch;
+    if((char *)chunk == a->buffer) return;
+    if(a->allocator != NULL) {
+        a->allocator->free(a->allocator->ctx, chunk, CORE_ARENA_CHUNK_HEADER_SIZE + chunk->cap);
+    } else {
+        free(chunk);
+    }
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-int core_skip_whitespace(FILE * fp)
+/*whether an allocation should get its own chunk instead of being carved from the head chunk*/
+core_Bool _core_arena_is_large(core_Arena * a, size_t bytes)
 #ifdef CORE_IMPLEMENTATION
 {
-    int num_newlines = 0;
-    while(isspace(core_peek(fp)))
-        if(fgetc(fp) == '\n') ++num_newlines;
-    return num_newlines;
+    if(a->virtual_base != NULL) return CORE_FALSE;
+    if(a->buffer != NULL && a->overflow == CORE_ARENA_OVERFLOW_FAIL) return CORE_FALSE;
+    return bytes > a->chunk_size / 4;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-core_Bool core_skip_comments(FILE * fp, const char * begin, const char * end)
+void _core_arena_check_initialized(core_Arena * a)
 #ifdef CORE_IMPLEMENTATION
 {
-    int i;
-    long pos;
-
-    CORE_TODO("Test this function to make sure it works");
-    
-    if(!fp || !begin || !end) return 0;
-    if(strlen(begin) == 0 || strlen(end) == 0) return 0;
-    pos = ftell(fp);
-    for(i = 0; begin[i] != 0 && fgetc(fp) == begin[i]; ++i) {
-        
-    }
-    if(begin[i] == 0) {
-        /*comment found*/
-        for(;;) {
-            for(;!feof(fp) && core_peek(fp) != end[0]; fgetc(fp));
-            if(feof(fp)) {
-                fprintf(stderr, "Unterminated comment");
-                return CORE_FALSE;
-            } else {
-                for(i = 0; end[i] != 0 && fgetc(fp) == end[i];++i);
-                if(end[i] == 0) {
-                    /*comment terminated*/
-                    return CORE_TRUE;
-                }
-            }
+    /*Some safety checks to help find bugs*/
+    if(a->magic_number == 0) {
+        /*Probably a new allocation, so make sure it is zeroed */
+        if(a->head != NULL || a->large != NULL || a->spare != NULL || a->chunk_size != 0) {
+            CORE_FATAL_ERROR("Your arena allocator has not been properly zeroed");
         }
-    } else {
-        fseek(fp, SEEK_SET, (int)pos);
-        return CORE_FALSE;
+
+        /*update the magic number to show the arena has been initialized*/
+        a->magic_number = (long)0xDEADBEEF;
+        a->chunk_size = CORE_ARENA_CHUNK_SIZE;
+    } else if(a->magic_number != (long)0xDEADBEEF) {
+        /*if the magic number is not 0 or DEADBEEF, then the arena has probably not been zeroed*/
+        CORE_FATAL_ERROR("Your arena allocator has not been properly zeroed");
     }
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-char * core_file_read_string(core_Arena * arena, FILE * fp)
+void * _core_arena_alloc_large(core_Arena * a, const size_t bytes)
 #ifdef CORE_IMPLEMENTATION
 {
-    char ch;
-    core_Bool escape = CORE_FALSE;
-    core_Vec(char) str = {0};
-    assert(!feof(fp));
-    assert(core_peek(fp) == '"');
-    fgetc(fp);
-
-    while(1) {
-        if(feof(fp)) return NULL;
-        ch = (char)fgetc(fp);
-        if(escape) {
-            escape = CORE_FALSE;
-            switch(ch) {
-            case 'n': core_vec_append(&str, arena, '\n'); break;
-            case '"': core_vec_append(&str, arena, '\"'); break;
-            case '\\': core_vec_append(&str, arena , '\\'); break;
-            default: return NULL;
-            }
-        } else if(ch == '\\') {
-            escape = CORE_TRUE;
-        } else if (ch == '"') {
-            core_vec_append(&str, arena, 0);
-            return str.items;
-        } else {
-            core_vec_append(&str, arena, ch);
-        }
-    }
+    core_ArenaChunk * chunk = _core_arena_chunk_alloc(a, CORE_ARENA_HEADER_SIZE + bytes);
+    core_Allocation * header;
+    if(chunk == NULL) return NULL;
+    header = (core_Allocation *)(void *)CORE_ARENA_CHUNK_DATA(chunk);
+    chunk->used = chunk->cap;
+    chunk->serial = a->large_serial++;
+    chunk->next = a->large;
+    if(a->large) a->large->prev = chunk;
+    a->large = chunk;
+    header->len = bytes;
+    header->active = CORE_TRUE;
+    header->large = CORE_TRUE;
+    header->offset = 0;
+    header->align_log2 = 0;
+    _core_arena_stats_reserve(a, CORE_ARENA_CHUNK_HEADER_SIZE + chunk->cap);
+    _core_arena_stats_carve(a, chunk->cap);
+    return (char *)header + CORE_ARENA_HEADER_SIZE;
 }
 #else
 ;
-#endif
-
-
-/**** FILE ****/
+#endif /*CORE_IMPLEMENTATION*/
 
-/* core_Bool core_file_read_all(FILE * fp, char * dst, const unsigned long dst_cap) */
-/* #ifdef CORE_IMPLEMENTATION */
-/* { */
-/*     unsigned long count = fread(dst, 1, dst_cap - 1, fp); */
-/*     dst[dst_cap - 1] = 0; */
-/*     if(count >= dst_cap - 1) return CORE_FALSE; */
-/*     return CORE_TRUE; */
-/* } */
-/* #else */
-/* ; */
-/* #endif /\*CORE_IMPLEMENTATION*\/ */
+/*reserve and commit for arenas made with core_arena_init_virtual, see VIRTUAL MEMORY*/
+void _core_arena_virtual_commit(core_Arena * a, const size_t bytes);
+void _core_arena_virtual_trim(core_Arena * a);
+void _core_arena_virtual_free(core_Arena * a);
 
-char * core_file_read_all_arena(core_Arena * arena, const char * filepath)
+core_ArenaChunk * _core_arena_push_chunk(core_Arena * a, const size_t bytes)
 #ifdef CORE_IMPLEMENTATION
 {
-    FILE * fp = fopen(filepath, "rb");
-    char * buf;
-    size_t filelen;
-    if(!fp) return NULL;
-    fseek(fp, 0, SEEK_END);
-    filelen = (size_t)ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    buf = core_arena_alloc(arena, filelen + 1);
-    fread(buf, 1, filelen, fp);
-    buf[filelen] = 0;
-    fclose(fp);
-    return buf;
+    core_ArenaChunk * chunk;
+    if(a->virtual_base != NULL) {
+        /*virtual arenas only ever have one chunk which grows in place*/
+        _core_arena_virtual_commit(a, a->head->used + bytes);
+        return a->head;
+    }
+    if(a->spare != NULL && a->spare->cap >= bytes) {
+        /*reuse a chunk left over from core_arena_rewind*/
+        chunk = a->spare;
+        a->spare = chunk->next;
+        chunk->used = 0;
+    } else {
+        chunk = _core_arena_chunk_alloc(a, CORE_MAX(a->chunk_size, bytes));
+        if(chunk == NULL) return NULL;
+        _core_arena_stats_reserve(a, CORE_ARENA_CHUNK_HEADER_SIZE + chunk->cap);
+        if(a->chunk_size < CORE_ARENA_CHUNK_SIZE_MAX) {
+            a->chunk_size *= 2;
+        }
+    }
+    chunk->prev = NULL;
+    chunk->next = a->head;
+    if(a->head) a->head->prev = chunk;
+    a->head = chunk;
+    return chunk;
 }
 #else
 ;
-#endif /* CORE_IMPLEMENTATION */
+#endif /*CORE_IMPLEMENTATION*/
 
+void * _core_arena_alloc_slow(core_Arena * a, const size_t bytes)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaChunk * chunk;
+    core_Allocation * header;
+    _core_arena_check_initialized(a);
 
-/*TODO
-  
-  CORE_ERR
-  CORE_OK
-
-  CORE_LOG_ERROR
-*/
+    /*allocations bigger than a quarter chunk would waste too much of the chunk tail*/
+    if(_core_arena_is_large(a, bytes)) {
+        return _core_arena_alloc_large(a, bytes);
+    }
 
+    chunk = _core_arena_push_chunk(a, CORE_ARENA_HEADER_SIZE + bytes);
+    if(chunk == NULL) return NULL;
+    header = (core_Allocation *)(void *)(CORE_ARENA_CHUNK_DATA(chunk) + chunk->used);
+    chunk->used += CORE_ARENA_HEADER_SIZE + bytes;
+    assert(chunk->used <= chunk->cap);
+    header->len = bytes;
+    header->active = CORE_TRUE;
+    header->large = CORE_FALSE;
+    header->offset = 0;
+    header->align_log2 = 0;
+    _core_arena_stats_carve(a, CORE_ARENA_HEADER_SIZE + bytes);
+    return (char *)header + CORE_ARENA_HEADER_SIZE;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-/**** DEFER ****/
-#define CORE_DEFER(label) \
-    while(0) \
-        while(1) \
-            if (1) { \
-                goto label##_done_; \
-            } else label:
+CORE_NODISCARD
+void * core_arena_alloc(core_Arena * a, const size_t bytes)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaChunk * chunk = a->head;
+    const size_t len = CORE_ARENA_ALIGN_UP(bytes == 0 ? 1 : bytes, CORE_ARENA_ALIGNMENT);
+    const unsigned int size_class = _core_arena_reuse_class(a, len);
+    void * result;
+
+    if(size_class < CORE_ARENA_SIZE_CLASSES && a->free_lists[size_class] != NULL) {
+        void * ptr = a->free_lists[size_class];
+        a->free_lists[size_class] = CORE_ARENA_FREE_LIST_NEXT(ptr);
+        assert(!CORE_ARENA_ALLOCATION(ptr)->active);
+        assert(CORE_ARENA_ALLOCATION(ptr)->len >= len);
+        CORE_ARENA_ALLOCATION(ptr)->active = CORE_TRUE;
+        CORE_ARENA_ALLOCATION(ptr)->align_log2 = 0;
+        _core_arena_stats_alloc(a, bytes, CORE_ARENA_ALLOCATION(ptr)->len);
+        _CORE_ARENA_STATS(a->stats.bytes_free_listed -= CORE_ARENA_HEADER_SIZE + CORE_ARENA_ALLOCATION(ptr)->len);
+        return ptr;
+    }
+    if(CORE_LIKELY_TRUE(chunk != NULL && chunk->cap - chunk->used >= CORE_ARENA_HEADER_SIZE + len)) {
+        core_Allocation * header = (core_Allocation *)(void *)(CORE_ARENA_CHUNK_DATA(chunk) + chunk->used);
+        chunk->used += CORE_ARENA_HEADER_SIZE + len;
+        header->len = len;
+        header->active = CORE_TRUE;
+        header->large = CORE_FALSE;
+        header->offset = 0;
+        header->align_log2 = 0;
+        _core_arena_stats_alloc(a, bytes, len);
+        _core_arena_stats_carve(a, CORE_ARENA_HEADER_SIZE + len);
+        return (char *)header + CORE_ARENA_HEADER_SIZE;
+    }
+    result = _core_arena_alloc_slow(a, len);
+    /*only allocations that succeeded are counted*/
+    if(result != NULL) {
+        _core_arena_stats_alloc(a, bytes, len);
+    }
+    return result;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-#define CORE_DEFERRED(label) do { goto label; label##_done_:; } while (0)
+void * _core_arena_alloc_large_aligned(core_Arena * a, const size_t len, const size_t align)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaChunk * chunk = _core_arena_chunk_alloc(a, CORE_ARENA_HEADER_SIZE + len + align);
+    char * data;
+    char * ptr;
+    core_Allocation * header;
+    if(chunk == NULL) return NULL;
+    data = CORE_ARENA_CHUNK_DATA(chunk);
+    ptr = data + CORE_ARENA_ALIGN_UP((size_t)data + CORE_ARENA_HEADER_SIZE, align) - (size_t)data;
+    header = CORE_ARENA_ALLOCATION(ptr);
+    chunk->used = chunk->cap;
+    chunk->serial = a->large_serial++;
+    chunk->next = a->large;
+    if(a->large) a->large->prev = chunk;
+    a->large = chunk;
+    header->len = len;
+    header->active = CORE_TRUE;
+    header->large = CORE_TRUE;
+    header->offset = (unsigned int)((char *)header - data);
+    header->align_log2 = (unsigned char)core_log2_floor(align);
+    _core_arena_stats_reserve(a, CORE_ARENA_CHUNK_HEADER_SIZE + chunk->cap);
+    _core_arena_stats_carve(a, chunk->cap);
+    return ptr;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
+/*align must be a power of two, the alignment is kept by core_arena_realloc*/
+CORE_NODISCARD
+void * core_arena_alloc_aligned(core_Arena * a, const size_t bytes, const size_t align)
+#ifdef CORE_IMPLEMENTATION
+{
+    const size_t len = CORE_ARENA_ALIGN_UP(bytes == 0 ? 1 : bytes, CORE_ARENA_ALIGNMENT);
+    core_ArenaChunk * chunk = a->head;
+    core_Allocation * header;
+    char * start;
+    char * ptr;
+
+    assert(align > 0 && (align & (align - 1)) == 0 && "alignment must be a power of two");
+    if(align <= CORE_ARENA_ALIGNMENT) return core_arena_alloc(a, bytes);
+
+    _core_arena_check_initialized(a);
+    if(_core_arena_is_large(a, len + align)) {
+        ptr = _core_arena_alloc_large_aligned(a, len, align);
+        if(ptr != NULL) {
+            _core_arena_stats_alloc(a, bytes, len);
+        }
+        return ptr;
+    }
 
-/**** CONCAT ****/
-#define CORE_CONCAT9(x, y) x##y
-#define CORE_CONCAT8(x, y) CORE_CONCAT9(x, y)
-#define CORE_CONCAT7(x, y) CORE_CONCAT8(x, y)
-#define CORE_CONCAT6(x, y) CORE_CONCAT7(x, y)
-#define CORE_CONCAT5(x, y) CORE_CONCAT6(x, y)
-#define CORE_CONCAT4(x, y) CORE_CONCAT5(x, y)
-#define CORE_CONCAT3(x, y) CORE_CONCAT4(x, y)
-#define CORE_CONCAT2(x, y) CORE_CONCAT3(x, y)
-#define CORE_CONCAT1(x, y) CORE_CONCAT2(x, y)
-#define CORE_CONCAT(x, y)  CORE_CONCAT1(x, y)
+    for(;;) {
+        if(chunk != NULL) {
+            start = CORE_ARENA_CHUNK_DATA(chunk) + chunk->used;
+            ptr = start + (CORE_ARENA_ALIGN_UP((size_t)start + CORE_ARENA_HEADER_SIZE, align) - (size_t)start);
+            if(ptr + len <= CORE_ARENA_CHUNK_DATA(chunk) + chunk->cap) break;
+        }
+        chunk = _core_arena_push_chunk(a, CORE_ARENA_HEADER_SIZE + len + align);
+        if(chunk == NULL) return NULL;
+    }
 
+    /*the padding in front of the header is simply skipped over*/
+    chunk->used = (size_t)(ptr + len - CORE_ARENA_CHUNK_DATA(chunk));
+    header = CORE_ARENA_ALLOCATION(ptr);
+    header->len = len;
+    header->active = CORE_TRUE;
+    header->large = CORE_FALSE;
+    header->offset = 0;
+    header->align_log2 = (unsigned char)core_log2_floor(align);
+    _core_arena_stats_alloc(a, bytes, len);
+    _core_arena_stats_carve(a, (size_t)(ptr + len - start));
+    return ptr;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-/**** STATIC ASSERT ****/
-#if defined(CORE_C23)
-#   define CORE_STATIC_ASSERT(condition, message) static_assert(condition, message)
-#elif defined(CORE_C11)
-#   define CORE_STATIC_ASSERT(condition, message) _Static_assert(condition, message)
+/*aligned to and padded out to a whole cache line so nothing else shares it*/
+CORE_NODISCARD
+void * core_arena_alloc_cacheline(core_Arena * a, const size_t bytes)
+#ifdef CORE_IMPLEMENTATION
+{
+    return core_arena_alloc_aligned(a, CORE_ARENA_ALIGN_UP(bytes, CORE_CACHE_LINE_SIZE), CORE_CACHE_LINE_SIZE);
+}
 #else
-#   define CORE_STATIC_ASSERT(condition, message) const int static_assertion_##__COUNTER__[ condition ? 1 : -1 ];
-#endif /*__STDC_VERSION__*/
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-/**** ALIGNOF ****/
-#if defined(__GNUC__) || defined(__clang__)
-#    define CORE_ALIGNOF(type) __alignof__(type)
-#elif defined(_MSC_VER)
-#    define CORE_ALIGNOF(type) __alignof(type)
+#define core_arena_new_aligned(arena, Type, count, align) \
+    ((Type *)core_arena_alloc_aligned(arena, sizeof(Type) * (size_t)(count), CORE_MAX((size_t)(align), CORE_ALIGNOF(Type))))
+#define core_arena_new_array(arena, Type, count) core_arena_new_aligned(arena, Type, count, CORE_ALIGNOF(Type))
+#define core_arena_new_simd16(arena, Type, count) core_arena_new_aligned(arena, Type, count, 16)
+#define core_arena_new_simd32(arena, Type, count) core_arena_new_aligned(arena, Type, count, 32)
+#define core_arena_new_simd64(arena, Type, count) core_arena_new_aligned(arena, Type, count, 64)
+
+void core_arena_reclaim_memory(core_Arena * a, void * ptr) /*Equivalent to free(ptr)*/
+#ifdef CORE_IMPLEMENTATION
+{
+    core_Allocation * header = NULL;
+    assert(ptr != NULL);
+    header = CORE_ARENA_ALLOCATION(ptr);
+    assert(header->active);
+    header->active = CORE_FALSE;
+    _CORE_ARENA_STATS(++a->stats.reclaim_count);
+
+    if(header->large) {
+        core_ArenaChunk * chunk = CORE_ARENA_LARGE_CHUNK(header);
+        if(chunk->prev) chunk->prev->next = chunk->next;
+        else a->large = chunk->next;
+        if(chunk->next) chunk->next->prev = chunk->prev;
+        _CORE_ARENA_STATS(a->stats.bytes_used -= chunk->cap);
+        _CORE_ARENA_STATS(a->stats.bytes_reserved -= CORE_ARENA_CHUNK_HEADER_SIZE + chunk->cap);
+        _core_arena_chunk_release(a, chunk);
+    } else if(a->head && (char *)ptr + header->len == CORE_ARENA_CHUNK_DATA(a->head) + a->head->used) {
+        /*the most recent allocation can simply be popped off the chunk*/
+        a->head->used -= CORE_ARENA_HEADER_SIZE + header->len;
+        _CORE_ARENA_STATS(a->stats.bytes_used -= CORE_ARENA_HEADER_SIZE + header->len);
+    } else {
+        const unsigned int size_class = _core_arena_free_class(header->len);
+        _CORE_ARENA_STATS(a->stats.bytes_free_listed += CORE_ARENA_HEADER_SIZE + header->len);
+        CORE_ARENA_FREE_LIST_NEXT(ptr) = a->free_lists[size_class];
+        a->free_lists[size_class] = ptr;
+    }
+}
 #else
-#    define CORE_ALIGNOF(type) ((size_t)&((struct { char c; type member; } *)0)->member)
-#endif /*defined(__GNUC__) || defined(__clang__)*/
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-/**** LIKELY ****/
-#if defined(__GNUC__) || defined(__clang__)
-#    define CORE_LIKELY_TRUE(expr)  __builtin_expect(expr, 1)
-#    define CORE_LIKELY_FALSE(expr) __builtin_expect(expr, 0)
+void * _core_arena_realloc_large(core_Arena * a, core_Allocation * header, const size_t bytes, const size_t len)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaChunk * chunk = realloc(CORE_ARENA_LARGE_CHUNK(header), CORE_ARENA_CHUNK_HEADER_SIZE + CORE_ARENA_HEADER_SIZE + len);
+    if(chunk == NULL) return NULL;
+    header = (core_Allocation *)(void *)CORE_ARENA_CHUNK_DATA(chunk);
+    (void)bytes;
+    _CORE_ARENA_STATS(++a->stats.realloc_count);
+    _CORE_ARENA_STATS(++a->stats.realloc_in_place_count);
+    _CORE_ARENA_STATS(a->stats.bytes_requested += bytes - header->len);
+    _CORE_ARENA_STATS(a->stats.bytes_allocated += len - header->len);
+    _core_arena_stats_reserve(a, len - header->len);
+    _core_arena_stats_carve(a, len - header->len);
+    if(chunk->prev) chunk->prev->next = chunk;
+    else a->large = chunk;
+    if(chunk->next) chunk->next->prev = chunk;
+    chunk->cap = CORE_ARENA_HEADER_SIZE + len;
+    chunk->used = chunk->cap;
+    header->len = len;
+    return (char *)header + CORE_ARENA_HEADER_SIZE;
+}
 #else
-#    define CORE_LIKELY_TRUE(expr) expr
-#    define CORE_LIKELY_FALSE(expr) expr
-#endif /*defined(__GNUC__) || defined(__clang__)*/
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-/**** MINMAX ****/
-#define CORE_MIN(a, b) ((a) < (b) ? (a) : (b))
-#define CORE_MAX(a, b) ((a) > (b) ? (a) : (b))
-#define CORE_MIN3(a, b, c) CORE_MIN(CORE_MIN(a, b), c)
-#define CORE_MAX3(a, b, c) CORE_MAX(CORE_MAX(a, b), c)
+/*grows in place when ptr is a large allocation or the last allocation in the
+  current chunk, otherwise the contents are moved to a new block with the same alignment.
+  a block allocated before the latest mark is always moved, growing it in place would
+  stretch it past the mark and a rewind would hand out memory it still covers*/
+CORE_NODISCARD
+void * core_arena_realloc(core_Arena * a, void * ptr, const size_t bytes)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_Allocation * header = NULL;
+    core_ArenaChunk * chunk = a->head;
+    void * new = NULL;
+    core_Bool tail;
+    size_t len;
+    assert(ptr != NULL);
+    header = CORE_ARENA_ALLOCATION(ptr);
+    assert(header->active);
+    if(bytes <= header->len) {
+        _CORE_ARENA_STATS(++a->stats.realloc_count);
+        _CORE_ARENA_STATS(++a->stats.realloc_in_place_count);
+        return ptr;
+    }
+    len = CORE_ARENA_ALIGN_UP(bytes, CORE_ARENA_ALIGNMENT);
 
-/**** LIST ****/
-#define core_List(T) struct core_List##T { T v; struct core_List##T * next; }
-#define core_list_push(list, arena, item) do {              \
-        void * tmp = (list);                                \
-        (list) = core_arena_alloc((arena)sizeof(*(list)));  \
-        (list)->v = item;                                   \
-        (list)->next = tmp;                                 \
-    } while (0)
+    if(header->large && header->align_log2 == 0 && a->allocator == NULL) {
+        return _core_arena_realloc_large(a, header, bytes, len);
+    }
+    tail = chunk != NULL
+        && (char *)ptr + header->len == CORE_ARENA_CHUNK_DATA(chunk) + chunk->used
+        && (chunk != a->floor_chunk || (size_t)((char *)header - CORE_ARENA_CHUNK_DATA(chunk)) >= a->floor_used);
+    if(tail && a->virtual_base != NULL) {
+        _core_arena_virtual_commit(a, chunk->used + len - header->len);
+    }
+    if(tail && chunk->cap - chunk->used >= len - header->len) {
+        _CORE_ARENA_STATS(++a->stats.realloc_count);
+        _CORE_ARENA_STATS(++a->stats.realloc_in_place_count);
+        _CORE_ARENA_STATS(a->stats.bytes_requested += bytes - header->len);
+        _CORE_ARENA_STATS(a->stats.bytes_allocated += len - header->len);
+        _core_arena_stats_carve(a, len - header->len);
+        chunk->used += len - header->len;
+        header->len = len;
+        return ptr;
+    }
 
+    new = header->align_log2 == 0
+        ? core_arena_alloc(a, len)
+        : core_arena_alloc_aligned(a, len, (size_t)1 << header->align_log2);
+    if(new == NULL) return NULL;
+    _CORE_ARENA_STATS(++a->stats.realloc_count);
+    memcpy(new, ptr, header->len);
+    core_arena_reclaim_memory(a, ptr);
+    return new;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-/**** STRING ****/
-int core_strlcpy(char * dst, const char * src, int dst_size)
+/*number of usable bytes behind ptr, which may be more than were asked for*/
+size_t core_arena_capacity(void * ptr)
 #ifdef CORE_IMPLEMENTATION
 {
-    /*Returns the number of bytes written*/
-    int i;
-    if(dst_size == 0) return 0;
-    if(!dst) return 0;
-    if(!src && dst_size > 0) {
-        dst[0] = 0;
+    assert(ptr != NULL);
+    assert(CORE_ARENA_ALLOCATION(ptr)->active);
+    return CORE_ARENA_ALLOCATION(ptr)->len;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+    
+    
+void core_arena_free(core_Arena * a)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaChunk * chunk = NULL;
+    core_ArenaChunk * next = NULL;
+    if(a->virtual_base != NULL) {
+        _core_arena_virtual_free(a);
+        return;
     }
-    for(i = 0; i < (dst_size - 1) && src[i] != 0; ++i) {
-        dst[i] = src[i];
+    for(chunk = a->head; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        _core_arena_chunk_release(a, chunk);
     }
-    dst[i] = 0;
-    return i;
+    for(chunk = a->large; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        _core_arena_chunk_release(a, chunk);
+    }
+    for(chunk = a->spare; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        _core_arena_chunk_release(a, chunk);
+    }
+    memset(a, 0, sizeof(*a));
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-void core_strnfmt(char * dst, unsigned long dst_len, unsigned long * dst_fill_pointer, const char * src, const unsigned long src_len)
+/*until the mark is rewound, core_arena_realloc moves blocks allocated before it instead of
+  growing them in place. a block that is moved or allocated after the mark is freed by the
+  rewind, so containers built before the mark should not grow between the two*/
+core_ArenaMark core_arena_mark(core_Arena * a)
 #ifdef CORE_IMPLEMENTATION
 {
-    unsigned long i = 0;
-    assert(dst_fill_pointer);
-    assert(dst);
-    assert(src);
-    assert(strlen(src) == src_len && "inaccurate length");
-    
-    if(*dst_fill_pointer + src_len + 1 >= dst_len) CORE_FATAL_ERROR("Buffer overflow");
-    for(i = 0; i < src_len; ++i) {
-        dst[*dst_fill_pointer] = src[i];
-        ++*dst_fill_pointer;
-        assert(*dst_fill_pointer < dst_len);
-    }
-    dst[*dst_fill_pointer] = 0;
+    core_ArenaMark mark;
+    mark.chunk = a->head;
+    mark.used = a->head ? a->head->used : 0;
+    mark.large_serial = a->large_serial;
+    mark.floor_chunk = a->floor_chunk;
+    mark.floor_used = a->floor_used;
+    a->floor_chunk = mark.chunk;
+    a->floor_used = mark.used;
+    return mark;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-void core_strfmt(char * dst, unsigned long dst_len, unsigned long * dst_fill_pointer, const char * src)
+/*frees everything allocated after the mark was taken, chunks are kept around for reuse.
+  reclaimed blocks and pools are forgotten since they may live past the mark*/
+void core_arena_rewind(core_Arena * a, core_ArenaMark mark)
 #ifdef CORE_IMPLEMENTATION
 {
-    core_strnfmt(dst, dst_len, dst_fill_pointer, src, strlen(src));
+    memset(a->free_lists, 0, sizeof(a->free_lists));
+    a->pools = NULL;
+    a->floor_chunk = mark.floor_chunk;
+    a->floor_used = mark.floor_used;
+    while(a->head != mark.chunk && a->virtual_base == NULL) {
+        core_ArenaChunk * chunk = a->head;
+        assert(chunk != NULL && "Arena mark does not belong to this arena");
+        a->head = chunk->next;
+        chunk->next = a->spare;
+        a->spare = chunk;
+    }
+    if(a->head) {
+        a->head->prev = NULL;
+        a->head->used = mark.chunk == NULL ? 0 : mark.used;
+    }
+    while(a->large != NULL && a->large->serial >= mark.large_serial) {
+        core_ArenaChunk * chunk = a->large;
+        a->large = chunk->next;
+        _CORE_ARENA_STATS(a->stats.bytes_reserved -= CORE_ARENA_CHUNK_HEADER_SIZE + chunk->cap);
+        _core_arena_chunk_release(a, chunk);
+    }
+    if(a->large) a->large->prev = NULL;
+
+#ifdef CORE_ARENA_STATS
+    {
+        core_ArenaChunk * chunk;
+        a->stats.bytes_used = 0;
+        a->stats.bytes_free_listed = 0;
+        for(chunk = a->head; chunk != NULL; chunk = chunk->next) a->stats.bytes_used += chunk->used;
+        for(chunk = a->large; chunk != NULL; chunk = chunk->next) a->stats.bytes_used += chunk->used;
+    }
+#endif /*CORE_ARENA_STATS*/
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-core_Bool core_streql(const char * lhs, const char * rhs)
+void core_arena_reset(core_Arena * a)
 #ifdef CORE_IMPLEMENTATION
 {
-    return strcmp(lhs, rhs) == 0;
+    core_ArenaMark empty = {0};
+    core_arena_rewind(a, empty);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-core_Bool core_streql_any(const char * str, const char ** options, size_t n)
+/*gives memory past the current arena position back to the os, call after a
+  reset or rewind to drop the resident set size*/
+void core_arena_trim(core_Arena * a)
 #ifdef CORE_IMPLEMENTATION
 {
-    size_t i;
-    for(i = 0; i < n; ++i) {
-        if(core_streql(str, options[i])) return CORE_TRUE;
+    core_ArenaChunk * chunk = NULL;
+    core_ArenaChunk * next = NULL;
+    if(a->virtual_base != NULL) {
+        _core_arena_virtual_trim(a);
+        return;
+    }
+    for(chunk = a->spare, a->spare = NULL; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        if((char *)chunk == a->buffer) {
+            /*the caller's buffer stays with the arena*/
+            chunk->next = NULL;
+            a->spare = chunk;
+            continue;
+        }
+        _CORE_ARENA_STATS(a->stats.bytes_reserved -= CORE_ARENA_CHUNK_HEADER_SIZE + chunk->cap);
+        _core_arena_chunk_release(a, chunk);
     }
-    return CORE_FALSE;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
+/*an arena whose chunks come from the given allocator instead of malloc*/
+void core_arena_init_allocator(core_Arena * a, const core_ArenaAllocator * allocator)
+#ifdef CORE_IMPLEMENTATION
+{
+    memset(a, 0, sizeof(*a));
+    a->allocator = allocator;
+    a->chunk_size = CORE_ARENA_CHUNK_SIZE;
+    a->magic_number = (long)0xDEADBEEF;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-char * core_strdup_via_arena(core_Arena * arena, const char * str, size_t len)
+/*an arena that allocates out of the caller's buffer first. once it is full
+  CORE_ARENA_OVERFLOW_FAIL makes allocations return NULL and CORE_ARENA_OVERFLOW_CHAIN
+  takes further chunks from allocator (malloc when NULL). the buffer is never freed*/
+void core_arena_init_buffer(core_Arena * a, void * buffer, size_t size, core_ArenaOverflow overflow, const core_ArenaAllocator * allocator)
 #ifdef CORE_IMPLEMENTATION
 {
-    char * new = NULL;
-    unsigned long i = 0;
-    assert(strlen(str) == len && "inaccurate length");
-    new = core_arena_alloc(arena, len + 1);
-    for(i = 0; i <= len; ++i) {
-        new[i] = str[i];
-    }
-    assert(new[len] == 0);
-    return new;
+    char * start = (char *)buffer + (CORE_ARENA_ALIGN_UP((size_t)buffer, CORE_ARENA_ALIGNMENT) - (size_t)buffer);
+    assert(buffer != NULL);
+    assert(size >= (size_t)(start - (char *)buffer) + CORE_ARENA_CHUNK_HEADER_SIZE && "arena buffer is too small");
+    core_arena_init_allocator(a, allocator);
+    a->buffer = start;
+    a->overflow = overflow;
+    a->head = (core_ArenaChunk *)(void *)start;
+    a->head->next = NULL;
+    a->head->prev = NULL;
+    a->head->cap = size - (size_t)(start - (char *)buffer) - CORE_ARENA_CHUNK_HEADER_SIZE;
+    a->head->used = 0;
+    a->head->serial = 0;
+    _core_arena_stats_reserve(a, CORE_ARENA_CHUNK_HEADER_SIZE + a->head->cap);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
 
-/**** SNPRINTF ****/
-#define core_itoa core_stringify_long
-int core_stringify_long(char * dst, size_t dst_size, long num)
+#ifdef CORE_ARENA_STATS
+void core_arena_stats_fprint(FILE * fp, core_Arena * a)
 #ifdef CORE_IMPLEMENTATION
 {
-    int i = 0;
-    int j,k;
-    core_Bool neg = num < 0;
-    if(dst_size < 2) return 0;
-    if(num == 0) {
-        dst[0] = '0';
-        dst[1] = 0;
-        return 1;
-    }
-    
-    if(neg) num = num * -1;
-    for(i = 0; i + 2 < (int)dst_size && num > 0; ++i, num /= 10) {
-        dst[i] = (char)(num % 10) + '0';
+    const core_ArenaStats * st = &a->stats;
+    int i;
+    fprintf(fp, "arena %p:\n", (void *)a);
+    fprintf(fp, "    requested:       %lu bytes\n", (unsigned long)st->bytes_requested);
+    fprintf(fp, "    allocated:       %lu bytes (%.1f%% internal fragmentation)\n",
+            (unsigned long)st->bytes_allocated,
+            st->bytes_allocated == 0 ? 0.0 : 100.0 * (double)(st->bytes_allocated - st->bytes_requested) / (double)st->bytes_allocated);
+    fprintf(fp, "    used:            %lu bytes (peak %lu, %lu in free lists)\n",
+            (unsigned long)st->bytes_used, (unsigned long)st->peak_used, (unsigned long)st->bytes_free_listed);
+    fprintf(fp, "    reserved:        %lu bytes (peak %lu)\n",
+            (unsigned long)st->bytes_reserved, (unsigned long)st->peak_reserved);
+    fprintf(fp, "    allocs:          %lu\n", st->alloc_count);
+    fprintf(fp, "    reallocs:        %lu (%lu in place)\n", st->realloc_count, st->realloc_in_place_count);
+    fprintf(fp, "    reclaims:        %lu\n", st->reclaim_count);
+    fprintf(fp, "    request sizes:\n");
+    for(i = 0; i < CORE_ARENA_HISTOGRAM_BUCKETS; ++i) {
+        if(st->histogram[i] == 0) continue;
+        fprintf(fp, "        >= %-10lu %lu\n", 1UL << i, st->histogram[i]);
     }
-
-    if(neg && i + 2 < (int)dst_size) {
-        dst[i++] = '-';
+#ifdef CORE_ARENA_DEBUG
+    fprintf(fp, "    callsites:\n");
+    for(i = 0; i < CORE_ARENA_CALLSITES_MAX; ++i) {
+        const core_ArenaCallsite * site = &st->callsites[i];
+        if(site->file == NULL) continue;
+        fprintf(fp, "        %s:%d: %lu allocations, %lu bytes\n",
+                site->file, site->line, site->count, (unsigned long)site->bytes);
     }
-    for(j = 0, k = i - 1; j < k; ++j, --k) {
-        char tmp = dst[j];
-        dst[j] = dst[k];
-        dst[k] = tmp;
+    if(st->callsites_dropped > 0) {
+        fprintf(fp, "        (%lu allocations from untracked callsites)\n", st->callsites_dropped);
     }
-    dst[i] = 0;
-    return i;
+#endif /*CORE_ARENA_DEBUG*/
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
+#endif /*CORE_ARENA_STATS*/
 
-core_Bool core_double_has_fractional_part(double num)
+#ifdef CORE_ARENA_DEBUG
+void _core_arena_callsite_record(core_Arena * a, size_t bytes, const char * file, int line)
 #ifdef CORE_IMPLEMENTATION
 {
-    return num - (long)num > 0 || num - (long) num < 0;
+    unsigned long hash = (unsigned long)(size_t)file * 31UL + (unsigned long)line;
+    unsigned long i;
+    for(i = 0; i < CORE_ARENA_CALLSITES_MAX; ++i) {
+        core_ArenaCallsite * site = &a->stats.callsites[(hash + i) % CORE_ARENA_CALLSITES_MAX];
+        if(site->file == NULL) {
+            site->file = file;
+            site->line = line;
+        }
+        if(site->file == file && site->line == line) {
+            ++site->count;
+            site->bytes += bytes;
+            return;
+        }
+    }
+    ++a->stats.callsites_dropped;
 }
 #else
 ;
-#endif
-
+#endif /*CORE_IMPLEMENTATION*/
 
-int core_stringify_double(char * dst, size_t dst_size, int precision, double num)
+CORE_NODISCARD
+void * core_arena_alloc_at(core_Arena * a, size_t bytes, const char * file, int line)
 #ifdef CORE_IMPLEMENTATION
 {
-    long int_part = (long)num;
-    double fractional_part = num - (double)int_part;
-    int i = 0;
-    int digits = 0;
-    while(core_double_has_fractional_part(fractional_part) && digits < precision) {
-        fractional_part *= 10;
-        ++digits;
-    }
-    i = core_stringify_long(dst, dst_size, int_part);
-    if(i + 2 < (int)dst_size) {
-        dst[i] = '.';
-        ++i;
-    }
-    i = core_stringify_long(&dst[i], dst_size - (size_t)i, (long)fractional_part);
-    return i;
+    void * ptr = core_arena_alloc(a, bytes);
+    if(ptr != NULL) _core_arena_callsite_record(a, bytes, file, line);
+    return ptr;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-typedef struct {
-    /*flags*/
-    core_Bool flag_left_justify;
-    core_Bool flag_show_plus_on_positive_integers;
-    core_Bool flag_pad_if_no_sign;
-    core_Bool flag_hash;
-    core_Bool flag_pad_with_zeros;
+CORE_NODISCARD
+void * core_arena_realloc_at(core_Arena * a, void * ptr, size_t bytes, const char * file, int line)
+#ifdef CORE_IMPLEMENTATION
+{
+    const size_t grown = bytes - CORE_MIN(bytes, core_arena_capacity(ptr));
+    void * new = core_arena_realloc(a, ptr, bytes);
+    if(new != NULL) _core_arena_callsite_record(a, grown, file, line);
+    return new;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-    /*width*/
-    core_Bool read_width_from_args;
-    int width;
+/*everything below this point, including the vec and hashmap macros, is
+  attributed to the line that called it*/
+#   define core_arena_alloc(a, bytes) core_arena_alloc_at(a, bytes, __FILE__, __LINE__)
+#   define core_arena_realloc(a, ptr, bytes) core_arena_realloc_at(a, ptr, bytes, __FILE__, __LINE__)
+#endif /*CORE_ARENA_DEBUG*/
 
-    /*precision*/
-    core_Bool read_precision_from_args;
-    int precision;
+/**** VIRTUAL MEMORY ****/
+#if defined(CORE_UNIX)
+#   include <sys/mman.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif /*CORE_UNIX*/
 
-    /*type length char*/
-    char length[3];
+#ifndef CORE_ARENA_VIRTUAL_COMMIT_SIZE
+#   define CORE_ARENA_VIRTUAL_COMMIT_SIZE (1024 * 1024)
+#endif /*CORE_ARENA_VIRTUAL_COMMIT_SIZE*/
+#define CORE_ARENA_HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
-    /*specifier char*/
-    char specifier;
-} core_SNPrintfParameters;
+/*flags for core_arena_init_virtual. huge pages are only requested when
+  <sys/mman.h> exposes MADV_HUGEPAGE, which glibc hides under strict -std=c89
+  unless _DEFAULT_SOURCE is defined before including core.h*/
+#define CORE_ARENA_VIRTUAL_HUGE_PAGES 1
 
-/*Note: This implementation currently does not actually do anything with many of the parameters*/
-void core_snprintf_exec_parameters(char * dst, size_t n, size_t * dst_i, va_list args, core_SNPrintfParameters p) {
-    switch(p.specifier) {
-    case 's': {
-        const char * str = va_arg(args, const char *);
-        size_t len = strlen(str);
-        if(*dst_i + len + 2 > n) {
-            CORE_TODO("Handle the case where there is not enough room to print the string");
+size_t _core_arena_virtual_granularity(core_Arena * a)
+#ifdef CORE_IMPLEMENTATION
+{
+    return (a->virtual_flags & CORE_ARENA_VIRTUAL_HUGE_PAGES)
+        ? CORE_MAX(CORE_ARENA_VIRTUAL_COMMIT_SIZE, CORE_ARENA_HUGE_PAGE_SIZE)
+        : CORE_ARENA_VIRTUAL_COMMIT_SIZE;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*makes sure the first `bytes` bytes of the virtual chunk's data are backed by memory*/
+void _core_arena_virtual_commit(core_Arena * a, const size_t bytes)
+#ifdef CORE_IMPLEMENTATION
+{
+#if defined(CORE_UNIX)
+    core_ArenaChunk * chunk = a->head;
+    const size_t committed = CORE_ARENA_CHUNK_HEADER_SIZE + chunk->cap;
+    const size_t limit = (size_t)(a->virtual_base + a->virtual_reserved - (char *)chunk);
+    size_t commit;
+    if(bytes <= chunk->cap) return;
+    if(CORE_ARENA_CHUNK_HEADER_SIZE + bytes > limit) {
+        CORE_FATAL_ERROR("Virtual arena ran out of reserved address space");
+    }
+    commit = CORE_MAX(CORE_ARENA_ALIGN_UP(CORE_ARENA_CHUNK_HEADER_SIZE + bytes, _core_arena_virtual_granularity(a)), committed * 2);
+    commit = CORE_MIN(commit, limit);
+    if(mprotect((char *)chunk + committed, commit - committed, PROT_READ | PROT_WRITE) != 0) {
+        CORE_FATAL_ERROR("Failed to commit virtual arena memory");
+    }
+    _core_arena_stats_reserve(a, commit - committed);
+    chunk->cap = commit - CORE_ARENA_CHUNK_HEADER_SIZE;
+#else
+    (void)a;
+    (void)bytes;
+    CORE_UNREACHABLE;
+#endif /*CORE_UNIX*/
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*reserves `reserve` bytes of address space up front and commits pages as the
+  arena grows, so every allocation lives in one contiguous range that never moves.
+  returns CORE_FALSE if the range could not be reserved*/
+core_Bool core_arena_init_virtual(core_Arena * a, size_t reserve, unsigned int flags)
+#ifdef CORE_IMPLEMENTATION
+{
+#if defined(CORE_UNIX)
+    size_t granularity;
+    char * base;
+    char * aligned;
+    int fd;
+    memset(a, 0, sizeof(*a));
+    a->virtual_flags = flags;
+    granularity = _core_arena_virtual_granularity(a);
+    reserve = CORE_ARENA_ALIGN_UP(reserve, granularity) + granularity;
+
+    /*a private PROT_NONE mapping of /dev/zero reserves address space without any backing memory*/
+    fd = open("/dev/zero", O_RDWR);
+    if(fd < 0) return CORE_FALSE;
+    base = mmap(NULL, reserve, PROT_NONE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) return CORE_FALSE;
+
+    aligned = base + (CORE_ARENA_ALIGN_UP((size_t)base, granularity) - (size_t)base);
+    if(mprotect(aligned, granularity, PROT_READ | PROT_WRITE) != 0) {
+        munmap(base, reserve);
+        return CORE_FALSE;
+    }
+#   if defined(MADV_HUGEPAGE)
+    if(flags & CORE_ARENA_VIRTUAL_HUGE_PAGES) {
+        madvise(aligned, (size_t)(base + reserve - aligned), MADV_HUGEPAGE);
+    }
+#   endif /*MADV_HUGEPAGE*/
+
+    a->virtual_base = base;
+    a->virtual_reserved = reserve;
+    a->head = (core_ArenaChunk *)(void *)aligned;
+    a->head->next = NULL;
+    a->head->prev = NULL;
+    a->head->cap = granularity - CORE_ARENA_CHUNK_HEADER_SIZE;
+    a->head->used = 0;
+    a->head->serial = 0;
+    a->chunk_size = CORE_ARENA_CHUNK_SIZE;
+    a->magic_number = (long)0xDEADBEEF;
+    _core_arena_stats_reserve(a, granularity);
+    return CORE_TRUE;
+#else
+    (void)a;
+    (void)reserve;
+    (void)flags;
+    return CORE_FALSE;
+#endif /*CORE_UNIX*/
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*gives the pages past the arena's used bytes back to the os, they stay committed
+  and read back as zero*/
+void _core_arena_virtual_trim(core_Arena * a)
+#ifdef CORE_IMPLEMENTATION
+{
+#if defined(CORE_UNIX)
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char * data = CORE_ARENA_CHUNK_DATA(a->head);
+    char * begin = data + (CORE_ARENA_ALIGN_UP((size_t)data + a->head->used, page) - (size_t)data);
+    char * end = data + a->head->cap;
+    if(begin >= end) return;
+#   if defined(MADV_DONTNEED)
+    madvise(begin, (size_t)(end - begin), MADV_DONTNEED);
+#   else
+    {
+        /*without madvise, mapping fresh /dev/zero pages over the range drops the old ones*/
+        int fd = open("/dev/zero", O_RDWR);
+        if(fd < 0) return;
+        if(mmap(begin, (size_t)(end - begin), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            CORE_FATAL_ERROR("Failed to trim virtual arena memory");
         }
-        memcpy(&dst[*dst_i], str, len);
-        *dst_i += len;
-    } break;
-    case 'i':
-    case 'd': {
-        long num = 0;
-        if(p.length[0] == 'l') {
-            num = va_arg(args, long);
-        } else if(p.length[0] == 'h') {
-            num = va_arg(args, int);
-        } else {
-            num = va_arg(args, int);
+        close(fd);
+    }
+#   endif /*MADV_DONTNEED*/
+#else
+    (void)a;
+#endif /*CORE_UNIX*/
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void _core_arena_virtual_free(core_Arena * a)
+#ifdef CORE_IMPLEMENTATION
+{
+#if defined(CORE_UNIX)
+    munmap(a->virtual_base, a->virtual_reserved);
+#endif /*CORE_UNIX*/
+    memset(a, 0, sizeof(*a));
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/**** SCRATCH ****/
+#ifndef CORE_ARENA_SCRATCH_COUNT
+#   define CORE_ARENA_SCRATCH_COUNT 2
+#endif /*CORE_ARENA_SCRATCH_COUNT*/
+
+typedef struct {
+    core_Arena * arena;
+    core_ArenaMark mark;
+} core_ArenaScratch;
+
+#ifdef CORE_IMPLEMENTATION
+CORE_THREAD_LOCAL core_Arena _core_arena_scratch[CORE_ARENA_SCRATCH_COUNT];
+#endif /*CORE_IMPLEMENTATION*/
+
+/*borrows a thread local arena for temporaries, pass the arena holding the
+  results (if any) as conflict so the scratch arena is never the same one.
+  the arenas live until the thread calls core_arena_scratch_free, so every thread
+  that uses them must call it before it exits or their chunks leak.
+  core_ThreadPool workers already do*/
+core_ArenaScratch core_arena_scratch_begin(core_Arena * conflict)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaScratch scratch = {0};
+    int i;
+    for(i = 0; i < CORE_ARENA_SCRATCH_COUNT; ++i) {
+        if(&_core_arena_scratch[i] != conflict) {
+            scratch.arena = &_core_arena_scratch[i];
+            scratch.mark = core_arena_mark(scratch.arena);
+            return scratch;
         }
-        *dst_i += (size_t)core_stringify_long(&dst[*dst_i], n - *dst_i, num);
-    } break;
-    default: CORE_TODO("Handle other format specifiers"); break;
     }
+    CORE_UNREACHABLE;
 }
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-enum {
-    core_snprintf_state_base,
-    core_snprintf_state_flags,
-    core_snprintf_state_width,
-    core_snprintf_state_precision,
-    core_snprintf_state_precision_maybe,
-    core_snprintf_state_length_1,
-    core_snprintf_state_length_2,
-    core_snprintf_state_specifier
-};
+void core_arena_scratch_end(core_ArenaScratch scratch)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_arena_rewind(scratch.arena, scratch.mark);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
+/*releases the calling thread's scratch arenas back to malloc*/
+void core_arena_scratch_free(void)
+#ifdef CORE_IMPLEMENTATION
+{
+    int i;
+    for(i = 0; i < CORE_ARENA_SCRATCH_COUNT; ++i) {
+        core_arena_free(&_core_arena_scratch[i]);
+    }
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-#ifdef CORE_ATTRIBUTES_AVAILABLE
-__attribute__((format(printf, 3, 4)))
-#endif
-int core_snprintf(char * dst, size_t n, const char * fmt, ...)
+/*containers and helpers that can not hand a failed allocation back to their caller go
+  through this and die instead. that covers vecs, small vecs, hashmaps, strings, sexprs and
+  the staged containers, so on a CORE_ARENA_OVERFLOW_FAIL arena or with an allocator that
+  can fail only core_arena_alloc, core_arena_realloc and pools report NULL*/
+void * core_arena_check_alloc(void * ptr)
 #ifdef CORE_IMPLEMENTATION
 {
-    size_t dst_i = 0;
-    size_t fmt_i = 0;
-    int core_snprintf_state = core_snprintf_state_base;
+    if(ptr == NULL) {
+        CORE_FATAL_ERROR("Arena allocation failed");
+    }
+    return ptr;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-    core_SNPrintfParameters params = {0};
-    va_list args;
+char * core_arena_strdup(core_Arena * arena, const char * str)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long len = strlen(str);
+    char * mem = core_arena_check_alloc(core_arena_alloc(arena, len + 1));
+    memcpy(mem, str, len + 1);
+    assert(mem[len] == 0);
+    return mem;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-    va_start(args, fmt);
-    while(dst_i + 2 < n && fmt[fmt_i] != 0) {
-        switch(core_snprintf_state) {
-        case core_snprintf_state_base:
-            if(fmt[fmt_i] == '%') {
-                ++fmt_i;
-                core_snprintf_state = core_snprintf_state_flags;
-            } else {
-                dst[dst_i] = fmt[fmt_i];
-                ++dst_i;
-                ++fmt_i;
-            } 
-            break;
-        case core_snprintf_state_flags: {
-            core_Bool flag_encountered = CORE_TRUE;
-            switch(fmt[fmt_i]) {
-            case '-': params.flag_left_justify = CORE_TRUE; break;
-            case '+': params.flag_show_plus_on_positive_integers = CORE_TRUE; break;
-            case ' ': params.flag_pad_if_no_sign = CORE_TRUE; break;
-            case '#': params.flag_hash = CORE_TRUE; break;
-            case '0': params.flag_pad_with_zeros = CORE_TRUE; break;
-            default: flag_encountered = CORE_FALSE; break;
-            }
-            if(flag_encountered) {
-                ++fmt_i;
-            } else {
-                core_snprintf_state = core_snprintf_state_width;
-            }
-        } break;
-        case core_snprintf_state_width: {
-            if(fmt[fmt_i] == '*') {
-                params.read_width_from_args = CORE_TRUE;
-                ++fmt_i;
-                core_snprintf_state = core_snprintf_state_precision_maybe;
-            } else if(isdigit(fmt[fmt_i])) {
-                params.width *= 10;
-                params.width += fmt[fmt_i] - '0';
-                ++fmt_i;
-            } else {
-                core_snprintf_state = core_snprintf_state_precision_maybe;
-            }
-        } break;
-        case core_snprintf_state_precision_maybe: {
-            if(fmt[fmt_i] != '.') {
-                core_snprintf_state = core_snprintf_state_length_1;
-                params.precision = 6;
-            } else {
-                core_snprintf_state = core_snprintf_state_precision;
-                ++fmt_i;
-            }
-        } break;
-        case core_snprintf_state_precision: {
-            if(fmt[fmt_i] == '*') {
-                params.read_precision_from_args = CORE_TRUE;
-                ++fmt_i;
-                core_snprintf_state = core_snprintf_state_length_1;
-            } else if(isdigit(fmt[fmt_i])) {
-                params.precision *= 10;
-                params.precision += fmt[fmt_i] - '0';
-                ++fmt_i;
-            } else {
-                core_snprintf_state = core_snprintf_state_length_1;
-            }
-        } break;
-        case core_snprintf_state_length_1: {
-            char len = fmt[fmt_i];
-            switch(len) {
-            case 'l':
-            case 'h':
-                params.length[0] = len;
-                core_snprintf_state = core_snprintf_state_length_2;
-                ++fmt_i;
-                break;
-            case 'j':
-            case 'z':
-            case 't':
-            case 'L':
-                params.length[0] = len;
-                core_snprintf_state = core_snprintf_state_specifier;
-                ++fmt_i;
-                break;
-            default:
-                core_snprintf_state = core_snprintf_state_specifier;
-            }
-        } break;
-        case core_snprintf_state_length_2: {
-            char len = fmt[fmt_i];
-            switch(len) {
+/**** POOL ****/
+#ifndef CORE_POOL_SLAB_OBJECTS
+#   define CORE_POOL_SLAB_OBJECTS 64
+#endif /*CORE_POOL_SLAB_OBJECTS*/
+#ifndef CORE_POOL_SLAB_OBJECTS_MAX
+#   define CORE_POOL_SLAB_OBJECTS_MAX 4096
+#endif /*CORE_POOL_SLAB_OBJECTS_MAX*/
+#ifndef CORE_POOL_ALIGNMENT
+#   define CORE_POOL_ALIGNMENT sizeof(void *)
+#endif /*CORE_POOL_ALIGNMENT*/
+
+/*fixed size objects carved densely out of arena slabs, freed objects are kept
+  on an intrusive free list so alloc and free are both O(1)*/
+typedef struct core_Pool {
+    core_Arena * arena;
+    struct core_Pool * next;  /*next pool owned by the same arena*/
+    void * free_list;
+    char * slab;
+    size_t object_size;
+    size_t slab_objects;      /*objects in the current slab*/
+    size_t slab_used;         /*objects handed out from the current slab*/
+} core_Pool;
+
+/*slabs and the free list live in arena, so once arena is rewound or reset past the
+  pool's first allocation the pool points into rewound memory and must be initialised again*/
+void core_pool_init(core_Pool * pool, core_Arena * arena, size_t object_size)
+#ifdef CORE_IMPLEMENTATION
+{
+    assert(object_size > 0);
+    memset(pool, 0, sizeof(*pool));
+    pool->arena = arena;
+    pool->object_size = CORE_ARENA_ALIGN_UP(CORE_MAX(object_size, sizeof(void *)), CORE_POOL_ALIGNMENT);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*returns NULL and leaves the pool as it was when the arena cannot provide a new slab*/
+void * core_pool_alloc(core_Pool * pool)
+#ifdef CORE_IMPLEMENTATION
+{
+    void * result;
+    if(pool->free_list != NULL) {
+        result = pool->free_list;
+        pool->free_list = *(void **)result;
+        return result;
+    }
+    if(CORE_LIKELY_FALSE(pool->slab_used >= pool->slab_objects)) {
+        /*slabs double in size so big pools need few arena allocations*/
+        const size_t slab_objects = pool->slab_objects == 0
+            ? CORE_POOL_SLAB_OBJECTS
+            : CORE_MIN(pool->slab_objects * 2, CORE_POOL_SLAB_OBJECTS_MAX);
+        char * slab = core_arena_alloc(pool->arena, slab_objects * pool->object_size);
+        if(slab == NULL) return NULL;
+        pool->slab = slab;
+        pool->slab_objects = slab_objects;
+        pool->slab_used = 0;
+    }
+    result = pool->slab + pool->slab_used * pool->object_size;
+    ++pool->slab_used;
+    return result;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void core_pool_free(core_Pool * pool, void * ptr)
+#ifdef CORE_IMPLEMENTATION
+{
+    assert(ptr != NULL);
+    *(void **)ptr = pool->free_list;
+    pool->free_list = ptr;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*returns the arena's shared pool for objects of this size, creating it on first use, or NULL
+  when the arena cannot allocate it. pools are dropped when the arena is rewound so the
+  pointer must not be kept past a rewind*/
+core_Pool * core_arena_pool(core_Arena * a, size_t object_size)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_Pool * pool;
+    const size_t size = CORE_ARENA_ALIGN_UP(CORE_MAX(object_size, sizeof(void *)), CORE_POOL_ALIGNMENT);
+    for(pool = a->pools; pool != NULL; pool = pool->next) {
+        if(pool->object_size == size) return pool;
+    }
+    pool = core_arena_alloc(a, sizeof(core_Pool));
+    if(pool == NULL) return NULL;
+    core_pool_init(pool, a, size);
+    pool->next = a->pools;
+    a->pools = pool;
+    return pool;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+#define core_pool_new(pool, T) ((T *)core_pool_alloc(pool))
+
+/**** CONCURRENT ARENA ****/
+#ifdef CORE_ATOMICS_AVAILABLE
+
+#ifndef CORE_CONCURRENT_ARENA_CACHE_SLOTS
+#   define CORE_CONCURRENT_ARENA_CACHE_SLOTS 8
+#endif /*CORE_CONCURRENT_ARENA_CACHE_SLOTS*/
+
+/*arena that can be allocated from by many threads at once, each thread bumps
+  through a chunk of its own and only the list of chunks is shared*/
+typedef struct {
+    core_ArenaChunk * chunks;
+    size_t chunk_size;
+    unsigned long id;
+    long magic_number;
+} core_ConcurrentArena;
+
+typedef struct {
+    unsigned long arena_id;
+    core_ArenaChunk * chunk;
+} _core_ConcurrentArenaCache;
+
+#ifdef CORE_IMPLEMENTATION
+unsigned long _core_concurrent_arena_next_id = 0;
+CORE_THREAD_LOCAL _core_ConcurrentArenaCache _core_concurrent_arena_cache[CORE_CONCURRENT_ARENA_CACHE_SLOTS];
+#endif /*CORE_IMPLEMENTATION*/
+
+/*must be called before the arena is shared between threads*/
+void core_concurrent_arena_init(core_ConcurrentArena * a)
+#ifdef CORE_IMPLEMENTATION
+{
+    a->chunks = NULL;
+    a->chunk_size = CORE_ARENA_CHUNK_SIZE;
+    a->id = CORE_ATOMIC_FETCH_ADD(&_core_concurrent_arena_next_id, 1) + 1;
+    a->magic_number = (long)0xDEADBEEF;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void _core_concurrent_arena_push_chunk(core_ConcurrentArena * a, core_ArenaChunk * chunk)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaChunk * head = CORE_ATOMIC_LOAD(&a->chunks);
+    do {
+        chunk->next = head;
+    } while(!CORE_ATOMIC_CAS(&a->chunks, &head, chunk));
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void * _core_concurrent_arena_alloc_slow(core_ConcurrentArena * a, _core_ConcurrentArenaCache * cache, const size_t len)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaChunk * chunk;
+    core_Allocation * header;
+    size_t chunk_size = CORE_ATOMIC_LOAD(&a->chunk_size);
+
+    if(a->magic_number != (long)0xDEADBEEF) {
+        CORE_FATAL_ERROR("core_ConcurrentArena used before core_concurrent_arena_init");
+    }
+
+    if(len > chunk_size / 4) {
+        /*large allocations get a chunk of their own and leave the thread's chunk alone*/
+        chunk = core_arena_chunk_new(CORE_ARENA_HEADER_SIZE + len);
+        chunk->used = chunk->cap;
+        _core_concurrent_arena_push_chunk(a, chunk);
+    } else {
+        if(chunk_size < CORE_ARENA_CHUNK_SIZE_MAX) {
+            /*losing this race is harmless, another thread grew the size already*/
+            (void)CORE_ATOMIC_CAS(&a->chunk_size, &chunk_size, chunk_size * 2);
+        }
+        chunk = core_arena_chunk_new(chunk_size);
+        chunk->used = CORE_ARENA_HEADER_SIZE + len;
+        _core_concurrent_arena_push_chunk(a, chunk);
+        cache->arena_id = a->id;
+        cache->chunk = chunk;
+    }
+
+    header = (core_Allocation *)(void *)CORE_ARENA_CHUNK_DATA(chunk);
+    header->len = len;
+    header->active = CORE_TRUE;
+    header->large = CORE_FALSE;
+    header->offset = 0;
+    header->align_log2 = 0;
+    return (char *)header + CORE_ARENA_HEADER_SIZE;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+CORE_NODISCARD
+void * core_concurrent_arena_alloc(core_ConcurrentArena * a, const size_t bytes)
+#ifdef CORE_IMPLEMENTATION
+{
+    const size_t len = CORE_ARENA_ALIGN_UP(bytes == 0 ? 1 : bytes, CORE_ARENA_ALIGNMENT);
+    _core_ConcurrentArenaCache * cache = &_core_concurrent_arena_cache[a->id % CORE_CONCURRENT_ARENA_CACHE_SLOTS];
+    core_ArenaChunk * chunk = cache->chunk;
+
+    if(CORE_LIKELY_TRUE(cache->arena_id == a->id && chunk != NULL && chunk->cap - chunk->used >= CORE_ARENA_HEADER_SIZE + len)) {
+        core_Allocation * header = (core_Allocation *)(void *)(CORE_ARENA_CHUNK_DATA(chunk) + chunk->used);
+        chunk->used += CORE_ARENA_HEADER_SIZE + len;
+        header->len = len;
+        header->active = CORE_TRUE;
+        header->large = CORE_FALSE;
+        header->offset = 0;
+        header->align_log2 = 0;
+        return (char *)header + CORE_ARENA_HEADER_SIZE;
+    }
+    return _core_concurrent_arena_alloc_slow(a, cache, len);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*grows in place when ptr is the last allocation in the calling thread's chunk*/
+CORE_NODISCARD
+void * core_concurrent_arena_realloc(core_ConcurrentArena * a, void * ptr, const size_t bytes)
+#ifdef CORE_IMPLEMENTATION
+{
+    _core_ConcurrentArenaCache * cache = &_core_concurrent_arena_cache[a->id % CORE_CONCURRENT_ARENA_CACHE_SLOTS];
+    core_Allocation * header;
+    void * new;
+    size_t len;
+    assert(ptr != NULL);
+    header = CORE_ARENA_ALLOCATION(ptr);
+    if(bytes <= header->len) return ptr;
+    len = CORE_ARENA_ALIGN_UP(bytes, CORE_ARENA_ALIGNMENT);
+
+    if(cache->arena_id == a->id && cache->chunk != NULL
+       && (char *)ptr + header->len == CORE_ARENA_CHUNK_DATA(cache->chunk) + cache->chunk->used
+       && cache->chunk->cap - cache->chunk->used >= len - header->len) {
+        cache->chunk->used += len - header->len;
+        header->len = len;
+        return ptr;
+    }
+    new = core_concurrent_arena_alloc(a, len);
+    memcpy(new, ptr, header->len);
+    return new;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+char * core_concurrent_arena_strdup(core_ConcurrentArena * a, const char * str)
+#ifdef CORE_IMPLEMENTATION
+{
+    size_t len = strlen(str);
+    char * mem = core_concurrent_arena_alloc(a, len + 1);
+    memcpy(mem, str, len + 1);
+    return mem;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*releases every chunk at once, no thread may be allocating while this runs*/
+void core_concurrent_arena_free(core_ConcurrentArena * a)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ArenaChunk * chunk = NULL;
+    core_ArenaChunk * next = NULL;
+    for(chunk = CORE_ATOMIC_LOAD(&a->chunks); chunk != NULL; chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+    memset(a, 0, sizeof(*a));
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+#endif /*CORE_ATOMICS_AVAILABLE*/
+
+
+/**** VEC LENGTH ****/
+/*define CORE_VEC_SIZE_T for vecs and slices that can hold more than INT_MAX items*/
+#ifdef CORE_VEC_SIZE_T
+    typedef size_t core_VecLen;
+    typedef size_t core_SliceLen;
+#   define CORE_VEC_LEN_MAX ((size_t)-1)
+#else
+    typedef int core_VecLen;
+    typedef unsigned int core_SliceLen;
+#   define CORE_VEC_LEN_MAX ((size_t)INT_MAX)
+#endif /*CORE_VEC_SIZE_T*/
+
+/*len + n, dies instead of wrapping past what a vec can index*/
+size_t core_vec_len_add(const size_t len, const size_t n)
+#ifdef CORE_IMPLEMENTATION
+{
+    if(n > CORE_VEC_LEN_MAX - len) {
+        CORE_FATAL_ERROR("vec length overflow");
+    }
+    return len + n;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*capacity to grow to so that needed items fit, doubling from cap.
+  dies if needed items can not be indexed or their size in bytes does not fit a size_t*/
+size_t core_vec_next_capacity(const size_t cap, const size_t needed, const size_t item_size)
+#ifdef CORE_IMPLEMENTATION
+{
+    const size_t max = CORE_MIN(CORE_VEC_LEN_MAX, ((size_t)-1) / item_size);
+    size_t result;
+    if(needed > max) {
+        CORE_FATAL_ERROR("vec capacity overflow");
+    }
+    result = cap > (max - 1) / 2 ? max : cap * 2 + 1;
+    return CORE_MAX(result, needed);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+
+/**** SLICE ****/
+#define core_Slice(Type) struct {Type * ptr; core_SliceLen len;}
+
+
+/**** VEC ****/
+#define core_Vec(Type) struct {Type * items; core_VecLen len; core_VecLen cap; }
+
+/*capacity is taken from the arena block so slack left by the allocator is used too*/
+#define core_vec_grow(vec, arena, capacity) do { \
+    if((vec)->cap == 0) { \
+        (vec)->len = 0; \
+        (vec)->items = core_arena_check_alloc(core_arena_alloc(arena, sizeof(*(vec)->items) * (size_t)(capacity))); \
+    } else { \
+        (vec)->items = core_arena_check_alloc(core_arena_realloc(arena, (vec)->items, sizeof(*(vec)->items) * (size_t)(capacity))); \
+    } \
+    (vec)->cap = (core_VecLen)CORE_MIN(core_arena_capacity((vec)->items) / sizeof(*(vec)->items), CORE_VEC_LEN_MAX); \
+} while (0)
+
+/*later growth through core_arena_realloc keeps the alignment*/
+#define core_vec_init_aligned(vec, arena, capacity, align) do { \
+    (vec)->len = 0; \
+    (vec)->items = core_arena_check_alloc(core_arena_alloc_aligned(arena, sizeof(*(vec)->items) * (size_t)(capacity), align)); \
+    (vec)->cap = (core_VecLen)CORE_MIN(core_arena_capacity((vec)->items) / sizeof(*(vec)->items), CORE_VEC_LEN_MAX); \
+} while (0)
+
+#define core_vec_append(vec, arena, item) do { \
+    if((vec)->cap == 0) { \
+        core_vec_grow(vec, arena, 8); \
+    } else if((vec)->len >= (vec)->cap) { \
+        core_vec_grow(vec, arena, core_vec_next_capacity((size_t)(vec)->cap, (size_t)(vec)->len + 1, sizeof(*(vec)->items))); \
+    } \
+    (vec)->items[(vec)->len++] = item; \
+} while (0)
+
+/*grows geometrically so reserving one more item at a time stays amortized O(1)*/
+#define core_vec_reserve(vec, arena, capacity) do { \
+    if((size_t)(vec)->cap < (size_t)(capacity)) { \
+        core_vec_grow(vec, arena, core_vec_next_capacity((size_t)(vec)->cap, (size_t)(capacity), sizeof(*(vec)->items))); \
+    } \
+} while (0)
+
+/*new items are zeroed*/
+#define core_vec_resize(vec, arena, length) do { \
+    const core_VecLen _len_ = (core_VecLen)(length); \
+    core_vec_reserve(vec, arena, _len_); \
+    if(_len_ > (vec)->len) { \
+        memset((vec)->items + (vec)->len, 0, sizeof(*(vec)->items) * (size_t)(_len_ - (vec)->len)); \
+    } \
+    (vec)->len = _len_; \
+} while (0)
+
+/*ptr must not point into vec since growing may move the items*/
+#define core_vec_extend(vec, arena, ptr, n) do { \
+    const core_VecLen _n_ = (core_VecLen)(n); \
+    core_vec_reserve(vec, arena, core_vec_len_add((size_t)(vec)->len, (size_t)_n_)); \
+    if(_n_ > 0) memcpy((vec)->items + (vec)->len, ptr, sizeof(*(vec)->items) * (size_t)_n_); \
+    (vec)->len += _n_; \
+} while (0)
+
+#define core_vec_insert_n(vec, arena, index, ptr, n) do { \
+    const core_VecLen _index_ = (core_VecLen)(index); \
+    const core_VecLen _n_ = (core_VecLen)(n); \
+    assert((size_t)_index_ <= (size_t)(vec)->len); \
+    core_vec_reserve(vec, arena, core_vec_len_add((size_t)(vec)->len, (size_t)_n_)); \
+    if(_n_ > 0) { \
+        memmove((vec)->items + _index_ + _n_, (vec)->items + _index_, sizeof(*(vec)->items) * (size_t)((vec)->len - _index_)); \
+        memcpy((vec)->items + _index_, ptr, sizeof(*(vec)->items) * (size_t)_n_); \
+    } \
+    (vec)->len += _n_; \
+} while (0)
+
+#define core_vec_remove_range(vec, start, count) do { \
+    const core_VecLen _start_ = (core_VecLen)(start); \
+    const core_VecLen _count_ = (core_VecLen)(count); \
+    assert((size_t)_start_ <= (size_t)(vec)->len && (size_t)_count_ <= (size_t)((vec)->len - _start_)); \
+    if(_count_ > 0) { \
+        memmove((vec)->items + _start_, (vec)->items + _start_ + _count_, sizeof(*(vec)->items) * (size_t)((vec)->len - _start_ - _count_)); \
+    } \
+    (vec)->len -= _count_; \
+} while (0)
+
+/*O(1) removal that moves the last item into the hole, so order is not kept*/
+#define core_vec_swap_remove(vec, index) do { \
+    const core_VecLen _index_ = (core_VecLen)(index); \
+    assert((size_t)_index_ < (size_t)(vec)->len); \
+    (vec)->items[_index_] = (vec)->items[--(vec)->len]; \
+} while (0)
+
+#define core_vec_copy_items(dst, src, arena) core_vec_extend(dst, arena, (src)->items, (src)->len)
+
+#define core_vec_append_unique(vec, arena, item, equality_function) do {                 \
+    core_VecLen _i_;                                                                     \
+    for(_i_ = 0; _i_ < (vec)->len; ++_i_) {                                              \
+        if(equality_function(item, (vec)->items[_i_])) goto core_vec_append_unique_skip; \
+    }                                                                                    \
+    core_vec_append(vec, arena, item);                                                   \
+        core_vec_append_unique_skip: ;                                 \
+} while(0)
+
+typedef core_Vec(const char *) core_StrVec;
+typedef core_Vec(int) core_IntVec;
+
+/**** SMALL VEC ****/
+/*keeps the first N items inline and only goes to the arena once they are outgrown.
+  items is NULL while the inline storage is in use, so zero initialisation works
+  and the struct can be copied while small. always index through core_smallvec_items*/
+#define core_SmallVec(Type, N) struct {Type * items; core_VecLen len; core_VecLen cap; Type inline_items[N]; }
+
+#define core_smallvec_is_inline(vec) ((vec)->items == NULL)
+#define core_smallvec_items(vec) (core_smallvec_is_inline(vec) ? (vec)->inline_items : (vec)->items)
+#define core_smallvec_capacity(vec) \
+    (core_smallvec_is_inline(vec) ? (core_VecLen)(sizeof((vec)->inline_items) / sizeof((vec)->inline_items[0])) : (vec)->cap)
+
+#define core_smallvec_reserve(vec, arena, capacity) do { \
+    if((size_t)core_smallvec_capacity(vec) < (size_t)(capacity)) { \
+        const size_t _cap_ = core_vec_next_capacity((size_t)core_smallvec_capacity(vec), (size_t)(capacity), sizeof(*(vec)->items)); \
+        if(core_smallvec_is_inline(vec)) { \
+            (vec)->items = core_arena_check_alloc(core_arena_alloc(arena, sizeof(*(vec)->items) * _cap_)); \
+            memcpy((vec)->items, (vec)->inline_items, sizeof(*(vec)->items) * (size_t)(vec)->len); \
+        } else { \
+            (vec)->items = core_arena_check_alloc(core_arena_realloc(arena, (vec)->items, sizeof(*(vec)->items) * _cap_)); \
+        } \
+        (vec)->cap = (core_VecLen)CORE_MIN(core_arena_capacity((vec)->items) / sizeof(*(vec)->items), CORE_VEC_LEN_MAX); \
+    } \
+} while (0)
+
+#define core_smallvec_append(vec, arena, item) do { \
+    if((vec)->len >= core_smallvec_capacity(vec)) { \
+        core_smallvec_reserve(vec, arena, (vec)->len + 1); \
+    } \
+    core_smallvec_items(vec)[(vec)->len++] = item; \
+} while (0)
+
+#define core_smallvec_pop(vec) (assert((vec)->len > 0), core_smallvec_items(vec)[--(vec)->len])
+
+
+/**** THREAD POOL ****/
+#if defined(CORE_UNIX)
+#include <pthread.h>
+#include <sched.h>
+#define CORE_THREADS_AVAILABLE
+
+typedef void (*core_ThreadPoolTask)(void * ctx, unsigned long index);
+
+/*fixed set of worker threads for fork join loops.
+  the thread calling core_thread_pool_run works too, so a pool of n threads has n - 1 workers*/
+typedef struct {
+    pthread_t * workers;
+    unsigned long worker_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    core_ThreadPoolTask task;
+    void * ctx;
+    unsigned long next;
+    unsigned long count;
+    unsigned long finished;
+    core_Bool shutdown;
+} core_ThreadPool;
+
+/*hands out task indices until there are none left, called and returns with the mutex held*/
+void _core_thread_pool_drain(core_ThreadPool * pool)
+#ifdef CORE_IMPLEMENTATION
+{
+    while(pool->task != NULL && pool->next < pool->count) {
+        const core_ThreadPoolTask task = pool->task;
+        void * ctx = pool->ctx;
+        const unsigned long index = pool->next++;
+        pthread_mutex_unlock(&pool->mutex);
+        task(ctx, index);
+        pthread_mutex_lock(&pool->mutex);
+        if(++pool->finished == pool->count) {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void * _core_thread_pool_worker(void * arg)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ThreadPool * pool = arg;
+    pthread_mutex_lock(&pool->mutex);
+    for(;;) {
+        while(!pool->shutdown && (pool->task == NULL || pool->next >= pool->count)) {
+            pthread_cond_wait(&pool->work_ready, &pool->mutex);
+        }
+        if(pool->shutdown) break;
+        _core_thread_pool_drain(pool);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    /*tasks may have used the worker's scratch arenas*/
+    core_arena_scratch_free();
+    return NULL;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*thread_count of 0 uses one thread per online cpu*/
+void core_thread_pool_init(core_ThreadPool * pool, unsigned long thread_count)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long i;
+    memset(pool, 0, sizeof(*pool));
+    if(thread_count == 0) {
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cpus > 0 ? (unsigned long)cpus : 1;
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+    if(thread_count > 1) {
+        pool->workers = malloc(sizeof(pool->workers[0]) * (thread_count - 1));
+        if(pool->workers == NULL) {
+            CORE_FATAL_ERROR("core_thread_pool_init out of memory");
+        }
+    }
+    for(i = 0; i + 1 < thread_count; ++i) {
+        if(pthread_create(&pool->workers[i], NULL, _core_thread_pool_worker, pool) != 0) {
+            CORE_FATAL_ERROR("pthread_create failed");
+        }
+        pool->worker_count++;
+    }
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*a NULL pool counts as the calling thread alone*/
+unsigned long core_thread_pool_thread_count(const core_ThreadPool * pool)
+#ifdef CORE_IMPLEMENTATION
+{
+    return pool == NULL ? 1 : pool->worker_count + 1;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*calls task(ctx, i) for every i in [0, count) spread over the pool and returns once all are done.
+  tasks must not call core_thread_pool_run on the same pool*/
+void core_thread_pool_run(core_ThreadPool * pool, core_ThreadPoolTask task, void * ctx, unsigned long count)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long i;
+    if(pool == NULL || pool->worker_count == 0 || count <= 1) {
+        for(i = 0; i < count; ++i) task(ctx, i);
+        return;
+    }
+    pthread_mutex_lock(&pool->mutex);
+    assert(pool->task == NULL && "core_thread_pool_run is not reentrant");
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->next = 0;
+    pool->count = count;
+    pool->finished = 0;
+    pthread_cond_broadcast(&pool->work_ready);
+    _core_thread_pool_drain(pool);
+    while(pool->finished < pool->count) {
+        pthread_cond_wait(&pool->work_done, &pool->mutex);
+    }
+    pool->task = NULL;
+    pool->ctx = NULL;
+    pthread_mutex_unlock(&pool->mutex);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void core_thread_pool_free(core_ThreadPool * pool)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long i;
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = CORE_TRUE;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->mutex);
+    for(i = 0; i < pool->worker_count; ++i) {
+        pthread_join(pool->workers[i], NULL);
+    }
+    free(pool->workers);
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->mutex);
+    memset(pool, 0, sizeof(*pool));
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+
+/**** PARALLEL ****/
+/*a NULL pool runs everything on the calling thread, which is the sequential version.
+  both give exactly the same result whatever the thread count*/
+
+#ifndef CORE_PARALLEL_GRAIN
+#   define CORE_PARALLEL_GRAIN 4096
+#endif /*CORE_PARALLEL_GRAIN*/
+
+typedef int (*core_CompareFunction)(const void * lhs, const void * rhs);
+typedef void (*core_AddFunction)(void * acc, const void * item);
+
+/*constant sized copies for the common item sizes so they compile to plain moves*/
+#define _CORE_COPY_ITEM(dst, src, size) \
+    ((size) == 8 ? memcpy(dst, src, 8) : (size) == 4 ? memcpy(dst, src, 4) : memcpy(dst, src, size))
+
+/*stable merge of two sorted runs, items of lhs come first when equal*/
+void _core_merge(char * dst, const char * lhs, size_t lhs_len, const char * rhs, size_t rhs_len, size_t size, core_CompareFunction compare)
+#ifdef CORE_IMPLEMENTATION
+{
+    size_t i = 0;
+    size_t j = 0;
+    while(i < lhs_len && j < rhs_len) {
+        if(compare(rhs + j * size, lhs + i * size) < 0) {
+            _CORE_COPY_ITEM(dst, rhs + j * size, size);
+            ++j;
+        } else {
+            _CORE_COPY_ITEM(dst, lhs + i * size, size);
+            ++i;
+        }
+        dst += size;
+    }
+    memcpy(dst, lhs + i * size, (lhs_len - i) * size);
+    memcpy(dst + (lhs_len - i) * size, rhs + j * size, (rhs_len - j) * size);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*how many of the first k items of the stable merge of lhs and rhs come from lhs*/
+size_t _core_merge_split(const char * lhs, size_t lhs_len, const char * rhs, size_t rhs_len, size_t k, size_t size, core_CompareFunction compare)
+#ifdef CORE_IMPLEMENTATION
+{
+    size_t lo = k > rhs_len ? k - rhs_len : 0;
+    size_t hi = CORE_MIN(k, lhs_len);
+    while(lo < hi) {
+        const size_t i = lo + (hi - lo) / 2;
+        if(compare(lhs + i * size, rhs + (k - i - 1) * size) <= 0) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*bottom up merge sort of base using scratch, which holds as many items*/
+void _core_merge_sort(char * base, char * scratch, size_t count, size_t size, core_CompareFunction compare)
+#ifdef CORE_IMPLEMENTATION
+{
+    const size_t run = 16;
+    char * src = base;
+    char * dst = scratch;
+    char * tmp;
+    size_t width, lo, i, j;
+
+    /*insertion sort short runs, parking the item being placed at the end of scratch*/
+    tmp = scratch + (count - 1) * size;
+    for(lo = 0; lo < count; lo += run) {
+        const size_t hi = CORE_MIN(lo + run, count);
+        for(i = lo + 1; i < hi; ++i) {
+            for(j = i; j > lo && compare(base + i * size, base + (j - 1) * size) < 0; --j);
+            if(j == i) continue;
+            memcpy(tmp, base + i * size, size);
+            memmove(base + (j + 1) * size, base + j * size, (i - j) * size);
+            memcpy(base + j * size, tmp, size);
+        }
+    }
+
+    for(width = run; width < count; width *= 2) {
+        for(lo = 0; lo < count; lo += 2 * width) {
+            const size_t mid = CORE_MIN(lo + width, count);
+            const size_t hi = CORE_MIN(lo + 2 * width, count);
+            _core_merge(dst + lo * size, src + lo * size, mid - lo, src + mid * size, hi - mid, size, compare);
+        }
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if(src != base) memcpy(base, src, count * size);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+typedef struct {
+    char * base;
+    char * scratch;
+    char * src;
+    char * dst;
+    size_t count;
+    size_t size;
+    core_CompareFunction compare;
+    size_t width;
+    unsigned long pieces;
+} _core_ParallelSort;
+
+/*first items of piece out of pieces when len items are split evenly*/
+size_t _core_parallel_split(size_t len, unsigned long pieces, unsigned long piece)
+#ifdef CORE_IMPLEMENTATION
+{
+    return len / pieces * piece + CORE_MIN(piece, len % pieces);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void _core_parallel_sort_runs(void * ctx, unsigned long index)
+#ifdef CORE_IMPLEMENTATION
+{
+    _core_ParallelSort * sort = ctx;
+    const size_t lo = (size_t)index * sort->width;
+    const size_t hi = CORE_MIN(lo + sort->width, sort->count);
+    _core_merge_sort(sort->base + lo * sort->size, sort->scratch + lo * sort->size, hi - lo, sort->size, sort->compare);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*each pair of runs is merged by several tasks, each writing its own stretch of the output*/
+void _core_parallel_sort_merge(void * ctx, unsigned long index)
+#ifdef CORE_IMPLEMENTATION
+{
+    _core_ParallelSort * sort = ctx;
+    const size_t size = sort->size;
+    const size_t lo = (size_t)(index / sort->pieces) * 2 * sort->width;
+    const size_t mid = CORE_MIN(lo + sort->width, sort->count);
+    const size_t hi = CORE_MIN(mid + sort->width, sort->count);
+    const char * lhs = sort->src + lo * size;
+    const char * rhs = sort->src + mid * size;
+    const unsigned long piece = index % sort->pieces;
+    const size_t k0 = _core_parallel_split(hi - lo, sort->pieces, piece);
+    const size_t k1 = _core_parallel_split(hi - lo, sort->pieces, piece + 1);
+    const size_t i0 = _core_merge_split(lhs, mid - lo, rhs, hi - mid, k0, size, sort->compare);
+    const size_t i1 = _core_merge_split(lhs, mid - lo, rhs, hi - mid, k1, size, sort->compare);
+    _core_merge(sort->dst + (lo + k0) * size, lhs + i0 * size, i1 - i0, rhs + (k0 - i0) * size, (k1 - i1) - (k0 - i0), size, sort->compare);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void _core_parallel_sort_copy_back(void * ctx, unsigned long index)
+#ifdef CORE_IMPLEMENTATION
+{
+    _core_ParallelSort * sort = ctx;
+    const size_t lo = _core_parallel_split(sort->count, sort->pieces, index);
+    const size_t hi = _core_parallel_split(sort->count, sort->pieces, index + 1);
+    memcpy(sort->base + lo * sort->size, sort->src + lo * sort->size, (hi - lo) * sort->size);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*stable merge sort, a drop in for qsort. runs are sorted one per thread and then merged pairwise,
+  every merge split across all threads so the last ones do not leave the pool idle*/
+void core_parallel_sort(void * base, size_t count, size_t size, core_CompareFunction compare, core_ThreadPool * pool)
+#ifdef CORE_IMPLEMENTATION
+{
+    const unsigned long threads = core_thread_pool_thread_count(pool);
+    _core_ParallelSort sort;
+    char * tmp;
+    unsigned long runs;
+
+    if(count < 2) return;
+    if(count > ((size_t)-1) / size) {
+        CORE_FATAL_ERROR("core_parallel_sort size overflow");
+    }
+    memset(&sort, 0, sizeof(sort));
+    sort.base = base;
+    sort.scratch = malloc(count * size);
+    if(sort.scratch == NULL) {
+        CORE_FATAL_ERROR("core_parallel_sort out of memory");
+    }
+    sort.count = count;
+    sort.size = size;
+    sort.compare = compare;
+
+    runs = count / CORE_PARALLEL_GRAIN < threads ? (unsigned long)(count / CORE_PARALLEL_GRAIN) : threads;
+    if(runs == 0) runs = 1;
+    sort.width = (count + runs - 1) / runs;
+    runs = (unsigned long)((count + sort.width - 1) / sort.width);
+    core_thread_pool_run(pool, _core_parallel_sort_runs, &sort, runs);
+
+    sort.src = sort.base;
+    sort.dst = sort.scratch;
+    while(sort.width < count) {
+        const unsigned long pairs = (unsigned long)((count - 1) / (2 * sort.width) + 1);
+        sort.pieces = (threads + pairs - 1) / pairs;
+        core_thread_pool_run(pool, _core_parallel_sort_merge, &sort, pairs * sort.pieces);
+        tmp = sort.src;
+        sort.src = sort.dst;
+        sort.dst = tmp;
+        sort.width = sort.width > (count + 1) / 2 ? count : sort.width * 2;
+    }
+    if(sort.src != sort.base) {
+        sort.pieces = threads;
+        core_thread_pool_run(pool, _core_parallel_sort_copy_back, &sort, threads);
+    }
+    free(sort.scratch);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+typedef struct {
+    const char * in;
+    char * out;
+    size_t count;
+    size_t size;
+    core_AddFunction add;
+    core_Bool inclusive;
+    unsigned long blocks;
+    char * sums;
+} _core_ParallelPrefixSum;
+
+void _core_parallel_prefix_sum_block_total(void * ctx, unsigned long index)
+#ifdef CORE_IMPLEMENTATION
+{
+    _core_ParallelPrefixSum * scan = ctx;
+    const size_t lo = (size_t)index * CORE_PARALLEL_GRAIN;
+    const size_t hi = CORE_MIN(lo + CORE_PARALLEL_GRAIN, scan->count);
+    char * acc = scan->sums + (size_t)index * scan->size;
+    size_t i;
+    memset(acc, 0, scan->size);
+    for(i = lo; i < hi; ++i) scan->add(acc, scan->in + i * scan->size);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*starts from the sum of everything before the block. in may equal out, so each item is
+  read before the slot is written*/
+void _core_parallel_prefix_sum_block_scan(void * ctx, unsigned long index)
+#ifdef CORE_IMPLEMENTATION
+{
+    _core_ParallelPrefixSum * scan = ctx;
+    const size_t size = scan->size;
+    const size_t lo = (size_t)index * CORE_PARALLEL_GRAIN;
+    const size_t hi = CORE_MIN(lo + CORE_PARALLEL_GRAIN, scan->count);
+    char * acc = scan->sums + (size_t)index * size;
+    char * item = scan->sums + (scan->blocks + index) * size;
+    size_t i;
+    for(i = lo; i < hi; ++i) {
+        if(scan->inclusive) {
+            scan->add(acc, scan->in + i * size);
+            memcpy(scan->out + i * size, acc, size);
+        } else {
+            memcpy(item, scan->in + i * size, size);
+            memcpy(scan->out + i * size, acc, size);
+            scan->add(acc, item);
+        }
+    }
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*out[i] is the sum of in[0..i] when inclusive and of in[0..i) otherwise, starting from all zero bytes.
+  add(acc, item) does *acc += *item. blocks are always CORE_PARALLEL_GRAIN items, so every pool
+  adds in the same order and even floating point results are identical to a NULL pool*/
+void core_parallel_prefix_sum(const void * in, void * out, size_t count, size_t size, core_AddFunction add, core_Bool inclusive, core_ThreadPool * pool)
+#ifdef CORE_IMPLEMENTATION
+{
+    _core_ParallelPrefixSum scan;
+    char * running;
+    unsigned long i;
+
+    if(count == 0) return;
+    memset(&scan, 0, sizeof(scan));
+    scan.in = in;
+    scan.out = out;
+    scan.count = count;
+    scan.size = size;
+    scan.add = add;
+    scan.inclusive = inclusive;
+    scan.blocks = (unsigned long)((count - 1) / CORE_PARALLEL_GRAIN + 1);
+    scan.sums = calloc(2 * (size_t)scan.blocks + 1, size);
+    if(scan.sums == NULL) {
+        CORE_FATAL_ERROR("core_parallel_prefix_sum out of memory");
+    }
+
+    /*the last block's total is never needed*/
+    core_thread_pool_run(pool, _core_parallel_prefix_sum_block_total, &scan, scan.blocks - 1);
+    running = scan.sums + 2 * (size_t)scan.blocks * size;
+    for(i = 0; i < scan.blocks; ++i) {
+        char * sum = scan.sums + (size_t)i * size;
+        char * tmp = scan.sums + (scan.blocks + i) * size;
+        memcpy(tmp, sum, size);
+        memcpy(sum, running, size);
+        if(i + 1 < scan.blocks) add(running, tmp);
+    }
+    core_thread_pool_run(pool, _core_parallel_prefix_sum_block_scan, &scan, scan.blocks);
+    free(scan.sums);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void core_add_int(void * acc, const void * item)
+#ifdef CORE_IMPLEMENTATION
+{
+    *(int *)acc += *(const int *)item;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void core_add_long(void * acc, const void * item)
+#ifdef CORE_IMPLEMENTATION
+{
+    *(long *)acc += *(const long *)item;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+#define core_vec_parallel_sort(vec, pool, compare) \
+    core_parallel_sort((vec)->items, (size_t)(vec)->len, sizeof(*(vec)->items), compare, pool)
+
+/*in place*/
+#define core_vec_parallel_prefix_sum(vec, pool, add, inclusive) \
+    core_parallel_prefix_sum((vec)->items, (vec)->items, (size_t)(vec)->len, sizeof(*(vec)->items), add, inclusive, pool)
+
+#endif /*CORE_UNIX*/
+
+
+/**** CTYPE ****/
+core_Bool core_isidentifier(char ch)
+#ifdef CORE_IMPLEMENTATION
+{
+    return isalpha(ch) || isdigit(ch) || ch == '_';
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/**** SYMBOL ****/
+#ifndef CORE_SYMBOL_MAX_LEN
+#   define CORE_SYMBOL_MAX_LEN 128
+#endif /*CORE_SYMBOL_MAX_LEN*/
+#ifndef CORE_MAX_SYMBOLS
+#   define CORE_MAX_SYMBOLS 2048
+#endif /*CORE_MAX_SYMBOLS*/
+
+typedef int core_Symbol;
+typedef struct {
+    char symbols[CORE_MAX_SYMBOLS][CORE_SYMBOL_MAX_LEN];
+    int count;
+} core_Symbols;
+
+core_Symbol core_symbol_intern(core_Symbols * state, const char * str)
+#ifdef CORE_IMPLEMENTATION
+{
+    int i = 0;
+    int result = -1;
+    for(i = 0; i < state->count; ++i) {
+        if(strcmp(state->symbols[i], str) == 0) return i;
+    }
+    strncpy(state->symbols[state->count], str, CORE_SYMBOL_MAX_LEN - 1);
+    result = state->count;
+    ++state->count;
+    return result;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+const char * core_symbol_get(core_Symbols * state, core_Symbol sym)
+#ifdef CORE_IMPLEMENTATION
+{
+    assert(sym < state->count);
+    return state->symbols[sym];
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/**** PEEK ****/
+char core_peek(FILE * fp)
+#ifdef CORE_IMPLEMENTATION
+{
+    char ch = (char)fgetc(fp);
+    ungetc(ch, fp);
+    return ch;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+int core_skip_whitespace(FILE * fp)
+#ifdef CORE_IMPLEMENTATION
+{
+    int num_newlines = 0;
+    while(isspace(core_peek(fp)))
+        if(fgetc(fp) == '\n') ++num_newlines;
+    return num_newlines;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+core_Bool core_skip_comments(FILE * fp, const char * begin, const char * end)
+#ifdef CORE_IMPLEMENTATION
+{
+    int i;
+    long pos;
+
+    CORE_TODO("Test this function to make sure it works");
+    
+    if(!fp || !begin || !end) return 0;
+    if(strlen(begin) == 0 || strlen(end) == 0) return 0;
+    pos = ftell(fp);
+    for(i = 0; begin[i] != 0 && fgetc(fp) == begin[i]; ++i) {
+        
+    }
+    if(begin[i] == 0) {
+        /*comment found*/
+        for(;;) {
+            for(;!feof(fp) && core_peek(fp) != end[0]; fgetc(fp));
+            if(feof(fp)) {
+                fprintf(stderr, "Unterminated comment");
+                return CORE_FALSE;
+            } else {
+                for(i = 0; end[i] != 0 && fgetc(fp) == end[i];++i);
+                if(end[i] == 0) {
+                    /*comment terminated*/
+                    return CORE_TRUE;
+                }
+            }
+        }
+    } else {
+        fseek(fp, SEEK_SET, (int)pos);
+        return CORE_FALSE;
+    }
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+char * core_file_read_string(core_Arena * arena, FILE * fp)
+#ifdef CORE_IMPLEMENTATION
+{
+    char ch;
+    core_Bool escape = CORE_FALSE;
+    core_SmallVec(char, 64) str = {0};
+    assert(!feof(fp));
+    assert(core_peek(fp) == '"');
+    fgetc(fp);
+
+    while(1) {
+        if(feof(fp)) return NULL;
+        ch = (char)fgetc(fp);
+        if(escape) {
+            escape = CORE_FALSE;
+            switch(ch) {
+            case 'n': core_smallvec_append(&str, arena, '\n'); break;
+            case '"': core_smallvec_append(&str, arena, '\"'); break;
+            case '\\': core_smallvec_append(&str, arena , '\\'); break;
+            default: return NULL;
+            }
+        } else if(ch == '\\') {
+            escape = CORE_TRUE;
+        } else if (ch == '"') {
+            core_smallvec_append(&str, arena, 0);
+            /*short strings never left the stack, copy them out at their exact size*/
+            return core_smallvec_is_inline(&str) ? core_arena_strdup(arena, str.inline_items) : str.items;
+        } else {
+            core_smallvec_append(&str, arena, ch);
+        }
+    }
+}
+#else
+;
+#endif
+
+
+/**** FILE ****/
+
+/* core_Bool core_file_read_all(FILE * fp, char * dst, const unsigned long dst_cap) */
+/* #ifdef CORE_IMPLEMENTATION */
+/* { */
+/*     unsigned long count = fread(dst, 1, dst_cap - 1, fp); */
+/*     dst[dst_cap - 1] = 0; */
+/*     if(count >= dst_cap - 1) return CORE_FALSE; */
+/*     return CORE_TRUE; */
+/* } */
+/* #else */
+/* ; */
+/* #endif /\*CORE_IMPLEMENTATION*\/ */
+
+char * core_file_read_all_arena(core_Arena * arena, const char * filepath)
+#ifdef CORE_IMPLEMENTATION
+{
+    FILE * fp = fopen(filepath, "rb");
+    char * buf;
+    size_t filelen;
+    if(!fp) return NULL;
+    fseek(fp, 0, SEEK_END);
+    filelen = (size_t)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    buf = core_arena_alloc(arena, filelen + 1);
+    if(buf == NULL) {
+        fclose(fp);
+        return NULL;
+    }
+    fread(buf, 1, filelen, fp);
+    buf[filelen] = 0;
+    fclose(fp);
+    return buf;
+}
+#else
+;
+#endif /* CORE_IMPLEMENTATION */
+
+
+/*TODO
+  
+  CORE_ERR
+  CORE_OK
+
+  CORE_LOG_ERROR
+*/
+
+
+/**** DEFER ****/
+#define CORE_DEFER(label) \
+    while(0) \
+        while(1) \
+            if (1) { \
+                goto label##_done_; \
+            } else label:
+
+#define CORE_DEFERRED(label) do { goto label; label##_done_:; } while (0)
+
+
+/**** CONCAT ****/
+#define CORE_CONCAT9(x, y) x##y
+#define CORE_CONCAT8(x, y) CORE_CONCAT9(x, y)
+#define CORE_CONCAT7(x, y) CORE_CONCAT8(x, y)
+#define CORE_CONCAT6(x, y) CORE_CONCAT7(x, y)
+#define CORE_CONCAT5(x, y) CORE_CONCAT6(x, y)
+#define CORE_CONCAT4(x, y) CORE_CONCAT5(x, y)
+#define CORE_CONCAT3(x, y) CORE_CONCAT4(x, y)
+#define CORE_CONCAT2(x, y) CORE_CONCAT3(x, y)
+#define CORE_CONCAT1(x, y) CORE_CONCAT2(x, y)
+#define CORE_CONCAT(x, y)  CORE_CONCAT1(x, y)
+
+
+/**** STATIC ASSERT ****/
+#if defined(CORE_C23)
+#   define CORE_STATIC_ASSERT(condition, message) static_assert(condition, message)
+#elif defined(CORE_C11)
+#   define CORE_STATIC_ASSERT(condition, message) _Static_assert(condition, message)
+#else
+#   define CORE_STATIC_ASSERT(condition, message) const int static_assertion_##__COUNTER__[ condition ? 1 : -1 ];
+#endif /*__STDC_VERSION__*/
+
+/**** LIST ****/
+#define core_List(T) struct core_List##T { T v; struct core_List##T * next; }
+#define core_list_push(list, arena, item) do {              \
+        void * tmp = (list);                                \
+        (list) = core_arena_alloc((arena)sizeof(*(list)));  \
+        (list)->v = item;                                   \
+        (list)->next = tmp;                                 \
+    } while (0)
+
+
+/**** STRING ****/
+int core_strlcpy(char * dst, const char * src, int dst_size)
+#ifdef CORE_IMPLEMENTATION
+{
+    /*Returns the number of bytes written*/
+    int i;
+    if(dst_size == 0) return 0;
+    if(!dst) return 0;
+    if(!src && dst_size > 0) {
+        dst[0] = 0;
+    }
+    for(i = 0; i < (dst_size - 1) && src[i] != 0; ++i) {
+        dst[i] = src[i];
+    }
+    dst[i] = 0;
+    return i;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void core_strnfmt(char * dst, unsigned long dst_len, unsigned long * dst_fill_pointer, const char * src, const unsigned long src_len)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long i = 0;
+    assert(dst_fill_pointer);
+    assert(dst);
+    assert(src);
+    assert(strlen(src) == src_len && "inaccurate length");
+    
+    if(*dst_fill_pointer + src_len + 1 >= dst_len) CORE_FATAL_ERROR("Buffer overflow");
+    for(i = 0; i < src_len; ++i) {
+        dst[*dst_fill_pointer] = src[i];
+        ++*dst_fill_pointer;
+        assert(*dst_fill_pointer < dst_len);
+    }
+    dst[*dst_fill_pointer] = 0;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void core_strfmt(char * dst, unsigned long dst_len, unsigned long * dst_fill_pointer, const char * src)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_strnfmt(dst, dst_len, dst_fill_pointer, src, strlen(src));
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+core_Bool core_streql(const char * lhs, const char * rhs)
+#ifdef CORE_IMPLEMENTATION
+{
+    return strcmp(lhs, rhs) == 0;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+core_Bool core_streql_any(const char * str, const char ** options, size_t n)
+#ifdef CORE_IMPLEMENTATION
+{
+    size_t i;
+    for(i = 0; i < n; ++i) {
+        if(core_streql(str, options[i])) return CORE_TRUE;
+    }
+    return CORE_FALSE;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+
+char * core_strdup_via_arena(core_Arena * arena, const char * str, size_t len)
+#ifdef CORE_IMPLEMENTATION
+{
+    char * new = NULL;
+    unsigned long i = 0;
+    assert(strlen(str) == len && "inaccurate length");
+    new = core_arena_check_alloc(core_arena_alloc(arena, len + 1));
+    for(i = 0; i <= len; ++i) {
+        new[i] = str[i];
+    }
+    assert(new[len] == 0);
+    return new;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+
+/**** SNPRINTF ****/
+#define core_itoa core_stringify_long
+int core_stringify_long(char * dst, size_t dst_size, long num)
+#ifdef CORE_IMPLEMENTATION
+{
+    int i = 0;
+    int j,k;
+    core_Bool neg = num < 0;
+    if(dst_size < 2) return 0;
+    if(num == 0) {
+        dst[0] = '0';
+        dst[1] = 0;
+        return 1;
+    }
+    
+    if(neg) num = num * -1;
+    for(i = 0; i + 2 < (int)dst_size && num > 0; ++i, num /= 10) {
+        dst[i] = (char)(num % 10) + '0';
+    }
+
+    if(neg && i + 2 < (int)dst_size) {
+        dst[i++] = '-';
+    }
+    for(j = 0, k = i - 1; j < k; ++j, --k) {
+        char tmp = dst[j];
+        dst[j] = dst[k];
+        dst[k] = tmp;
+    }
+    dst[i] = 0;
+    return i;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+core_Bool core_double_has_fractional_part(double num)
+#ifdef CORE_IMPLEMENTATION
+{
+    return num - (long)num > 0 || num - (long) num < 0;
+}
+#else
+;
+#endif
+
+
+int core_stringify_double(char * dst, size_t dst_size, int precision, double num)
+#ifdef CORE_IMPLEMENTATION
+{
+    long int_part = (long)num;
+    double fractional_part = num - (double)int_part;
+    int i = 0;
+    int digits = 0;
+    while(core_double_has_fractional_part(fractional_part) && digits < precision) {
+        fractional_part *= 10;
+        ++digits;
+    }
+    i = core_stringify_long(dst, dst_size, int_part);
+    if(i + 2 < (int)dst_size) {
+        dst[i] = '.';
+        ++i;
+    }
+    i = core_stringify_long(&dst[i], dst_size - (size_t)i, (long)fractional_part);
+    return i;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+typedef struct {
+    /*flags*/
+    core_Bool flag_left_justify;
+    core_Bool flag_show_plus_on_positive_integers;
+    core_Bool flag_pad_if_no_sign;
+    core_Bool flag_hash;
+    core_Bool flag_pad_with_zeros;
+
+    /*width*/
+    core_Bool read_width_from_args;
+    int width;
+
+    /*precision*/
+    core_Bool read_precision_from_args;
+    int precision;
+
+    /*type length char*/
+    char length[3];
+
+    /*specifier char*/
+    char specifier;
+} core_SNPrintfParameters;
+
+/*Note: This implementation currently does not actually do anything with many of the parameters*/
+void core_snprintf_exec_parameters(char * dst, size_t n, size_t * dst_i, va_list args, core_SNPrintfParameters p) {
+    switch(p.specifier) {
+    case 's': {
+        const char * str = va_arg(args, const char *);
+        size_t len = strlen(str);
+        if(*dst_i + len + 2 > n) {
+            CORE_TODO("Handle the case where there is not enough room to print the string");
+        }
+        memcpy(&dst[*dst_i], str, len);
+        *dst_i += len;
+    } break;
+    case 'i':
+    case 'd': {
+        long num = 0;
+        if(p.length[0] == 'l') {
+            num = va_arg(args, long);
+        } else if(p.length[0] == 'h') {
+            num = va_arg(args, int);
+        } else {
+            num = va_arg(args, int);
+        }
+        *dst_i += (size_t)core_stringify_long(&dst[*dst_i], n - *dst_i, num);
+    } break;
+    default: CORE_TODO("Handle other format specifiers"); break;
+    }
+}
+
+enum {
+    core_snprintf_state_base,
+    core_snprintf_state_flags,
+    core_snprintf_state_width,
+    core_snprintf_state_precision,
+    core_snprintf_state_precision_maybe,
+    core_snprintf_state_length_1,
+    core_snprintf_state_length_2,
+    core_snprintf_state_specifier
+};
+
+
+#ifdef CORE_ATTRIBUTES_AVAILABLE
+__attribute__((format(printf, 3, 4)))
+#endif
+int core_snprintf(char * dst, size_t n, const char * fmt, ...)
+#ifdef CORE_IMPLEMENTATION
+{
+    size_t dst_i = 0;
+    size_t fmt_i = 0;
+    int core_snprintf_state = core_snprintf_state_base;
+
+    core_SNPrintfParameters params = {0};
+    va_list args;
+
+    va_start(args, fmt);
+    while(dst_i + 2 < n && fmt[fmt_i] != 0) {
+        switch(core_snprintf_state) {
+        case core_snprintf_state_base:
+            if(fmt[fmt_i] == '%') {
+                ++fmt_i;
+                core_snprintf_state = core_snprintf_state_flags;
+            } else {
+                dst[dst_i] = fmt[fmt_i];
+                ++dst_i;
+                ++fmt_i;
+            } 
+            break;
+        case core_snprintf_state_flags: {
+            core_Bool flag_encountered = CORE_TRUE;
+            switch(fmt[fmt_i]) {
+            case '-': params.flag_left_justify = CORE_TRUE; break;
+            case '+': params.flag_show_plus_on_positive_integers = CORE_TRUE; break;
+            case ' ': params.flag_pad_if_no_sign = CORE_TRUE; break;
+            case '#': params.flag_hash = CORE_TRUE; break;
+            case '0': params.flag_pad_with_zeros = CORE_TRUE; break;
+            default: flag_encountered = CORE_FALSE; break;
+            }
+            if(flag_encountered) {
+                ++fmt_i;
+            } else {
+                core_snprintf_state = core_snprintf_state_width;
+            }
+        } break;
+        case core_snprintf_state_width: {
+            if(fmt[fmt_i] == '*') {
+                params.read_width_from_args = CORE_TRUE;
+                ++fmt_i;
+                core_snprintf_state = core_snprintf_state_precision_maybe;
+            } else if(isdigit(fmt[fmt_i])) {
+                params.width *= 10;
+                params.width += fmt[fmt_i] - '0';
+                ++fmt_i;
+            } else {
+                core_snprintf_state = core_snprintf_state_precision_maybe;
+            }
+        } break;
+        case core_snprintf_state_precision_maybe: {
+            if(fmt[fmt_i] != '.') {
+                core_snprintf_state = core_snprintf_state_length_1;
+                params.precision = 6;
+            } else {
+                core_snprintf_state = core_snprintf_state_precision;
+                ++fmt_i;
+            }
+        } break;
+        case core_snprintf_state_precision: {
+            if(fmt[fmt_i] == '*') {
+                params.read_precision_from_args = CORE_TRUE;
+                ++fmt_i;
+                core_snprintf_state = core_snprintf_state_length_1;
+            } else if(isdigit(fmt[fmt_i])) {
+                params.precision *= 10;
+                params.precision += fmt[fmt_i] - '0';
+                ++fmt_i;
+            } else {
+                core_snprintf_state = core_snprintf_state_length_1;
+            }
+        } break;
+        case core_snprintf_state_length_1: {
+            char len = fmt[fmt_i];
+            switch(len) {
+            case 'l':
+            case 'h':
+                params.length[0] = len;
+                core_snprintf_state = core_snprintf_state_length_2;
+                ++fmt_i;
+                break;
+            case 'j':
+            case 'z':
+            case 't':
+            case 'L':
+                params.length[0] = len;
+                core_snprintf_state = core_snprintf_state_specifier;
+                ++fmt_i;
+                break;
+            default:
+                core_snprintf_state = core_snprintf_state_specifier;
+            }
+        } break;
+        case core_snprintf_state_length_2: {
+            char len = fmt[fmt_i];
+            switch(len) {
             case 'l':
             case 'h':
                 params.length[1] = len;
@@ -1122,345 +3103,1050 @@ int core_snprintf(char * dst, size_t n, const char * fmt, ...)
                 params.specifier = fmt[fmt_i];
                 core_snprintf_exec_parameters(dst, n, &dst_i, args, params);
 
-                /*Reset parser info*/
-                memset(&params, 0, sizeof(params));
-                ++fmt_i;
-                core_snprintf_state = core_snprintf_state_base;
-                break;
-            default: {
-                fprintf(stderr, "Invalid specifier: %c\n", fmt[fmt_i]);
-                fprintf(stderr, "Length: %s\n", params.length);
-                CORE_UNREACHABLE; 
-            } break;
-            }
-        } break;
-        default: CORE_UNREACHABLE; break;
-        } 
+                /*Reset parser info*/
+                memset(&params, 0, sizeof(params));
+                ++fmt_i;
+                core_snprintf_state = core_snprintf_state_base;
+                break;
+            default: {
+                fprintf(stderr, "Invalid specifier: %c\n", fmt[fmt_i]);
+                fprintf(stderr, "Length: %s\n", params.length);
+                CORE_UNREACHABLE; 
+            } break;
+            }
+        } break;
+        default: CORE_UNREACHABLE; break;
+        } 
+    }
+
+    /* cleanup: */
+    va_end(args);
+    dst[dst_i] = 0;
+    return (int)dst_i;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*
+  TODO: finish this function
+int core_string_search_replace(char * str, unsigned long strcap, const char * search, const char * replace)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long i = 0;
+    const unsigned long slen = strlen(search);
+    const unsigned long rlen = strlen(replace);
+    
+    for(i = 0; i < strcap; ++i) {
+        unsigned long remaining_capacity = strcap - i;
+        if(core_streql(buf
+    }
+}
+#else
+;
+#endif
+*//*CORE_IMPLEMENTATION*/
+
+/**** BITSET ****/
+#define CORE_BITARRAY(n) struct { char bits[(n / CHAR_BIT) + 1]; }
+typedef CORE_BITARRAY(8) core_BitArray8;
+typedef CORE_BITARRAY(16) core_BitArray16;
+typedef CORE_BITARRAY(32) core_BitArray32;
+typedef CORE_BITARRAY(64) core_BitArray64;
+typedef CORE_BITARRAY(128) core_BitArray128;
+typedef CORE_BITARRAY(256) core_BitArray256;
+typedef CORE_BITARRAY(512) core_BitArray512;
+typedef CORE_BITARRAY(1024) core_BitArray1024;
+typedef CORE_BITARRAY(2048) core_BitArray2048;
+typedef CORE_BITARRAY(4096) core_BitArray4096;
+typedef CORE_BITARRAY(8192) core_BitArray8192;
+
+void core_bitarray_set(void * ptr, unsigned int bit)
+#ifdef CORE_IMPLEMENTATION
+{
+    (void)(ptr);
+    (void)(bit);
+    CORE_TODO("implement");
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+/*#define CORE_BITSET_SET(bitset, bit) (assert(bit / CHARBIT) < sizeof(bitset->bits), bitset->bits[bit / CHARBIT] >> bit % CHARBIT)*/
+
+typedef struct {
+    unsigned char * bits;
+    unsigned int len;
+} core_BitVec;
+
+void core_bitvec_set(core_BitVec * self, unsigned int bit)
+#ifdef CORE_IMPLEMENTATION
+{
+    const unsigned int index = bit / CHAR_BIT;
+    const unsigned char shift = bit % CHAR_BIT;
+    const unsigned char byte = (unsigned char)(1 << shift);
+    if(self->bits == NULL || self->len == 0) {
+        self->len = index + 1;
+        self->bits = malloc(sizeof(self->bits[0]) * self->len);
+        assert(self->bits);
+        memset(self->bits, 0, self->len);
+    } else if(index + 1 > self->len) {
+        const unsigned int oldlen = self->len;
+        self->len = index + 1;
+        self->bits = realloc(self->bits, sizeof(self->bits[0]) * self->len);
+        assert(self->bits);
+        memset(&self->bits[oldlen], 0, self->len - oldlen);
+    }
+    self->bits[index] |= byte;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+
+/**** HASH ****/
+
+long core_hash(const char * key, long modulus) 
+#ifdef CORE_IMPLEMENTATION
+{
+    /* Inspired by djbt2 by Dan Bernstein - http://www.cse.yorku.ca/~oz/hash.html */
+    unsigned long hash = 5381;
+    unsigned long i = 0;
+    long result;
+    assert(modulus > 0);
+
+    for(i = 0; key[i] != 0; ++i) {
+        unsigned char c = (unsigned char)key[i];
+        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+    }
+    
+    result = (long)(hash % (unsigned long)modulus);
+    assert(result >= 0);
+    return result;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+
+/*full width djb2 with a murmur style finalizer, so both the low and the high bits are usable*/
+unsigned long core_hash_string(const char * key)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long hash = 5381;
+    unsigned long i = 0;
+    for(i = 0; key[i] != 0; ++i) {
+        hash = ((hash << 5) + hash) + (unsigned char)key[i];
+    }
+#if ULONG_MAX > 0xffffffffUL
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdUL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53UL;
+    hash ^= hash >> 33;
+#else
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bUL;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35UL;
+    hash ^= hash >> 16;
+#endif /*ULONG_MAX*/
+    return hash;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/**** STAT ****/
+typedef time_t core_Time;
+core_Time core_file_modified_timestamp(const char * path);
+
+#ifdef CORE_IMPLEMENTATION
+
+#if defined(CORE_UNIX)
+    #include <sys/stat.h>
+    core_Time core_file_modified_timestamp(const char * path) {
+        struct stat st;
+        if(stat(path, &st) != 0) return -1;
+        return st.st_mtime;
+    }
+#elif defined(CORE_WINDOWS)
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <io.h>
+    core_Time core_file_modified_timestamp(const char * path) {
+        int fd = _open(path, _O_RDONLY);
+        struct _stat st;
+        if(_fstat(fd, &st) != 0) return -1;
+        return st.st_mtime;
+    }
+#endif
+
+#endif /*CORE_IMPLEMENTATION*/
+
+
+core_Bool core_file_needs_update(const char * output_file, const char ** input_files, unsigned long n) {
+    time_t time = core_file_modified_timestamp(output_file);
+    unsigned long i;
+    if(time <= 0) return CORE_TRUE;
+    
+    for(i = 0; i < n; ++i) {
+        if(core_file_modified_timestamp(input_files[i]) > time) return CORE_TRUE;
+    }
+    return CORE_FALSE;
+}
+
+
+/**** ACCESS ****/
+#if defined(CORE_UNIX)
+#include <unistd.h>
+core_Bool core_file_exists(const char * path)
+#ifdef CORE_IMPLEMENTATION
+{
+    return (access(path, F_OK) == 0);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+#endif /*CORE_UNIX*/
+
+
+
+
+/**** Gensym ****/
+void core_gensym(char * dst, size_t n)
+#ifdef CORE_IMPLEMENTATION
+{
+    size_t i = 0;
+    int num = rand();
+    if(n < 1) {
+        dst[0] = 0;
+        return;
+    }
+    for(i = 0; i < n - 1; ++i) {
+        if(i == 0) {
+            dst[i] = 'g';
+        } else {
+            if(num == 0) num = rand();
+            dst[i] = '0' + (char)(num % 10);
+            num /= 10;
+        }
+    }
+    dst[n - 1] = 0;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+
+
+/**** HASHMAP V2 ****/
+/*open addressing table over the insertion ordered keys. ctrl has one byte per slot, 0 when the
+  slot is empty and otherwise the high bit plus the top 7 bits of the key's hash. each slot keeps
+  the key's full hash next to its index in keys, so probes are rejected without touching the key
+  strings and growing the table never rehashes them. cap is a power of two*/
+typedef struct {
+    unsigned long hash;
+    long index;
+} core_HashmapSlot;
+
+typedef struct {
+    unsigned char * ctrl;
+    core_HashmapSlot * slots;
+    long cap;
+} core_HashmapTable;
+
+/*with incremental set, growing keeps the previous table as old and every get, set and remove moves
+  a few of its slots over, so no single insert pays for rehashing the whole map. keys live in exactly
+  one of the two tables and old slots before migrated are all empty. hashes holds each key's hash
+  by key index, so remove finds the slot of the key it moves without hashing it. only the slot
+  table is amortised: keys, values and hashes are plain vecs that still double with an O(n) copy,
+  so reserve them up front when the worst single insert matters*/
+typedef struct {
+    core_HashmapTable table;
+    core_HashmapTable old;
+    core_Vec(unsigned long) hashes;
+    long migrated;
+    core_Bool incremental;
+} core_HashmapBuckets;
+
+typedef core_Vec(const char *) core_HashmapKeys;
+
+#define CORE_HASHMAP_CTRL_EMPTY 0
+#define CORE_HASHMAP_MIN_CAP 16
+#define _CORE_HASHMAP_CTRL(hash) ((unsigned char)(0x80 | ((hash) >> (sizeof(unsigned long) * CHAR_BIT - 7))))
+
+#ifndef CORE_HASHMAP_MIGRATE_STEP
+#   define CORE_HASHMAP_MIGRATE_STEP 16
+#endif /*CORE_HASHMAP_MIGRATE_STEP*/
+
+#define _CORE_HASHMAP_MIGRATING(buckets) ((buckets)->migrated < (buckets)->old.cap)
+
+/*slot holding key or -1, hash must be core_hash_string(key)*/
+long _core_hashmap_find_slot(const core_HashmapTable * table, const core_HashmapKeys * keys, const char * key, unsigned long hash)
+#ifdef CORE_IMPLEMENTATION
+{
+    const unsigned char ctrl = _CORE_HASHMAP_CTRL(hash);
+    unsigned long mask, i;
+
+    if(table->cap == 0) return -1;
+
+    mask = (unsigned long)table->cap - 1;
+    for(i = hash & mask; table->ctrl[i] != CORE_HASHMAP_CTRL_EMPTY; i = (i + 1) & mask) {
+        const core_HashmapSlot * slot = &table->slots[i];
+        if(table->ctrl[i] != ctrl || slot->hash != hash) continue;
+        assert(slot->index >= 0 && slot->index < (long)keys->len);
+        if(core_streql(keys->items[slot->index], key)) return (long)i;
+    }
+    return -1;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*slot holding index or -1, hash must be the hash of the key at index*/
+long _core_hashmap_find_index_slot(const core_HashmapTable * table, unsigned long hash, long index)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long mask, i;
+    if(table->cap == 0) return -1;
+    mask = (unsigned long)table->cap - 1;
+    for(i = hash & mask; table->ctrl[i] != CORE_HASHMAP_CTRL_EMPTY; i = (i + 1) & mask) {
+        if(table->slots[i].index == index) return (long)i;
+    }
+    return -1;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*index must not be in the table yet and there must be a free slot*/
+void _core_hashmap_insert_slot(core_HashmapTable * table, unsigned long hash, long index)
+#ifdef CORE_IMPLEMENTATION
+{
+    const unsigned long mask = (unsigned long)table->cap - 1;
+    unsigned long i;
+    for(i = hash & mask; table->ctrl[i] != CORE_HASHMAP_CTRL_EMPTY; i = (i + 1) & mask);
+    table->ctrl[i] = _CORE_HASHMAP_CTRL(hash);
+    table->slots[i].hash = hash;
+    table->slots[i].index = index;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*empties slot i with backward shift deletion, pulling later entries of the probe run back into the
+  hole so removals never leave tombstones and lookups stay as short as right after inserting*/
+void _core_hashmap_erase_slot(core_HashmapTable * table, unsigned long i)
+#ifdef CORE_IMPLEMENTATION
+{
+    const unsigned long mask = (unsigned long)table->cap - 1;
+    unsigned long j = i;
+    for(;;) {
+        unsigned long home;
+        j = (j + 1) & mask;
+        if(table->ctrl[j] == CORE_HASHMAP_CTRL_EMPTY) break;
+        home = table->slots[j].hash & mask;
+        /*the entry at j may only move back if the hole is not before its home slot*/
+        if(((j - home) & mask) >= ((j - i) & mask)) {
+            table->ctrl[i] = table->ctrl[j];
+            table->slots[i] = table->slots[j];
+            i = j;
+        }
+    }
+    table->ctrl[i] = CORE_HASHMAP_CTRL_EMPTY;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*moves old entries into table, one step per empty slot passed or entry moved. erasing with
+  backward shift keeps the rest of old searchable and never refills slots before migrated*/
+void _core_hashmap_migrate(core_HashmapBuckets * buckets, long steps)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_HashmapTable * old = &buckets->old;
+    while(steps-- > 0 && _CORE_HASHMAP_MIGRATING(buckets)) {
+        const unsigned long i = (unsigned long)buckets->migrated;
+        if(old->ctrl[i] == CORE_HASHMAP_CTRL_EMPTY) {
+            buckets->migrated++;
+        } else {
+            _core_hashmap_insert_slot(&buckets->table, old->slots[i].hash, old->slots[i].index);
+            _core_hashmap_erase_slot(old, i);
+        }
+    }
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*gives the old table back once everything has moved, which needs the arena so get can not do it*/
+void _core_hashmap_release_old(core_HashmapBuckets * buckets, core_Arena * arena)
+#ifdef CORE_IMPLEMENTATION
+{
+    if(buckets->old.slots == NULL || _CORE_HASHMAP_MIGRATING(buckets)) return;
+    core_arena_reclaim_memory(arena, buckets->old.slots);
+    memset(&buckets->old, 0, sizeof(buckets->old));
+    buckets->migrated = 0;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*finds the table and slot holding key, table is NULL if it is in neither*/
+long _core_hashmap_locate(core_HashmapBuckets * buckets, const core_HashmapKeys * keys, const char * key, unsigned long hash, core_HashmapTable ** table)
+#ifdef CORE_IMPLEMENTATION
+{
+    long slot;
+    _core_hashmap_migrate(buckets, CORE_HASHMAP_MIGRATE_STEP);
+    *table = &buckets->table;
+    slot = _core_hashmap_find_slot(*table, keys, key, hash);
+    if(slot < 0 && _CORE_HASHMAP_MIGRATING(buckets)) {
+        *table = &buckets->old;
+        slot = _core_hashmap_find_slot(*table, keys, key, hash);
+    }
+    if(slot < 0) *table = NULL;
+    return slot;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*hash must be core_hash_string(key)*/
+core_Bool core_hashmap_get_index_hashed(core_HashmapBuckets * buckets, core_HashmapKeys * keys, long * result, const char * key, unsigned long hash)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_HashmapTable * table;
+    const long slot = _core_hashmap_locate(buckets, keys, key, hash, &table);
+    *result = slot < 0 ? -1 : table->slots[slot].index;
+    return slot >= 0;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+core_Bool core_hashmap_get_index(core_HashmapBuckets * buckets, core_HashmapKeys * keys, long * result, const char * key)
+#ifdef CORE_IMPLEMENTATION
+{
+    return core_hashmap_get_index_hashed(buckets, keys, result, key, core_hash_string(key));
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*linear probing degrades quickly past 3/4 full*/
+core_Bool core_hashmap_needs_resize(long num_keys, long num_buckets) 
+#ifdef CORE_IMPLEMENTATION
+{
+    return num_keys * 4 > num_buckets * 3;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*grows the table so keys->len + 1 keys fit, slots and control bytes share one arena block.
+  an unfinished incremental resize is completed first*/
+void core_hashmap_rehash(core_HashmapBuckets * buckets, core_Arena * arena, core_HashmapKeys * keys)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_HashmapTable new = {0};
+    long i;
+
+    _core_hashmap_migrate(buckets, LONG_MAX);
+    _core_hashmap_release_old(buckets, arena);
+
+    new.cap = buckets->table.cap == 0 ? CORE_HASHMAP_MIN_CAP : buckets->table.cap * 2;
+    while(core_hashmap_needs_resize((long)keys->len + 1, new.cap)) {
+        new.cap *= 2;
+    }
+    new.slots = core_arena_check_alloc(core_arena_alloc(arena, (size_t)new.cap * (sizeof(new.slots[0]) + 1)));
+    new.ctrl = (unsigned char *)(new.slots + new.cap);
+    memset(new.ctrl, CORE_HASHMAP_CTRL_EMPTY, (size_t)new.cap);
+
+    if(buckets->incremental && buckets->table.cap != 0) {
+        buckets->old = buckets->table;
+        buckets->migrated = 0;
+        buckets->table = new;
+        return;
+    }
+
+    for(i = 0; i < buckets->table.cap; ++i) {
+        if(buckets->table.ctrl[i] != CORE_HASHMAP_CTRL_EMPTY) {
+            _core_hashmap_insert_slot(&new, buckets->table.slots[i].hash, buckets->table.slots[i].index);
+        }
     }
+    if(buckets->table.slots != NULL) {
+        core_arena_reclaim_memory(arena, buckets->table.slots);
+    }
+    buckets->table = new;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void core_hashmap_record_new_hash(core_HashmapBuckets * buckets, core_Arena * arena, core_HashmapKeys * keys, unsigned long hash, long index)
+#ifdef CORE_IMPLEMENTATION
+{
+    _core_hashmap_release_old(buckets, arena);
+    if(buckets->table.cap == 0 || core_hashmap_needs_resize(index + 1, buckets->table.cap)) {
+        core_hashmap_rehash(buckets, arena, keys);
+    }
+    _core_hashmap_insert_slot(&buckets->table, hash, index);
+    assert(index == (long)buckets->hashes.len);
+    core_vec_append(&buckets->hashes, arena, hash);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+void core_hashmap_record_new_key(core_HashmapBuckets * buckets, core_Arena * arena, core_HashmapKeys * keys, const char * key, long index)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_hashmap_record_new_hash(buckets, arena, keys, core_hash_string(key), index);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*removes key from the table and swap removes it from keys, so the last key takes over its index.
+  result is set to that index, the caller must move its last value there too*/
+core_Bool core_hashmap_remove_index(core_HashmapBuckets * buckets, core_Arena * arena, core_HashmapKeys * keys, long * result, const char * key)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_HashmapTable * table;
+    const long slot = _core_hashmap_locate(buckets, keys, key, core_hash_string(key), &table);
+    const long last = (long)keys->len - 1;
+    const char * removed;
+    long index;
+
+    *result = -1;
+    if(slot < 0) return CORE_FALSE;
+    index = table->slots[slot].index;
+    removed = keys->items[index];
+    _core_hashmap_erase_slot(table, (unsigned long)slot);
+
+    if(index != last) {
+        const unsigned long hash = buckets->hashes.items[last];
+        long moved = _core_hashmap_find_index_slot(&buckets->table, hash, last);
+        table = &buckets->table;
+        if(moved < 0) {
+            moved = _core_hashmap_find_index_slot(&buckets->old, hash, last);
+            table = &buckets->old;
+        }
+        assert(moved >= 0);
+        table->slots[moved].index = index;
+        keys->items[index] = keys->items[last];
+        buckets->hashes.items[index] = hash;
+    }
+    keys->len--;
+    buckets->hashes.len--;
+    /*the map strdup'd the key, it is only const for callers*/
+    core_arena_reclaim_memory(arena, (void *)(size_t)removed);
+    _core_hashmap_release_old(buckets, arena);
+    *result = index;
+    return CORE_TRUE;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+#define core_Hashmap(T) struct { core_Vec(T) values; core_HashmapKeys keys; core_HashmapBuckets buckets; long index; }
+
+#define core_hashmap_get(self, key)                                                        \
+    (                                                                                        \
+        core_hashmap_get_index(&(self)->buckets, &(self)->keys, &(self)->index, key)       \
+        ? (&(self)->values.items[(self)->index]) : NULL                                      \
+    )
+
+/*the key is hashed once for both the lookup and the insert*/
+#define core_hashmap_set(self, arena, key, value) do {                                              \
+    const unsigned long _hash_ = core_hash_string(key);                                               \
+    if(core_hashmap_get_index_hashed(&(self)->buckets, &(self)->keys, &(self)->index, key, _hash_)) { \
+        (self)->values.items[(self)->index] = value;                                                  \
+    } else {                                                                                          \
+        core_hashmap_record_new_hash(&(self)->buckets, arena, &(self)->keys, _hash_, (long)(self)->keys.len); \
+        core_vec_append(&(self)->values, arena, value);                                               \
+        core_vec_append(&(self)->keys, arena, core_arena_strdup(arena, key));                         \
+        assert((self)->values.len == (self)->keys.len);                                               \
+    }                                                                                                 \
+} while (0)
+
+/*evaluates to CORE_TRUE if key was there. the last key and value move into the removed entry's place*/
+#define core_hashmap_remove(self, arena, key)                                                      \
+    (core_Bool)(                                                                                     \
+        core_hashmap_remove_index(&(self)->buckets, arena, &(self)->keys, &(self)->index, key)     \
+        ? ((self)->values.items[(self)->index] = (self)->values.items[--(self)->values.len], CORE_TRUE) \
+        : CORE_FALSE                                                                                 \
+    )
+
+/*grow the slot table by moving a few entries on every access instead of all at once, call before
+  the first set. keys, values and buckets.hashes still grow by doubling, reserve them to avoid that*/
+#define core_hashmap_enable_incremental_resize(self) ((self)->buckets.incremental = CORE_TRUE)
+
+
+/**** CONCURRENT HASHMAP ****/
+#if defined(CORE_THREADS_AVAILABLE) && defined(CORE_ATOMICS_AVAILABLE)
+
+#ifndef CORE_CONCURRENT_HASHMAP_SEGMENTS
+#   define CORE_CONCURRENT_HASHMAP_SEGMENTS 16
+#endif /*CORE_CONCURRENT_HASHMAP_SEGMENTS*/
+
+/*values up to this size are copied through the stack in get, bigger ones through malloc*/
+#ifndef CORE_CONCURRENT_HASHMAP_STACK_VALUE
+#   define CORE_CONCURRENT_HASHMAP_STACK_VALUE 256
+#endif /*CORE_CONCURRENT_HASHMAP_STACK_VALUE*/
+
+/*threads beyond this many share reader slots, which is correct but bounces their cache lines*/
+#ifndef CORE_CONCURRENT_HASHMAP_READER_SLOTS
+#   define CORE_CONCURRENT_HASHMAP_READER_SLOTS 64
+#endif /*CORE_CONCURRENT_HASHMAP_READER_SLOTS*/
+
+typedef struct {
+    unsigned long hash;
+    const char * key;
+} core_ConcurrentHashmapEntry;
+
+/*same layout as the core_Hashmap table with the values inline, a table never changes size once
+  published, growing builds a new one next to it*/
+typedef struct {
+    long cap;
+    unsigned char * ctrl;
+    core_ConcurrentHashmapEntry * entries;
+    unsigned char * values;
+} core_ConcurrentHashmapTable;
+
+/*writers take the mutex and bump seq to odd while they change the published table, readers never
+  lock and retry when seq moved under them. replaced tables and removed keys stay allocated on the
+  retired list, so a reader racing a writer only ever sees stale memory, never freed memory*/
+typedef struct {
+    pthread_mutex_t mutex;
+    unsigned long seq;
+    core_ConcurrentHashmapTable * table;
+    long len;
+    void ** retired;
+    long retired_len;
+    long retired_cap;
+    unsigned char pad[CORE_CACHE_LINE_SIZE];
+} core_ConcurrentHashmapSegment;
+
+/*a reader counts itself in count[epoch & 1] of its thread's slot, reclaim flips epoch and frees
+  retired memory once the counts of the previous epoch drop to zero. every slot sits on its own
+  cache line, so readers on different threads never write to a shared line*/
+typedef struct {
+    long count[2];
+    unsigned char pad[CORE_CACHE_LINE_SIZE];
+} core_ConcurrentHashmapReaderSlot;
+
+/*string keys to value_size byte values, keys are copied like in core_Hashmap.
+  the segment comes from the hash bits between the control byte and the table index.
+  get never takes a lock, but it spins while a writer of the same segment is halfway through
+  an update and retries if one finished during the lookup. it never waits on other readers or on
+  core_concurrent_hashmap_reclaim*/
+typedef struct {
+    core_ConcurrentHashmapSegment * segments;
+    unsigned long segment_count;
+    unsigned int segment_shift;
+    size_t value_size;
+    unsigned long epoch;
+    core_ConcurrentHashmapReaderSlot * reader_slots;
+} core_ConcurrentHashmap;
 
-    /* cleanup: */
-    va_end(args);
-    dst[dst_i] = 0;
-    return (int)dst_i;
+#ifdef CORE_IMPLEMENTATION
+unsigned long _core_concurrent_hashmap_next_reader = 0;
+CORE_THREAD_LOCAL unsigned long _core_concurrent_hashmap_reader = 0;
+#endif /*CORE_IMPLEMENTATION*/
+
+#define _CORE_CONCURRENT_HASHMAP_SEGMENT(map, hash) \
+    (&(map)->segments[((hash) >> (map)->segment_shift) & ((map)->segment_count - 1)])
+
+/*segment_count of 0 uses CORE_CONCURRENT_HASHMAP_SEGMENTS, others are rounded up to a power of two*/
+void core_concurrent_hashmap_init(core_ConcurrentHashmap * map, size_t value_size, unsigned long segment_count)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned int bits = 0;
+    unsigned long i;
+
+    assert(value_size > 0);
+    memset(map, 0, sizeof(*map));
+    if(segment_count == 0) segment_count = CORE_CONCURRENT_HASHMAP_SEGMENTS;
+    while((1UL << bits) < segment_count && bits < 16) bits++;
+    map->segment_count = 1UL << bits;
+    map->segment_shift = (unsigned int)(sizeof(unsigned long) * CHAR_BIT - 7) - bits;
+    map->value_size = value_size;
+    map->segments = calloc(map->segment_count, sizeof(map->segments[0]));
+    assert(map->segments != NULL);
+    map->reader_slots = calloc(CORE_CONCURRENT_HASHMAP_READER_SLOTS, sizeof(map->reader_slots[0]));
+    assert(map->reader_slots != NULL);
+    for(i = 0; i < map->segment_count; ++i) {
+        pthread_mutex_init(&map->segments[i].mutex, NULL);
+    }
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-/*
-  TODO: finish this function
-int core_string_search_replace(char * str, unsigned long strcap, const char * search, const char * replace)
+core_ConcurrentHashmapTable * _core_concurrent_hashmap_table_new(long cap, size_t value_size)
 #ifdef CORE_IMPLEMENTATION
 {
-    unsigned long i = 0;
-    const unsigned long slen = strlen(search);
-    const unsigned long rlen = strlen(replace);
-    
-    for(i = 0; i < strcap; ++i) {
-        unsigned long remaining_capacity = strcap - i;
-        if(core_streql(buf
-    }
+    core_ConcurrentHashmapTable * table;
+    /*zeroed so a reader racing the first insert into a slot sees a NULL key, not garbage*/
+    table = calloc(1, sizeof(*table) + (size_t)cap * (sizeof(table->entries[0]) + value_size + 1));
+    assert(table != NULL);
+    table->cap = cap;
+    table->entries = (core_ConcurrentHashmapEntry *)(void *)(table + 1);
+    table->values = (unsigned char *)(table->entries + cap);
+    table->ctrl = table->values + (size_t)cap * value_size;
+    return table;
 }
 #else
 ;
-#endif
-*//*CORE_IMPLEMENTATION*/
-
-/**** BITSET ****/
-#define CORE_BITARRAY(n) struct { char bits[(n / CHAR_BIT) + 1]; }
-typedef CORE_BITARRAY(8) core_BitArray8;
-typedef CORE_BITARRAY(16) core_BitArray16;
-typedef CORE_BITARRAY(32) core_BitArray32;
-typedef CORE_BITARRAY(64) core_BitArray64;
-typedef CORE_BITARRAY(128) core_BitArray128;
-typedef CORE_BITARRAY(256) core_BitArray256;
-typedef CORE_BITARRAY(512) core_BitArray512;
-typedef CORE_BITARRAY(1024) core_BitArray1024;
-typedef CORE_BITARRAY(2048) core_BitArray2048;
-typedef CORE_BITARRAY(4096) core_BitArray4096;
-typedef CORE_BITARRAY(8192) core_BitArray8192;
+#endif /*CORE_IMPLEMENTATION*/
 
-void core_bitarray_set(void * ptr, unsigned int bit)
+/*byte wise relaxed copies, a reader may copy a value while it is overwritten and throws it away
+  when seq says so*/
+void _core_concurrent_hashmap_load_value(void * dst, const unsigned char * src, size_t size)
 #ifdef CORE_IMPLEMENTATION
 {
-    (void)(ptr);
-    (void)(bit);
-    CORE_TODO("implement");
+    unsigned char * out = dst;
+    size_t i;
+    for(i = 0; i < size; ++i) out[i] = CORE_ATOMIC_LOAD_RELAXED(&src[i]);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
-/*#define CORE_BITSET_SET(bitset, bit) (assert(bit / CHARBIT) < sizeof(bitset->bits), bitset->bits[bit / CHARBIT] >> bit % CHARBIT)*/
-
-typedef struct {
-    unsigned char * bits;
-    unsigned int len;
-} core_BitVec;
 
-void core_bitvec_set(core_BitVec * self, unsigned int bit)
+void _core_concurrent_hashmap_store_value(unsigned char * dst, const void * src, size_t size)
 #ifdef CORE_IMPLEMENTATION
 {
-    const unsigned int index = bit / CHAR_BIT;
-    const unsigned char shift = bit % CHAR_BIT;
-    const unsigned char byte = (unsigned char)(1 << shift);
-    if(self->bits == NULL || self->len == 0) {
-        self->len = index + 1;
-        self->bits = malloc(sizeof(self->bits[0]) * self->len);
-        assert(self->bits);
-        memset(self->bits, 0, self->len);
-    } else if(index + 1 > self->len) {
-        const unsigned int oldlen = self->len;
-        self->len = index + 1;
-        self->bits = realloc(self->bits, sizeof(self->bits[0]) * self->len);
-        assert(self->bits);
-        memset(&self->bits[oldlen], 0, self->len - oldlen);
-    }
-    self->bits[index] |= byte;
+    const unsigned char * in = src;
+    size_t i;
+    for(i = 0; i < size; ++i) CORE_ATOMIC_STORE_RELAXED(&dst[i], in[i]);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-
-/**** HASH ****/
-
-long core_hash(const char * key, long modulus) 
+void _core_concurrent_hashmap_write_begin(core_ConcurrentHashmapSegment * segment)
 #ifdef CORE_IMPLEMENTATION
 {
-    /* Inspired by djbt2 by Dan Bernstein - http://www.cse.yorku.ca/~oz/hash.html */
-    unsigned long hash = 5381;
-    unsigned long i = 0;
-    long result;
-    assert(modulus > 0);
-
-    for(i = 0; key[i] != 0; ++i) {
-        unsigned char c = (unsigned char)key[i];
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-    }
-    
-    result = (long)(hash % (unsigned long)modulus);
-    assert(result >= 0);
-    return result;
+    CORE_ATOMIC_STORE_RELAXED(&segment->seq, segment->seq + 1);
+    CORE_ATOMIC_FENCE_RELEASE();
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-
-
-/**** STAT ****/
-typedef time_t core_Time;
-core_Time core_file_modified_timestamp(const char * path);
-
+void _core_concurrent_hashmap_write_end(core_ConcurrentHashmapSegment * segment)
 #ifdef CORE_IMPLEMENTATION
-
-#if defined(CORE_UNIX)
-    #include <sys/stat.h>
-    core_Time core_file_modified_timestamp(const char * path) {
-        struct stat st;
-        if(stat(path, &st) != 0) return -1;
-        return st.st_mtime;
-    }
-#elif defined(CORE_WINDOWS)
-    #include <sys/stat.h>
-    #include <fcntl.h>
-    #include <io.h>
-    core_Time core_file_modified_timestamp(const char * path) {
-        int fd = _open(path, _O_RDONLY);
-        struct _stat st;
-        if(_fstat(fd, &st) != 0) return -1;
-        return st.st_mtime;
-    }
-#endif
-
+{
+    CORE_ATOMIC_STORE(&segment->seq, segment->seq + 1);
+}
+#else
+;
 #endif /*CORE_IMPLEMENTATION*/
 
-
-core_Bool core_file_needs_update(const char * output_file, const char ** input_files, unsigned long n) {
-    time_t time = core_file_modified_timestamp(output_file);
-    unsigned long i;
-    if(time <= 0) return CORE_TRUE;
-    
-    for(i = 0; i < n; ++i) {
-        if(core_file_modified_timestamp(input_files[i]) > time) return CORE_TRUE;
+void _core_concurrent_hashmap_retire(core_ConcurrentHashmapSegment * segment, void * ptr)
+#ifdef CORE_IMPLEMENTATION
+{
+    if(segment->retired_len >= segment->retired_cap) {
+        segment->retired_cap = segment->retired_cap * 2 + 8;
+        segment->retired = realloc(segment->retired, sizeof(segment->retired[0]) * (size_t)segment->retired_cap);
+        assert(segment->retired != NULL);
     }
-    return CORE_FALSE;
+    segment->retired[segment->retired_len++] = ptr;
 }
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-
-/**** ACCESS ****/
-#if defined(CORE_UNIX)
-#include <unistd.h>
-core_Bool core_file_exists(const char * path)
+/*writer side lookup, the segment mutex must be held*/
+long _core_concurrent_hashmap_find_slot(const core_ConcurrentHashmapTable * table, const char * key, unsigned long hash)
 #ifdef CORE_IMPLEMENTATION
 {
-    return (access(path, F_OK) == 0);
+    const unsigned char ctrl = _CORE_HASHMAP_CTRL(hash);
+    unsigned long mask, i;
+
+    if(table == NULL) return -1;
+    mask = (unsigned long)table->cap - 1;
+    for(i = hash & mask; table->ctrl[i] != CORE_HASHMAP_CTRL_EMPTY; i = (i + 1) & mask) {
+        if(table->ctrl[i] == ctrl && table->entries[i].hash == hash && core_streql(table->entries[i].key, key)) {
+            return (long)i;
+        }
+    }
+    return -1;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
-#endif /*CORE_UNIX*/
-
 
+/*copies every entry into a bigger table and publishes it. the old table is left untouched for the
+  readers still probing it, so only writers of this one segment wait for the resize*/
+void _core_concurrent_hashmap_grow(core_ConcurrentHashmap * map, core_ConcurrentHashmapSegment * segment)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_ConcurrentHashmapTable * old = segment->table;
+    core_ConcurrentHashmapTable * new;
+    long cap = old == NULL ? CORE_HASHMAP_MIN_CAP : old->cap * 2;
+    long i;
 
+    while(core_hashmap_needs_resize(segment->len + 1, cap)) cap *= 2;
+    new = _core_concurrent_hashmap_table_new(cap, map->value_size);
+    for(i = 0; old != NULL && i < old->cap; ++i) {
+        const unsigned long mask = (unsigned long)cap - 1;
+        unsigned long j;
+        if(old->ctrl[i] == CORE_HASHMAP_CTRL_EMPTY) continue;
+        for(j = old->entries[i].hash & mask; new->ctrl[j] != CORE_HASHMAP_CTRL_EMPTY; j = (j + 1) & mask);
+        new->ctrl[j] = old->ctrl[i];
+        new->entries[j] = old->entries[i];
+        memcpy(new->values + (size_t)j * map->value_size, old->values + (size_t)i * map->value_size, map->value_size);
+    }
+    CORE_ATOMIC_STORE(&segment->table, new);
+    if(old != NULL) _core_concurrent_hashmap_retire(segment, old);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-/**** Gensym ****/
-void core_gensym(char * dst, size_t n)
+/*registers a reader in the current epoch in the slot of the calling thread and returns the counter
+  to decrement when done. a reader that raced an epoch flip moves to the new epoch, so reclaim never
+  misses it*/
+long * _core_concurrent_hashmap_read_begin(core_ConcurrentHashmap * map)
 #ifdef CORE_IMPLEMENTATION
 {
-    size_t i = 0;
-    int num = rand();
-    if(n < 1) {
-        dst[0] = 0;
-        return;
+    core_ConcurrentHashmapReaderSlot * slot;
+    if(_core_concurrent_hashmap_reader == 0) {
+        _core_concurrent_hashmap_reader = CORE_ATOMIC_FETCH_ADD(&_core_concurrent_hashmap_next_reader, 1) + 1;
     }
-    for(i = 0; i < n - 1; ++i) {
-        if(i == 0) {
-            dst[i] = 'g';
-        } else {
-            if(num == 0) num = rand();
-            dst[i] = '0' + (char)(num % 10);
-            num /= 10;
-        }
+    slot = &map->reader_slots[_core_concurrent_hashmap_reader % CORE_CONCURRENT_HASHMAP_READER_SLOTS];
+    for(;;) {
+        const unsigned long epoch = CORE_ATOMIC_LOAD(&map->epoch);
+        long * count = &slot->count[epoch & 1];
+        CORE_ATOMIC_FETCH_ADD(count, 1);
+        CORE_ATOMIC_FENCE_SEQ_CST();
+        if(CORE_ATOMIC_LOAD(&map->epoch) == epoch) return count;
+        CORE_ATOMIC_FETCH_ADD(count, -1);
     }
-    dst[n - 1] = 0;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-
-
-/**** HASHMAP V2 ****/
-typedef struct core_HashmapNode {
-    struct core_HashmapNode * next;
-    long index;
-} core_HashmapNode;
-
-typedef core_Vec(core_HashmapNode*) core_HashmapBuckets;
-typedef core_Vec(const char *) core_HashmapKeys;
-
-core_Bool core_hashmap_get_index(core_HashmapBuckets * buckets, core_HashmapKeys * keys, long * result, const char * key)
+/*lock free, copies the value into value and returns CORE_TRUE when key is there. attempts that
+  raced a writer copy into a local buffer, so value is only written once, and never on a miss*/
+core_Bool core_concurrent_hashmap_get(core_ConcurrentHashmap * map, const char * key, void * value)
 #ifdef CORE_IMPLEMENTATION
 {
-    long i;
-    core_HashmapNode * node;
-
-    if(buckets->len <= 0) return CORE_FALSE;
-
-    i = core_hash(key, buckets->len);
-    assert(i < buckets->len);
-    node = buckets->items[i];
-    while(node) {
-        assert(node->index < keys->len);
-        assert(node->index >= 0);
-        if(core_streql(keys->items[node->index], key)) {
-            *result = node->index;
-            return CORE_TRUE;
+    const unsigned long hash = core_hash_string(key);
+    const unsigned char ctrl = _CORE_HASHMAP_CTRL(hash);
+    core_ConcurrentHashmapSegment * segment = _CORE_CONCURRENT_HASHMAP_SEGMENT(map, hash);
+    unsigned char stack_copy[CORE_CONCURRENT_HASHMAP_STACK_VALUE];
+    unsigned char * copy = stack_copy;
+    long * readers;
+    core_Bool found;
+
+    if(map->value_size > sizeof(stack_copy)) {
+        copy = malloc(map->value_size);
+        if(copy == NULL) CORE_FATAL_ERROR("Failed to allocate a concurrent hashmap value");
+    }
+    readers = _core_concurrent_hashmap_read_begin(map);
+
+    for(;;) {
+        const unsigned long seq = CORE_ATOMIC_LOAD(&segment->seq);
+        const core_ConcurrentHashmapTable * table;
+
+        if(seq & 1) continue;
+        found = CORE_FALSE;
+        table = CORE_ATOMIC_LOAD(&segment->table);
+        if(table != NULL) {
+            const unsigned long mask = (unsigned long)table->cap - 1;
+            unsigned long i = hash & mask;
+            long probes;
+            /*a torn table can look full, so the probe is bounded by cap as well*/
+            for(probes = 0; probes < table->cap; ++probes, i = (i + 1) & mask) {
+                const unsigned char c = CORE_ATOMIC_LOAD_RELAXED(&table->ctrl[i]);
+                const char * k;
+                if(c == CORE_HASHMAP_CTRL_EMPTY) break;
+                if(c != ctrl || CORE_ATOMIC_LOAD_RELAXED(&table->entries[i].hash) != hash) continue;
+                k = CORE_ATOMIC_LOAD(&table->entries[i].key);
+                if(k != NULL && core_streql(k, key)) {
+                    _core_concurrent_hashmap_load_value(copy, table->values + i * map->value_size, map->value_size);
+                    found = CORE_TRUE;
+                    break;
+                }
+            }
         }
-        node = node->next;
-    } 
-    *result = -1;
-    return CORE_FALSE;
+        CORE_ATOMIC_FENCE_ACQUIRE();
+        if(CORE_ATOMIC_LOAD_RELAXED(&segment->seq) == seq) break;
+    }
+    CORE_ATOMIC_FETCH_ADD(readers, -1);
+    if(found) memcpy(value, copy, map->value_size);
+    if(copy != stack_copy) free(copy);
+    return found;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-core_Bool core_hashmap_needs_resize(long num_keys, long num_buckets) 
+/*inserts a copy of key or overwrites its value*/
+void core_concurrent_hashmap_set(core_ConcurrentHashmap * map, const char * key, const void * value)
 #ifdef CORE_IMPLEMENTATION
 {
-    return num_keys >= num_buckets * 3;
+    const unsigned long hash = core_hash_string(key);
+    core_ConcurrentHashmapSegment * segment = _CORE_CONCURRENT_HASHMAP_SEGMENT(map, hash);
+    core_ConcurrentHashmapTable * table;
+    long slot;
+
+    pthread_mutex_lock(&segment->mutex);
+    slot = _core_concurrent_hashmap_find_slot(segment->table, key, hash);
+    if(slot < 0) {
+        const size_t len = strlen(key) + 1;
+        char * dup = malloc(len);
+        unsigned long mask, i;
+        assert(dup != NULL);
+        memcpy(dup, key, len);
+        if(segment->table == NULL || core_hashmap_needs_resize(segment->len + 1, segment->table->cap)) {
+            _core_concurrent_hashmap_grow(map, segment);
+        }
+        table = segment->table;
+        mask = (unsigned long)table->cap - 1;
+        for(i = hash & mask; table->ctrl[i] != CORE_HASHMAP_CTRL_EMPTY; i = (i + 1) & mask);
+        _core_concurrent_hashmap_write_begin(segment);
+        CORE_ATOMIC_STORE_RELAXED(&table->entries[i].hash, hash);
+        CORE_ATOMIC_STORE(&table->entries[i].key, (const char *)dup);
+        _core_concurrent_hashmap_store_value(table->values + i * map->value_size, value, map->value_size);
+        CORE_ATOMIC_STORE_RELAXED(&table->ctrl[i], _CORE_HASHMAP_CTRL(hash));
+        _core_concurrent_hashmap_write_end(segment);
+        CORE_ATOMIC_STORE_RELAXED(&segment->len, segment->len + 1);
+    } else {
+        table = segment->table;
+        _core_concurrent_hashmap_write_begin(segment);
+        _core_concurrent_hashmap_store_value(table->values + (size_t)slot * map->value_size, value, map->value_size);
+        _core_concurrent_hashmap_write_end(segment);
+    }
+    pthread_mutex_unlock(&segment->mutex);
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-void core_hashmap_rehash(core_HashmapBuckets * buckets, core_Arena * arena, core_HashmapKeys * keys);
-
-void core_hashmap_record_new_key(core_HashmapBuckets * buckets, core_Arena * arena, core_HashmapKeys * keys, const char * key, long index)
+/*backward shift deletion like _core_hashmap_erase_slot, the key goes on the retired list*/
+core_Bool core_concurrent_hashmap_remove(core_ConcurrentHashmap * map, const char * key)
 #ifdef CORE_IMPLEMENTATION
 {
-    long i;
-    core_HashmapNode * new;
+    const unsigned long hash = core_hash_string(key);
+    core_ConcurrentHashmapSegment * segment = _CORE_CONCURRENT_HASHMAP_SEGMENT(map, hash);
+    core_ConcurrentHashmapTable * table;
+    unsigned long mask, i, j;
+    long slot;
+
+    pthread_mutex_lock(&segment->mutex);
+    table = segment->table;
+    slot = _core_concurrent_hashmap_find_slot(table, key, hash);
+    if(slot < 0) {
+        pthread_mutex_unlock(&segment->mutex);
+        return CORE_FALSE;
+    }
+    _core_concurrent_hashmap_retire(segment, (void *)(size_t)table->entries[slot].key);
 
-    if(buckets->cap == 0) {
-        for(i = 0; i < 16; ++i) {
-            core_vec_append(buckets, arena, NULL);
+    _core_concurrent_hashmap_write_begin(segment);
+    mask = (unsigned long)table->cap - 1;
+    i = j = (unsigned long)slot;
+    for(;;) {
+        unsigned long home;
+        j = (j + 1) & mask;
+        if(table->ctrl[j] == CORE_HASHMAP_CTRL_EMPTY) break;
+        home = table->entries[j].hash & mask;
+        if(((j - home) & mask) >= ((j - i) & mask)) {
+            CORE_ATOMIC_STORE_RELAXED(&table->ctrl[i], table->ctrl[j]);
+            CORE_ATOMIC_STORE_RELAXED(&table->entries[i].hash, table->entries[j].hash);
+            CORE_ATOMIC_STORE(&table->entries[i].key, table->entries[j].key);
+            _core_concurrent_hashmap_store_value(table->values + i * map->value_size, table->values + j * map->value_size, map->value_size);
+            i = j;
         }
-    } else if(core_hashmap_needs_resize(index, buckets->len)) {
-        core_hashmap_rehash(buckets, arena, keys);
     }
+    CORE_ATOMIC_STORE_RELAXED(&table->ctrl[i], (unsigned char)CORE_HASHMAP_CTRL_EMPTY);
+    _core_concurrent_hashmap_write_end(segment);
 
-    i = core_hash(key, buckets->len);
-
-    assert(i < buckets->len);
-
-    new = core_arena_alloc(arena, sizeof(core_HashmapNode));
-    assert(new);
-    memset(new, 0, sizeof(core_HashmapNode));
-
-    new->next = buckets->items[i];
-    new->index = index;
-
-    buckets->items[i] = new;
+    CORE_ATOMIC_STORE_RELAXED(&segment->len, segment->len - 1);
+    pthread_mutex_unlock(&segment->mutex);
+    return CORE_TRUE;
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-void core_hashmap_rehash(core_HashmapBuckets * buckets, core_Arena * arena, core_HashmapKeys * keys)
+/*number of keys, only exact while no writer is running*/
+long core_concurrent_hashmap_len(core_ConcurrentHashmap * map)
 #ifdef CORE_IMPLEMENTATION
 {
-    core_HashmapBuckets new = {0};
-    long i;
+    long len = 0;
+    unsigned long i;
+    for(i = 0; i < map->segment_count; ++i) {
+        len += CORE_ATOMIC_LOAD_RELAXED(&map->segments[i].len);
+    }
+    return len;
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-    /*initialize new resized buckets array*/
-    for(i = 0; i < keys->len * 4; ++i) {
-        core_vec_append(&new, arena, NULL);
+/*frees the retired tables and keys, safe to call while other threads get, set and remove.
+  with every segment locked it flips the epoch and waits for the readers that started before the
+  flip, writers wait meanwhile but readers do not*/
+void core_concurrent_hashmap_reclaim(core_ConcurrentHashmap * map)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long i;
+    long j;
+    long retired = 0;
+    for(i = 0; i < map->segment_count; ++i) {
+        pthread_mutex_lock(&map->segments[i].mutex);
+        retired += map->segments[i].retired_len;
     }
-    
-    /*copy keys into new buckets*/
-    for(i = 0; i < keys->len; ++i) {
-        core_hashmap_record_new_key(&new, arena, keys, keys->items[i], i);
-    }
-
-    /*free old buckets memory*/
-    for(i = 0; i < buckets->len; ++i) {
-        core_HashmapNode * node = buckets->items[i];
-        while(node) {
-            core_HashmapNode * next = node->next;
-            core_arena_reclaim_memory(arena, node);
-            node = next;
+    if(retired > 0) {
+        const unsigned long epoch = map->epoch;
+        CORE_ATOMIC_STORE(&map->epoch, epoch + 1);
+        CORE_ATOMIC_FENCE_SEQ_CST();
+        for(i = 0; i < CORE_CONCURRENT_HASHMAP_READER_SLOTS; ++i) {
+            while(CORE_ATOMIC_LOAD(&map->reader_slots[i].count[epoch & 1]) != 0) sched_yield();
         }
     }
-    core_arena_reclaim_memory(arena, buckets->items);
-    
-    /*update buckets reference to use the newly resized array*/
-    *buckets = new;
+    for(i = 0; i < map->segment_count; ++i) {
+        core_ConcurrentHashmapSegment * segment = &map->segments[i];
+        for(j = 0; j < segment->retired_len; ++j) free(segment->retired[j]);
+        segment->retired_len = 0;
+        pthread_mutex_unlock(&segment->mutex);
+    }
 }
 #else
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
-#define core_Hashmap(T) struct { core_Vec(T) values; core_HashmapKeys keys; core_HashmapBuckets buckets; long index; }
-
-#define core_hashmap_get(self, key)                                                        \
-    (                                                                                        \
-        core_hashmap_get_index(&(self)->buckets, &(self)->keys, &(self)->index, key)       \
-        ? (&(self)->values.items[(self)->index]) : NULL                                      \
-    )
+/*no other thread may be using the map*/
+void core_concurrent_hashmap_free(core_ConcurrentHashmap * map)
+#ifdef CORE_IMPLEMENTATION
+{
+    unsigned long i;
+    long j;
+    core_concurrent_hashmap_reclaim(map);
+    for(i = 0; i < map->segment_count; ++i) {
+        core_ConcurrentHashmapSegment * segment = &map->segments[i];
+        core_ConcurrentHashmapTable * table = segment->table;
+        for(j = 0; table != NULL && j < table->cap; ++j) {
+            if(table->ctrl[j] != CORE_HASHMAP_CTRL_EMPTY) free((void *)(size_t)table->entries[j].key);
+        }
+        free(table);
+        free(segment->retired);
+        pthread_mutex_destroy(&segment->mutex);
+    }
+    free(map->segments);
+    free(map->reader_slots);
+    memset(map, 0, sizeof(*map));
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
 
-#define core_hashmap_set(self, arena, key, value) do {                                              \
-    if(core_hashmap_get(self, key)) {                                                               \
-        (self)->values.items[(self)->index] = value;                                                  \
-    } else {                                                                                          \
-        core_hashmap_record_new_key(&(self)->buckets, arena, &(self)->keys, key, (self)->keys.len); \
-        core_vec_append(&(self)->values, arena, value);                                               \
-        core_vec_append(&(self)->keys, arena, core_arena_strdup(arena, key));                         \
-        assert((self)->values.len == (self)->keys.len);                                               \
-    }                                                                                                 \
-} while (0)
+#endif /*defined(CORE_THREADS_AVAILABLE) && defined(CORE_ATOMICS_AVAILABLE)*/
 
 
 
@@ -1670,7 +4356,11 @@ core_Sexpr core_sexpr_nil(void) {
 core_Sexpr * core_sexpr_alloc(core_Arena * arena)
 #ifdef CORE_IMPLEMENTATION
 {
-    core_Sexpr * result = core_arena_alloc(arena, sizeof(core_Sexpr));
+    core_Pool * pool = core_arena_pool(arena, sizeof(core_Sexpr));
+    core_Sexpr * result = pool != NULL ? core_pool_alloc(pool) : NULL;
+    if(result == NULL) {
+        CORE_FATAL_ERROR("Failed to allocate a sexpr");
+    }
     result->tag = CORE_SEXPR_NIL;
     return result;
 }
@@ -1837,42 +4527,43 @@ core_Bool core_sexpr_read_number(core_Arena * a, FILE * fp, core_Sexpr * out, FI
     }
 }
 
+/*the string is collected in a scratch arena and only its final copy goes into a*/
 core_Bool core_sexpr_read_string(core_Arena * a, FILE * fp, core_Sexpr * out, FILE * err) {
-    char buf[4096];
-    int sz = sizeof(buf) - 2;
-    int i = 0;
+    core_ArenaScratch scratch = core_arena_scratch_begin(a);
+    core_Vec(char) buf = {0};
     core_Bool esc = CORE_FALSE;
-    char ch;
+    int ch;
     assert(core_peek(fp) == '"');
     fgetc(fp); /*SKIP OPEN PARENS*/
-    for(;i < sz;ch = (char)fgetc(fp)) {
+    for(ch = fgetc(fp); ch != EOF; ch = fgetc(fp)) {
         if(esc) {
             esc = CORE_FALSE;
             switch(ch) {
-            case 'n': buf[i] = '\n'; break;
-            case '"': buf[i] = '"'; break;
-            case '\\': buf[i] = '\\'; break;
+            case 'n': ch = '\n'; break;
+            case '"': break;
+            case '\\': break;
             default:
+                core_arena_scratch_end(scratch);
                 return core_sexpr_error(
                     err, fp, __FILE__, __LINE__,
                     "Unexpected escape character in string: %c\n", ch);
-                    
-            }
-            buf[i+1] = 0;
-        } else {
-            if(ch == '"') {
-                out->tag = CORE_SEXPR_STR;
-                out->str.v = core_arena_strdup(a, buf);
-                return CORE_TRUE;
-            } else if(ch == '\\') {
-                esc = CORE_TRUE;
-            } else {
-                buf[i] = ch;
-                buf[i+1] = 0;
             }
+        } else if(ch == '"') {
+            core_vec_append(&buf, scratch.arena, '\0');
+            out->tag = CORE_SEXPR_STR;
+            out->str.v = core_arena_strdup(a, buf.items);
+            core_arena_scratch_end(scratch);
+            return CORE_TRUE;
+        } else if(ch == '\\') {
+            esc = CORE_TRUE;
+            continue;
         }
+        core_vec_append(&buf, scratch.arena, (char)ch);
     }
-    return CORE_TRUE;
+    core_arena_scratch_end(scratch);
+    return core_sexpr_error(
+        err, fp, __FILE__, __LINE__,
+        "Unterminated string");
 }
 
 core_Bool core_sexpr_read_ex(core_Arena * a, FILE * fp, core_Sexpr * out, FILE * err);
@@ -1914,14 +4605,16 @@ core_Bool core_sexpr_read_cons(core_Arena * a, FILE * fp, core_Sexpr * out, FILE
 
 
 core_Bool core_sexpr_read_symbol(core_Arena * a, FILE * fp, core_Sexpr * out, FILE * err) {
-    char buf[512];
-    int sz = sizeof(buf) - 2;
-    int i = 0;
+    core_ArenaScratch scratch = core_arena_scratch_begin(a);
+    core_Vec(char) buf = {0};
     (void)err;
-    for(;i < sz && core_issymbol(core_peek(fp));
-        buf[i] = (char)(fgetc(fp)), buf[i+1]=0,++i);
+    while(core_issymbol(core_peek(fp))) {
+        core_vec_append(&buf, scratch.arena, (char)fgetc(fp));
+    }
+    core_vec_append(&buf, scratch.arena, '\0');
     out->tag = CORE_SEXPR_SYM;
-    out->sym.v = core_arena_strdup(a, buf);
+    out->sym.v = core_arena_strdup(a, buf.items);
+    core_arena_scratch_end(scratch);
     return CORE_TRUE;
 }
 #endif /*CORE_IMPLEMENTATION*/
@@ -1957,7 +4650,7 @@ core_Bool core_sexpr_read_ex(core_Arena * a, FILE * fp, core_Sexpr * out, FILE *
 core_Sexpr * core_sexpr_read(core_Arena * a, const char * filename)
 #ifdef CORE_IMPLEMENTATION
 {
-    core_Sexpr * result = core_arena_alloc(a, sizeof(core_Sexpr));
+    core_Sexpr * result = core_sexpr_alloc(a);
     core_Sexpr * next;
     FILE * fp;
     *result = core_sexpr_cons_alloc(a);
@@ -2164,7 +4857,9 @@ int core_compare_string(const void * lhs, const void * rhs)
 int core_compare_int(const void * lhs, const void * rhs)
 #ifdef CORE_IMPLEMENTATION
 {
-    return *(const int *)lhs < *(const int *)rhs;
+    const int a = *(const int *)lhs;
+    const int b = *(const int *)rhs;
+    return (a > b) - (a < b);
 }
 #else
 ;
@@ -2185,10 +4880,44 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define ANSI_RED CORE_ANSI_RED
 #   define ANSI_RESET CORE_ANSI_RESET
 #   define ANSI_YELLOW CORE_ANSI_YELLOW
+#   define ARENA_ALIGNMENT CORE_ARENA_ALIGNMENT
+#   define ARENA_ALIGN_UP CORE_ARENA_ALIGN_UP
+#   define ARENA_ALLOCATION CORE_ARENA_ALLOCATION
+#   define ARENA_CALLSITES_MAX CORE_ARENA_CALLSITES_MAX
+#   define ARENA_CHUNK_DATA CORE_ARENA_CHUNK_DATA
+#   define ARENA_CHUNK_HEADER_SIZE CORE_ARENA_CHUNK_HEADER_SIZE
+#   define ARENA_CHUNK_SIZE CORE_ARENA_CHUNK_SIZE
+#   define ARENA_CHUNK_SIZE_MAX CORE_ARENA_CHUNK_SIZE_MAX
+#   define ARENA_DEBUG CORE_ARENA_DEBUG
+#   define ARENA_EXACT_CLASSES CORE_ARENA_EXACT_CLASSES
+#   define ARENA_EXACT_CLASS_MAX CORE_ARENA_EXACT_CLASS_MAX
+#   define ARENA_FREE_LIST_NEXT CORE_ARENA_FREE_LIST_NEXT
+#   define ARENA_HEADER_SIZE CORE_ARENA_HEADER_SIZE
+#   define ARENA_HISTOGRAM_BUCKETS CORE_ARENA_HISTOGRAM_BUCKETS
+#   define ARENA_HUGE_PAGE_SIZE CORE_ARENA_HUGE_PAGE_SIZE
+#   define ARENA_LARGE_CHUNK CORE_ARENA_LARGE_CHUNK
+#   define ARENA_OVERFLOW_CHAIN CORE_ARENA_OVERFLOW_CHAIN
+#   define ARENA_OVERFLOW_FAIL CORE_ARENA_OVERFLOW_FAIL
+#   define ARENA_SCRATCH_COUNT CORE_ARENA_SCRATCH_COUNT
+#   define ARENA_SIZE_CLASSES CORE_ARENA_SIZE_CLASSES
+#   define ARENA_STATS CORE_ARENA_STATS
+#   define ARENA_VIRTUAL_COMMIT_SIZE CORE_ARENA_VIRTUAL_COMMIT_SIZE
+#   define ARENA_VIRTUAL_HUGE_PAGES CORE_ARENA_VIRTUAL_HUGE_PAGES
 #   define ARRAY_LEN CORE_ARRAY_LEN
+#   define ATOMICS_AVAILABLE CORE_ATOMICS_AVAILABLE
+#   define ATOMIC_CAS CORE_ATOMIC_CAS
+#   define ATOMIC_FENCE_ACQUIRE CORE_ATOMIC_FENCE_ACQUIRE
+#   define ATOMIC_FENCE_RELEASE CORE_ATOMIC_FENCE_RELEASE
+#   define ATOMIC_FENCE_SEQ_CST CORE_ATOMIC_FENCE_SEQ_CST
+#   define ATOMIC_FETCH_ADD CORE_ATOMIC_FETCH_ADD
+#   define ATOMIC_LOAD CORE_ATOMIC_LOAD
+#   define ATOMIC_LOAD_RELAXED CORE_ATOMIC_LOAD_RELAXED
+#   define ATOMIC_STORE CORE_ATOMIC_STORE
+#   define ATOMIC_STORE_RELAXED CORE_ATOMIC_STORE_RELAXED
 #   define ATTRIBUTES_AVAILABLE CORE_ATTRIBUTES_AVAILABLE
 #   define BITARRAY CORE_BITARRAY
 #   define BITSET_SET CORE_BITSET_SET
+#   define CACHE_LINE_SIZE CORE_CACHE_LINE_SIZE
 #   define CLANG CORE_CLANG
 #   define CONCAT CORE_CONCAT
 #   define CONCAT1 CORE_CONCAT1
@@ -2200,6 +4929,12 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define CONCAT7 CORE_CONCAT7
 #   define CONCAT8 CORE_CONCAT8
 #   define CONCAT9 CORE_CONCAT9
+#   define CONCURRENT_ARENA_CACHE_SLOTS CORE_CONCURRENT_ARENA_CACHE_SLOTS
+#   define CONCURRENT_HASHMAP_READER_SLOTS CORE_CONCURRENT_HASHMAP_READER_SLOTS
+#   define CONCURRENT_HASHMAP_SEGMENT CORE_CONCURRENT_HASHMAP_SEGMENT
+#   define CONCURRENT_HASHMAP_SEGMENTS CORE_CONCURRENT_HASHMAP_SEGMENTS
+#   define CONCURRENT_HASHMAP_STACK_VALUE CORE_CONCURRENT_HASHMAP_STACK_VALUE
+#   define COPY_ITEM CORE_COPY_ITEM
 #   define DEFER CORE_DEFER
 #   define DEFERRED CORE_DEFERRED
 #   define DEFINE_SCALAR_SERIALIZER CORE_DEFINE_SCALAR_SERIALIZER
@@ -2210,6 +4945,11 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define ERR CORE_ERR
 #   define FATAL_ERROR CORE_FATAL_ERROR
 #   define GLIBC CORE_GLIBC
+#   define HASHMAP_CTRL CORE_HASHMAP_CTRL
+#   define HASHMAP_CTRL_EMPTY CORE_HASHMAP_CTRL_EMPTY
+#   define HASHMAP_MIGRATE_STEP CORE_HASHMAP_MIGRATE_STEP
+#   define HASHMAP_MIGRATING CORE_HASHMAP_MIGRATING
+#   define HASHMAP_MIN_CAP CORE_HASHMAP_MIN_CAP
 #   define LIKELY_FALSE CORE_LIKELY_FALSE
 #   define LIKELY_TRUE CORE_LIKELY_TRUE
 #   define LOG CORE_LOG
@@ -2224,6 +4964,10 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define NORETURN CORE_NORETURN
 #   define OK CORE_OK
 #   define ON_EXIT_MAX_FUNCTIONS CORE_ON_EXIT_MAX_FUNCTIONS
+#   define PARALLEL_GRAIN CORE_PARALLEL_GRAIN
+#   define POOL_ALIGNMENT CORE_POOL_ALIGNMENT
+#   define POOL_SLAB_OBJECTS CORE_POOL_SLAB_OBJECTS
+#   define POOL_SLAB_OBJECTS_MAX CORE_POOL_SLAB_OBJECTS_MAX
 #   define SEXPR CORE_SEXPR
 #   define SEXPR_CONS CORE_SEXPR_CONS
 #   define SEXPR_INIT_FN CORE_SEXPR_INIT_FN
@@ -2239,11 +4983,23 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define STDC_C23 CORE_STDC_C23
 #   define STDC_C99 CORE_STDC_C99
 #   define SYMBOL_MAX_LEN CORE_SYMBOL_MAX_LEN
+#   define THREADS_AVAILABLE CORE_THREADS_AVAILABLE
+#   define THREAD_LOCAL CORE_THREAD_LOCAL
 #   define TODO CORE_TODO
 #   define UNREACHABLE CORE_UNREACHABLE
 #   define VAARG_FIRST CORE_VAARG_FIRST
+#   define VEC_LEN_MAX CORE_VEC_LEN_MAX
+#   define VEC_SIZE_T CORE_VEC_SIZE_T
+#   define AddFunction core_AddFunction
 #   define Allocation core_Allocation
 #   define Arena core_Arena
+#   define ArenaAllocator core_ArenaAllocator
+#   define ArenaCallsite core_ArenaCallsite
+#   define ArenaChunk core_ArenaChunk
+#   define ArenaMark core_ArenaMark
+#   define ArenaOverflow core_ArenaOverflow
+#   define ArenaScratch core_ArenaScratch
+#   define ArenaStats core_ArenaStats
 #   define BitArray1024 core_BitArray1024
 #   define BitArray128 core_BitArray128
 #   define BitArray16 core_BitArray16
@@ -2257,30 +5013,123 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define BitArray8192 core_BitArray8192
 #   define BitVec core_BitVec
 #   define Bool core_Bool
+#   define CompareFunction core_CompareFunction
+#   define ConcurrentArena core_ConcurrentArena
+#   define ConcurrentArenaCache core_ConcurrentArenaCache
+#   define ConcurrentHashmap core_ConcurrentHashmap
+#   define ConcurrentHashmapEntry core_ConcurrentHashmapEntry
+#   define ConcurrentHashmapReaderSlot core_ConcurrentHashmapReaderSlot
+#   define ConcurrentHashmapSegment core_ConcurrentHashmapSegment
+#   define ConcurrentHashmapTable core_ConcurrentHashmapTable
 #   define Hashmap core_Hashmap
 #   define HashmapBuckets core_HashmapBuckets
 #   define HashmapKeys core_HashmapKeys
 #   define HashmapNode core_HashmapNode
+#   define HashmapSlot core_HashmapSlot
+#   define HashmapTable core_HashmapTable
 #   define IntVec core_IntVec
 #   define List core_List
+#   define ParallelPrefixSum core_ParallelPrefixSum
+#   define ParallelSort core_ParallelSort
+#   define Pool core_Pool
 #   define SNPrintfParameters core_SNPrintfParameters
 #   define Sexpr core_Sexpr
 #   define Slice core_Slice
+#   define SliceLen core_SliceLen
+#   define SmallVec core_SmallVec
 #   define StrVec core_StrVec
 #   define Symbol core_Symbol
 #   define Symbols core_Symbols
+#   define ThreadPool core_ThreadPool
+#   define ThreadPoolTask core_ThreadPoolTask
 #   define Time core_Time
 #   define Vec core_Vec
+#   define VecLen core_VecLen
+#   define add_int core_add_int
+#   define add_long core_add_long
 #   define arena_alloc core_arena_alloc
+#   define arena_alloc_aligned core_arena_alloc_aligned
+#   define arena_alloc_at core_arena_alloc_at
+#   define arena_alloc_cacheline core_arena_alloc_cacheline
+#   define arena_alloc_class core_arena_alloc_class
+#   define arena_alloc_large core_arena_alloc_large
+#   define arena_alloc_large_aligned core_arena_alloc_large_aligned
+#   define arena_alloc_slow core_arena_alloc_slow
 #   define arena_allocation_new core_arena_allocation_new
+#   define arena_callsite_record core_arena_callsite_record
+#   define arena_capacity core_arena_capacity
+#   define arena_check_alloc core_arena_check_alloc
+#   define arena_check_initialized core_arena_check_initialized
+#   define arena_chunk_alloc core_arena_chunk_alloc
+#   define arena_chunk_alloc_from core_arena_chunk_alloc_from
+#   define arena_chunk_new core_arena_chunk_new
+#   define arena_chunk_release core_arena_chunk_release
 #   define arena_free core_arena_free
+#   define arena_free_class core_arena_free_class
+#   define arena_init_allocator core_arena_init_allocator
+#   define arena_init_buffer core_arena_init_buffer
+#   define arena_init_virtual core_arena_init_virtual
+#   define arena_is_large core_arena_is_large
+#   define arena_mark core_arena_mark
+#   define arena_new_aligned core_arena_new_aligned
+#   define arena_new_array core_arena_new_array
+#   define arena_new_simd16 core_arena_new_simd16
+#   define arena_new_simd32 core_arena_new_simd32
+#   define arena_new_simd64 core_arena_new_simd64
+#   define arena_pool core_arena_pool
+#   define arena_push_chunk core_arena_push_chunk
 #   define arena_realloc core_arena_realloc
+#   define arena_realloc_at core_arena_realloc_at
+#   define arena_realloc_large core_arena_realloc_large
 #   define arena_reclaim_memory core_arena_reclaim_memory
+#   define arena_reset core_arena_reset
+#   define arena_reuse_class core_arena_reuse_class
+#   define arena_rewind core_arena_rewind
+#   define arena_scratch core_arena_scratch
+#   define arena_scratch_begin core_arena_scratch_begin
+#   define arena_scratch_end core_arena_scratch_end
+#   define arena_scratch_free core_arena_scratch_free
+#   define arena_stats_alloc core_arena_stats_alloc
+#   define arena_stats_carve core_arena_stats_carve
+#   define arena_stats_fprint core_arena_stats_fprint
+#   define arena_stats_reserve core_arena_stats_reserve
 #   define arena_strdup core_arena_strdup
+#   define arena_trim core_arena_trim
+#   define arena_virtual_commit core_arena_virtual_commit
+#   define arena_virtual_free core_arena_virtual_free
+#   define arena_virtual_granularity core_arena_virtual_granularity
+#   define arena_virtual_trim core_arena_virtual_trim
 #   define bitarray_set core_bitarray_set
 #   define bitvec_set core_bitvec_set
 #   define compare_int core_compare_int
 #   define compare_string core_compare_string
+#   define concurrent_arena_alloc core_concurrent_arena_alloc
+#   define concurrent_arena_alloc_slow core_concurrent_arena_alloc_slow
+#   define concurrent_arena_cache core_concurrent_arena_cache
+#   define concurrent_arena_free core_concurrent_arena_free
+#   define concurrent_arena_init core_concurrent_arena_init
+#   define concurrent_arena_next_id core_concurrent_arena_next_id
+#   define concurrent_arena_push_chunk core_concurrent_arena_push_chunk
+#   define concurrent_arena_realloc core_concurrent_arena_realloc
+#   define concurrent_arena_strdup core_concurrent_arena_strdup
+#   define concurrent_hashmap_find_slot core_concurrent_hashmap_find_slot
+#   define concurrent_hashmap_free core_concurrent_hashmap_free
+#   define concurrent_hashmap_get core_concurrent_hashmap_get
+#   define concurrent_hashmap_grow core_concurrent_hashmap_grow
+#   define concurrent_hashmap_init core_concurrent_hashmap_init
+#   define concurrent_hashmap_len core_concurrent_hashmap_len
+#   define concurrent_hashmap_load_value core_concurrent_hashmap_load_value
+#   define concurrent_hashmap_next_reader core_concurrent_hashmap_next_reader
+#   define concurrent_hashmap_read_begin core_concurrent_hashmap_read_begin
+#   define concurrent_hashmap_reader core_concurrent_hashmap_reader
+#   define concurrent_hashmap_reclaim core_concurrent_hashmap_reclaim
+#   define concurrent_hashmap_remove core_concurrent_hashmap_remove
+#   define concurrent_hashmap_retire core_concurrent_hashmap_retire
+#   define concurrent_hashmap_set core_concurrent_hashmap_set
+#   define concurrent_hashmap_store_value core_concurrent_hashmap_store_value
+#   define concurrent_hashmap_table_new core_concurrent_hashmap_table_new
+#   define concurrent_hashmap_write_begin core_concurrent_hashmap_write_begin
+#   define concurrent_hashmap_write_end core_concurrent_hashmap_write_end
 #   define double_has_fractional_part core_double_has_fractional_part
 #   define errprint core_errprint
 #   define file_exists core_file_exists
@@ -2291,20 +5140,49 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define file_read_string core_file_read_string
 #   define gensym core_gensym
 #   define hash core_hash
+#   define hash_string core_hash_string
+#   define hashmap_enable_incremental_resize core_hashmap_enable_incremental_resize
+#   define hashmap_erase_slot core_hashmap_erase_slot
+#   define hashmap_find_index_slot core_hashmap_find_index_slot
+#   define hashmap_find_slot core_hashmap_find_slot
 #   define hashmap_get core_hashmap_get
 #   define hashmap_get_index core_hashmap_get_index
+#   define hashmap_get_index_hashed core_hashmap_get_index_hashed
+#   define hashmap_insert_slot core_hashmap_insert_slot
+#   define hashmap_locate core_hashmap_locate
+#   define hashmap_migrate core_hashmap_migrate
 #   define hashmap_needs_resize core_hashmap_needs_resize
+#   define hashmap_record_new_hash core_hashmap_record_new_hash
 #   define hashmap_record_new_key core_hashmap_record_new_key
 #   define hashmap_rehash core_hashmap_rehash
+#   define hashmap_release_old core_hashmap_release_old
+#   define hashmap_remove core_hashmap_remove
+#   define hashmap_remove_index core_hashmap_remove_index
 #   define hashmap_set core_hashmap_set
 #   define isidentifier core_isidentifier
 #   define issymbol core_issymbol
 #   define itoa core_itoa
 #   define list_push core_list_push
+#   define log2_floor core_log2_floor
+#   define merge core_merge
+#   define merge_sort core_merge_sort
+#   define merge_split core_merge_split
 #   define on_exit_ctx core_on_exit_ctx
 #   define on_exit_fn_count core_on_exit_fn_count
 #   define on_exit_fns core_on_exit_fns
+#   define parallel_prefix_sum core_parallel_prefix_sum
+#   define parallel_prefix_sum_block_scan core_parallel_prefix_sum_block_scan
+#   define parallel_prefix_sum_block_total core_parallel_prefix_sum_block_total
+#   define parallel_sort core_parallel_sort
+#   define parallel_sort_copy_back core_parallel_sort_copy_back
+#   define parallel_sort_merge core_parallel_sort_merge
+#   define parallel_sort_runs core_parallel_sort_runs
+#   define parallel_split core_parallel_split
 #   define peek core_peek
+#   define pool_alloc core_pool_alloc
+#   define pool_free core_pool_free
+#   define pool_init core_pool_init
+#   define pool_new core_pool_new
 #   define print_backtrace core_print_backtrace
 #   define profiler_deinit core_profiler_deinit
 #   define profiler_init core_profiler_init
@@ -2360,6 +5238,12 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define sexpr_vfformat core_sexpr_vfformat
 #   define skip_comments core_skip_comments
 #   define skip_whitespace core_skip_whitespace
+#   define smallvec_append core_smallvec_append
+#   define smallvec_capacity core_smallvec_capacity
+#   define smallvec_is_inline core_smallvec_is_inline
+#   define smallvec_items core_smallvec_items
+#   define smallvec_pop core_smallvec_pop
+#   define smallvec_reserve core_smallvec_reserve
 #   define snprintf_exec_parameters core_snprintf_exec_parameters
 #   define snprintf_state core_snprintf_state
 #   define snprintf_state_base core_snprintf_state_base
@@ -2381,6 +5265,12 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define strnfmt core_strnfmt
 #   define symbol_get core_symbol_get
 #   define symbol_intern core_symbol_intern
+#   define thread_pool_drain core_thread_pool_drain
+#   define thread_pool_free core_thread_pool_free
+#   define thread_pool_init core_thread_pool_init
+#   define thread_pool_run core_thread_pool_run
+#   define thread_pool_thread_count core_thread_pool_thread_count
+#   define thread_pool_worker core_thread_pool_worker
 #   define trash core_trash
 #   define trash_dir_create core_trash_dir_create
 #   define trash_dir_path core_trash_dir_path
@@ -2389,6 +5279,18 @@ int core_compare_int(const void * lhs, const void * rhs)
 #   define vec_append_unique core_vec_append_unique
 #   define vec_append_unique_skip core_vec_append_unique_skip
 #   define vec_copy_items core_vec_copy_items
+#   define vec_extend core_vec_extend
+#   define vec_grow core_vec_grow
+#   define vec_init_aligned core_vec_init_aligned
+#   define vec_insert_n core_vec_insert_n
+#   define vec_len_add core_vec_len_add
+#   define vec_next_capacity core_vec_next_capacity
+#   define vec_parallel_prefix_sum core_vec_parallel_prefix_sum
+#   define vec_parallel_sort core_vec_parallel_sort
+#   define vec_remove_range core_vec_remove_range
+#   define vec_reserve core_vec_reserve
+#   define vec_resize core_vec_resize
+#   define vec_swap_remove core_vec_swap_remove
 #   define xdg_data_home core_xdg_data_home
 #endif /*CORE_STRIP_PREFIX*/
 #ifdef CORE_SEXPR_STRIP_PREFIX
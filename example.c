@@ -1,6 +1,228 @@
 #define CORE_IMPLEMENTATION
+#define CORE_ARENA_DEBUG
 #include "core.h"
 
+#ifdef STAGE_1
+#include "staged.h"
+
+/*the first stage writes the staged containers tested below to autogenerated.c*/
+int main(void) {
+    const char * particle_types[] = {"int", "long", "double"};
+    const char * particle_names[] = {"id", "weight", "x"};
+    FILE * out = fopen("autogenerated.c", "w");
+    if(out == NULL) {
+        CORE_FATAL_ERROR("Failed to open autogenerated.c");
+    }
+    core_staged_vec_generate(out, "", "int");
+    core_staged_sort_generate(out, "", "int", NULL);
+    core_staged_radix_sort_generate(out, "", "int", CORE_TRUE);
+    core_staged_sort_generate(out, "", "long", "LONG_GREATER");
+    core_staged_vec_numeric_generate(out, "", "int");
+    core_staged_vec_generate(out, "", "double");
+    core_staged_vec_numeric_generate(out, "", "double");
+    core_staged_smallvec_generate(out, "", "int", 4);
+    core_staged_slice_generate(out, "", "int");
+    core_staged_slice_generate(out, "", "long");
+    core_staged_soa_generate(out, "", "particle", 3, particle_types, particle_names);
+    core_staged_deque_generate(out, "", "int");
+    core_staged_sort_generate(out, "", "Pair", "PAIR_KEY_LESS");
+    core_staged_parallel_sort_generate(out, "", "Pair");
+    core_staged_parallel_prefix_sum_generate(out, "", "double");
+    core_staged_parallel_prefix_sum_generate(out, "", "int");
+    core_staged_hashmap_generate(out, "", "int", "int", NULL, NULL);
+    core_staged_hashmap_generate(out, "", "Pair", "double", "PAIR_KEY_HASH", "PAIR_EQ");
+    fclose(out);
+    return 0;
+}
+#else
+#if defined(CORE_UNIX)
+#include <sys/wait.h>
+#endif /*CORE_UNIX*/
+
+typedef struct {
+    int key;
+    int index;
+} Pair;
+
+#define LONG_GREATER(a, b) ((a) > (b))
+#define PAIR_KEY_LESS(a, b) ((a).key < (b).key)
+/*pairs with the same key collide on purpose so the map has to fall back to PAIR_EQ*/
+#define PAIR_KEY_HASH(p) ((p).key)
+#define PAIR_EQ(a, b) ((a).key == (b).key && (a).index == (b).index)
+#include "autogenerated.c"
+
+static int compare_pair_key(const void * lhs, const void * rhs) {
+    return core_compare_int(&((const Pair *)lhs)->key, &((const Pair *)rhs)->key);
+}
+
+/*ties broken by original position, which is the order a stable sort keeps*/
+static int compare_pair_key_index(const void * lhs, const void * rhs) {
+    const int result = compare_pair_key(lhs, rhs);
+    return result != 0 ? result : core_compare_int(&((const Pair *)lhs)->index, &((const Pair *)rhs)->index);
+}
+
+static void add_double(void * acc, const void * item) {
+    *(double *)acc += *(const double *)item;
+}
+
+typedef struct {
+    long allocs;
+    long frees;
+    size_t live;
+} CountingAllocator;
+
+static void * counting_alloc(void * ctx, size_t bytes) {
+    CountingAllocator * counter = ctx;
+    ++counter->allocs;
+    counter->live += bytes;
+    return malloc(bytes);
+}
+
+static void counting_free(void * ctx, void * ptr, size_t bytes) {
+    CountingAllocator * counter = ctx;
+    ++counter->frees;
+    counter->live -= bytes;
+    free(ptr);
+}
+
+#ifdef CORE_THREADS_AVAILABLE
+#define ARENA_THREADS 4
+#define ARENA_THREAD_ALLOCS 2000
+
+typedef struct {
+    core_ConcurrentArena * arena;
+    unsigned char id;
+    unsigned char * ptrs[ARENA_THREAD_ALLOCS];
+} ArenaWorker;
+
+static size_t arena_worker_len(int i) {
+    /*every 64th block is big enough to get a chunk of its own*/
+    return (size_t)(i % 64 == 0 ? 20000 : 1 + i % 200);
+}
+
+static void * arena_worker(void * arg) {
+    ArenaWorker * w = arg;
+    int i;
+    for(i = 0; i < ARENA_THREAD_ALLOCS; ++i) {
+        w->ptrs[i] = core_concurrent_arena_alloc(w->arena, arena_worker_len(i));
+        memset(w->ptrs[i], w->id, arena_worker_len(i));
+    }
+    return NULL;
+}
+#endif /*CORE_THREADS_AVAILABLE*/
+
+#ifdef CORE_THREADS_AVAILABLE
+#define SCRATCH_TASKS 4
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t all_started;
+    int started;
+    long sums[SCRATCH_TASKS];
+} ScratchTasks;
+
+/*every task waits for the others to start, so each pool thread runs exactly one
+  and fills its own scratch arena*/
+static void scratch_task(void * ctx, unsigned long index) {
+    ScratchTasks * tasks = ctx;
+    core_ArenaScratch scratch = core_arena_scratch_begin(NULL);
+    core_Vec(long) vec = {0};
+    long sum = 0;
+    int i;
+
+    pthread_mutex_lock(&tasks->mutex);
+    if(++tasks->started == SCRATCH_TASKS) pthread_cond_broadcast(&tasks->all_started);
+    while(tasks->started < SCRATCH_TASKS) pthread_cond_wait(&tasks->all_started, &tasks->mutex);
+    pthread_mutex_unlock(&tasks->mutex);
+
+    for(i = 0; i < 1000 * ((int)index + 1); ++i) core_vec_append(&vec, scratch.arena, (long)i);
+    for(i = 0; i < vec.len; ++i) sum += vec.items[i];
+    tasks->sums[index] = sum;
+    core_arena_scratch_end(scratch);
+}
+#endif /*CORE_THREADS_AVAILABLE*/
+
+#if defined(CORE_THREADS_AVAILABLE) && defined(CORE_ATOMICS_AVAILABLE)
+#define MAP_WRITERS 4
+#define MAP_READERS 4
+#define MAP_WRITER_KEYS 2000
+#define MAP_WRITER_OPS 40000
+
+/*check ties serial to id, so a value mixing two writes to the same key fails it*/
+typedef struct {
+    long id;
+    long serial;
+    long check;
+} MapValue;
+
+typedef struct {
+    core_ConcurrentHashmap * map;
+    int * writers_done;
+    long id;
+    unsigned long rng;
+    long found;
+    /*serial of the writer's last set of each key, -1 once removed*/
+    long reference[MAP_WRITER_KEYS];
+} MapWorker;
+
+static unsigned long map_worker_next(MapWorker * w) {
+    w->rng = w->rng * 6364136223846793005UL + 1442695040888963407UL;
+    return w->rng >> 24;
+}
+
+static void * map_writer(void * arg) {
+    MapWorker * w = arg;
+    char key[32];
+    long serial;
+    for(serial = 0; serial < MAP_WRITER_KEYS; ++serial) w->reference[serial] = -1;
+    for(serial = 0; serial < MAP_WRITER_OPS; ++serial) {
+        const unsigned long r = map_worker_next(w);
+        const long k = (long)(r % MAP_WRITER_KEYS);
+        sprintf(key, "w%ld_k%ld", w->id, k);
+        if((r >> 16) % 4 != 0) {
+            MapValue value;
+            value.id = w->id * MAP_WRITER_KEYS + k;
+            value.serial = serial;
+            value.check = ~(value.id ^ serial);
+            core_concurrent_hashmap_set(w->map, key, &value);
+            w->reference[k] = serial;
+        } else {
+            assert(core_concurrent_hashmap_remove(w->map, key) == (w->reference[k] >= 0));
+            w->reference[k] = -1;
+        }
+    }
+    return NULL;
+}
+
+/*reader 0 also frees retired memory while the others are still reading*/
+static void * map_reader(void * arg) {
+    MapWorker * w = arg;
+    char key[32];
+    long reads = 0;
+    while(!CORE_ATOMIC_LOAD(w->writers_done)) {
+        const unsigned long r = map_worker_next(w);
+        const long writer = (long)(r % MAP_WRITERS);
+        const long k = (long)((r >> 8) % MAP_WRITER_KEYS);
+        MapValue value;
+        value.id = value.serial = value.check = -1;
+        sprintf(key, "w%ld_k%ld", writer, k);
+        if(core_concurrent_hashmap_get(w->map, key, &value)) {
+            assert(value.id == writer * MAP_WRITER_KEYS + k);
+            assert(value.serial >= 0 && value.serial < MAP_WRITER_OPS);
+            assert(value.check == ~(value.id ^ value.serial));
+            w->found++;
+            value.id = value.serial = value.check = -1;
+        }
+        /*a miss never leaves behind the copy of an attempt that raced a writer*/
+        assert(value.id == -1 && value.serial == -1 && value.check == -1);
+        assert(!core_concurrent_hashmap_get(w->map, "missing", &value));
+        assert(value.id == -1 && value.serial == -1 && value.check == -1);
+        if(w->id == 0 && ++reads % 512 == 0) core_concurrent_hashmap_reclaim(w->map);
+    }
+    return NULL;
+}
+#endif /*defined(CORE_THREADS_AVAILABLE) && defined(CORE_ATOMICS_AVAILABLE)*/
+
 int main(void) {
     /*hashmap*/
     core_Hashmap(int) hm = {0};
@@ -61,6 +283,45 @@ int main(void) {
         core_arena_free(&arena);
     }
 
+    /*arena marks and scratch arenas*/
+    {
+        core_Arena arena = {0};
+        core_ArenaMark mark;
+        core_ArenaScratch scratch;
+        char * kept = core_arena_strdup(&arena, "kept");
+
+        mark = core_arena_mark(&arena);
+        for(i = 0; i < 1000; ++i) {
+            char * tmp = core_arena_alloc(&arena, 64);
+            tmp[0] = 0;
+        }
+        core_arena_rewind(&arena, mark);
+        assert(core_streql(kept, "kept"));
+
+        scratch = core_arena_scratch_begin(&arena);
+        assert(scratch.arena != &arena);
+        (void)core_arena_strdup(scratch.arena, "temporary");
+        core_arena_scratch_end(scratch);
+
+        core_arena_free(&arena);
+        core_arena_scratch_free();
+    }
+
+    /*reclaimed blocks are reused by requests of their size class*/
+    {
+        core_Arena arena = {0};
+        char * exact = core_arena_alloc(&arena, 48);
+        char * mid = core_arena_alloc(&arena, 2000);
+        char * top = core_arena_alloc(&arena, 16);
+
+        core_arena_reclaim_memory(&arena, exact);
+        core_arena_reclaim_memory(&arena, mid);
+        assert(core_arena_alloc(&arena, 40) == exact);
+        assert(core_arena_alloc(&arena, 1040) == mid);
+        assert(core_arena_alloc(&arena, 16) != top);
+        core_arena_free(&arena);
+    }
+
     {
         core_Arena arena = {0};
         core_Sexpr * s = core_sexpr_read(&arena, "./data.sexpr");
@@ -72,6 +333,998 @@ int main(void) {
 
     }
 
+    /*strings and symbols longer than any fixed buffer are read through the scratch arenas*/
+    {
+        core_Arena arena = {0};
+        core_Sexpr * s;
+        FILE * fp = fopen("example_long.sexpr", "w");
+        assert(fp);
+        fputc('"', fp);
+        for(i = 0; i < 10000; ++i) fputc('a' + i % 26, fp);
+        fputs("\\\"\" ", fp);
+        for(i = 0; i < 1000; ++i) fputc('s', fp);
+        fclose(fp);
+
+        s = core_sexpr_read(&arena, "example_long.sexpr");
+        assert(s);
+        assert(strlen(core_sexpr_car(s)->str.v) == 10001);
+        assert(core_sexpr_car(s)->str.v[10000] == '"');
+        assert(strlen(core_sexpr_nth(s, 2)->sym.v) == 1000);
+        remove("example_long.sexpr");
+        core_arena_free(&arena);
+        core_arena_scratch_free();
+    }
+
+    /*the most recent allocation grows in place, so vec appends stop copying*/
+    {
+        core_Arena arena = {0};
+        core_Vec(int) vec = {0};
+        char * p = core_arena_alloc(&arena, 64);
+        int * first;
+
+        memset(p, 'x', 64);
+        assert(core_arena_realloc(&arena, p, 1024) == p);
+        assert(p[63] == 'x');
+
+        core_vec_append(&vec, &arena, 0);
+        first = vec.items;
+        for(i = 1; i < 1000; ++i) core_vec_append(&vec, &arena, i);
+        assert(vec.items == first);
+        for(i = 0; i < 1000; ++i) assert(vec.items[i] == i);
+        core_arena_free(&arena);
+    }
+
+    /*blocks from before a mark are moved rather than grown in place, so a rewind never leaves
+      a block stretched over memory it hands out again*/
+    {
+        core_Arena arena = {0};
+        core_ArenaMark mark;
+        char * p = core_arena_alloc(&arena, 16);
+        char * grown;
+        char * q;
+
+        memset(p, 'p', 16);
+        mark = core_arena_mark(&arena);
+        grown = core_arena_realloc(&arena, p, 4096);
+        assert(grown != p && grown[15] == 'p' && core_arena_capacity(grown) >= 4096);
+        assert(core_arena_realloc(&arena, grown, 8192) == grown);
+        core_arena_rewind(&arena, mark);
+        q = core_arena_alloc(&arena, 64);
+        assert(CORE_ARENA_ALLOCATION(p)->len == 16 && q >= p + 16);
+
+        /*the rewind lifts the floor again*/
+        assert(core_arena_realloc(&arena, q, 256) == q);
+        core_arena_free(&arena);
+    }
+
+#ifdef CORE_THREADS_AVAILABLE
+    /*threads allocating from one concurrent arena never hand out overlapping blocks*/
+    {
+        core_ConcurrentArena arena;
+        static ArenaWorker workers[ARENA_THREADS];
+        pthread_t threads[ARENA_THREADS];
+        size_t j;
+        int t;
+
+        core_concurrent_arena_init(&arena);
+        for(t = 0; t < ARENA_THREADS; ++t) {
+            workers[t].arena = &arena;
+            workers[t].id = (unsigned char)(t + 1);
+            if(pthread_create(&threads[t], NULL, arena_worker, &workers[t]) != 0) {
+                CORE_FATAL_ERROR("pthread_create failed");
+            }
+        }
+        for(t = 0; t < ARENA_THREADS; ++t) pthread_join(threads[t], NULL);
+        for(t = 0; t < ARENA_THREADS; ++t) {
+            for(i = 0; i < ARENA_THREAD_ALLOCS; ++i) {
+                for(j = 0; j < arena_worker_len(i); ++j) assert(workers[t].ptrs[i][j] == t + 1);
+            }
+        }
+        core_concurrent_arena_free(&arena);
+    }
+#endif /*CORE_THREADS_AVAILABLE*/
+
+    /*stats only count allocations that succeeded*/
+    {
+        static char buffer[4096];
+        core_Arena arena = {0};
+        unsigned long sites = 0;
+        char * p;
+
+        core_arena_init_buffer(&arena, buffer, sizeof(buffer), CORE_ARENA_OVERFLOW_FAIL, NULL);
+        p = core_arena_alloc(&arena, 100);
+        assert(p != NULL);
+        assert(arena.stats.alloc_count == 1 && arena.stats.bytes_requested == 100);
+        assert(arena.stats.histogram[6] == 1);
+
+        assert(core_arena_alloc(&arena, 8192) == NULL);
+        assert(core_arena_realloc(&arena, p, 8192) == NULL);
+        assert(arena.stats.alloc_count == 1 && arena.stats.bytes_requested == 100);
+        assert(arena.stats.realloc_count == 0);
+        assert(arena.stats.bytes_used == CORE_ARENA_HEADER_SIZE + 112);
+
+        for(i = 0; i < CORE_ARENA_CALLSITES_MAX; ++i) sites += arena.stats.callsites[i].count;
+        assert(sites == 1);
+        core_arena_free(&arena);
+    }
+
+#if defined(CORE_UNIX)
+    /*a virtual arena commits as it grows without moving, and trim drops what reset freed*/
+    {
+        core_Arena arena = {0};
+        char * first;
+        char * prev;
+        char * p;
+        assert(core_arena_init_virtual(&arena, 64 * 1024 * 1024, 0));
+        first = prev = core_arena_alloc(&arena, 100 * 1024);
+        memset(first, 'v', 100 * 1024);
+        for(i = 0; i < 40; ++i) {
+            p = core_arena_alloc(&arena, 100 * 1024);
+            assert(p > prev && p < arena.virtual_base + arena.virtual_reserved);
+            memset(p, 'v', 100 * 1024);
+            prev = p;
+        }
+        assert(arena.head->next == NULL && arena.head->cap > CORE_ARENA_VIRTUAL_COMMIT_SIZE);
+        assert(first[0] == 'v' && prev[100 * 1024 - 1] == 'v');
+        core_arena_reset(&arena);
+        core_arena_trim(&arena);
+        p = core_arena_alloc(&arena, 100 * 1024);
+        assert(p == first && p[100 * 1024 - 1] == 0);
+        core_arena_free(&arena);
+        assert(arena.virtual_base == NULL);
+    }
+#endif /*CORE_UNIX*/
+
+    /*stats count requests by size, reuse and the line that allocated*/
+    {
+        core_Arena arena = {0};
+        unsigned long sites = 0;
+        char * p = core_arena_alloc(&arena, 100);
+        char * q = core_arena_alloc(&arena, 3000);
+
+        assert(arena.stats.alloc_count == 2 && arena.stats.bytes_requested == 3100);
+        assert(arena.stats.histogram[6] == 1 && arena.stats.histogram[11] == 1);
+        assert(arena.stats.bytes_allocated >= 2 * CORE_ARENA_HEADER_SIZE + 3100);
+        assert(arena.stats.bytes_used >= arena.stats.bytes_allocated && arena.stats.peak_used == arena.stats.bytes_used);
+        q = core_arena_realloc(&arena, q, 4000);
+        assert(q != NULL && arena.stats.realloc_count == 1 && arena.stats.realloc_in_place_count == 1);
+        assert(arena.stats.bytes_requested > 3100 && arena.stats.alloc_count == 2);
+        core_arena_reclaim_memory(&arena, p);
+        assert(arena.stats.reclaim_count == 1 && arena.stats.bytes_free_listed == CORE_ARENA_HEADER_SIZE + 112);
+
+        for(i = 0; i < CORE_ARENA_CALLSITES_MAX; ++i) {
+            if(arena.stats.callsites[i].count == 0) continue;
+            assert(core_streql(arena.stats.callsites[i].file, "example.c"));
+            sites += arena.stats.callsites[i].count;
+        }
+        assert(sites == 3 && arena.stats.callsites_dropped == 0);
+        core_arena_free(&arena);
+    }
+
+    /*aligned allocations keep their alignment through realloc*/
+    {
+        core_Arena arena = {0};
+        double * simd = core_arena_new_simd32(&arena, double, 7);
+        char * line = core_arena_alloc_cacheline(&arena, 10);
+        char * big = core_arena_alloc_aligned(&arena, 100000, 4096);
+        char * p = core_arena_alloc_aligned(&arena, 24, 64);
+        char * after;
+        core_Vec(float) vec = {0};
+
+        assert((size_t)simd % 32 == 0);
+        assert((size_t)line % CORE_CACHE_LINE_SIZE == 0 && core_arena_capacity(line) >= CORE_CACHE_LINE_SIZE);
+        assert((size_t)big % 4096 == 0);
+        assert((size_t)p % 64 == 0);
+        memset(p, 'y', 24);
+        after = core_arena_alloc(&arena, 8);
+        assert(after != NULL);
+        p = core_arena_realloc(&arena, p, 512);
+        assert((size_t)p % 64 == 0 && p[23] == 'y');
+        big = core_arena_realloc(&arena, big, 200000);
+        assert((size_t)big % 4096 == 0);
+        core_vec_init_aligned(&vec, &arena, 4, 32);
+        for(i = 0; i < 100; ++i) core_vec_append(&vec, &arena, (float)i);
+        assert((size_t)vec.items % 32 == 0);
+        core_arena_free(&arena);
+    }
+
+    /*pool objects are distinct, freed ones come back first, and pools are shared per size*/
+    {
+        core_Arena arena = {0};
+        core_Pool pool;
+        core_ArenaMark mark;
+        long * objs[200];
+        long * again;
+        core_pool_init(&pool, &arena, sizeof(long) * 3);
+        for(i = 0; i < 200; ++i) {
+            objs[i] = core_pool_new(&pool, long);
+            objs[i][0] = i; objs[i][2] = -i;
+        }
+        assert(pool.slab_objects == CORE_POOL_SLAB_OBJECTS * 4); /*slabs of 64, 128 then 256*/
+        for(i = 0; i < 200; ++i) assert(objs[i][0] == i && objs[i][2] == -i);
+        core_pool_free(&pool, objs[10]);
+        core_pool_free(&pool, objs[20]);
+        again = core_pool_new(&pool, long);
+        assert(again == objs[20]);
+        again = core_pool_new(&pool, long);
+        assert(again == objs[10]);
+        assert((size_t)core_pool_new(&pool, long) % CORE_POOL_ALIGNMENT == 0);
+
+        mark = core_arena_mark(&arena);
+        assert(core_arena_pool(&arena, 21) == core_arena_pool(&arena, 24));
+        assert(core_arena_pool(&arena, 21) != core_arena_pool(&arena, 40));
+        assert(core_arena_pool(&arena, 1)->object_size == sizeof(void *));
+        core_arena_rewind(&arena, mark);
+        assert(arena.pools == NULL);
+        core_arena_free(&arena);
+    }
+
+    /*a pool whose slab cannot be allocated returns NULL and stays usable*/
+    {
+        static char buffer[4096 + 512];
+        core_Arena arena = {0};
+        core_Pool pool;
+        void * objs[CORE_POOL_SLAB_OBJECTS];
+
+        core_arena_init_buffer(&arena, buffer, sizeof(buffer), CORE_ARENA_OVERFLOW_FAIL, NULL);
+        core_pool_init(&pool, &arena, 64);
+        for(i = 0; i < CORE_POOL_SLAB_OBJECTS; ++i) assert((objs[i] = core_pool_alloc(&pool)) != NULL);
+        assert(core_pool_alloc(&pool) == NULL);
+        assert(core_pool_alloc(&pool) == NULL);
+        assert(pool.slab_objects == CORE_POOL_SLAB_OBJECTS && pool.slab_used == CORE_POOL_SLAB_OBJECTS);
+        core_pool_free(&pool, objs[3]);
+        assert(core_pool_alloc(&pool) == objs[3]);
+
+        while(core_arena_alloc(&arena, 16) != NULL);
+        assert(core_arena_pool(&arena, 32) == NULL && arena.pools == NULL);
+        core_arena_free(&arena);
+    }
+
+    /*buffer arenas fill the caller's buffer first, chained chunks go through the allocator*/
+    {
+        CountingAllocator counter = {0};
+        core_ArenaAllocator allocator;
+        core_Arena arena = {0};
+        long buffer[128];
+        char * small;
+        char * spill;
+        char * big;
+        allocator.alloc = counting_alloc;
+        allocator.free = counting_free;
+        allocator.ctx = &counter;
+
+        core_arena_init_buffer(&arena, buffer, sizeof(buffer), CORE_ARENA_OVERFLOW_CHAIN, &allocator);
+        small = core_arena_alloc(&arena, 100);
+        assert(small >= (char *)buffer && small + 100 <= (char *)(buffer + 128));
+        assert(counter.allocs == 0);
+        spill = core_arena_alloc(&arena, 2000);
+        big = core_arena_alloc(&arena, 1000000);
+        assert(spill != NULL && big != NULL && counter.allocs >= 2);
+        assert(spill < (char *)buffer || spill >= (char *)(buffer + 128));
+        memset(spill, 1, 2000);
+        memset(big, 2, 1000000);
+        core_arena_free(&arena);
+        assert(counter.frees == counter.allocs && counter.live == 0);
+
+        core_arena_init_allocator(&arena, &allocator);
+        for(i = 0; i < 1000; ++i) {
+            small = core_arena_alloc(&arena, 1 + (size_t)i * 7);
+            assert(small != NULL);
+        }
+        assert(counter.allocs > counter.frees);
+        core_arena_free(&arena);
+        assert(counter.frees == counter.allocs && counter.live == 0);
+    }
+
+    /*a vec on a full fail arena dies with CORE_FATAL_ERROR instead of writing through NULL*/
+    {
+        static char buffer[512];
+        core_Arena arena = {0};
+        core_Vec(int) vec = {0};
+        core_arena_init_buffer(&arena, buffer, sizeof(buffer), CORE_ARENA_OVERFLOW_FAIL, NULL);
+        for(i = 0; i < 8; ++i) core_vec_append(&vec, &arena, i);
+        assert(vec.len == 8 && vec.items[7] == 7);
+        assert(core_arena_check_alloc(vec.items) == vec.items);
+#if defined(CORE_UNIX)
+        {
+            int status;
+            const pid_t child = fork();
+            assert(child >= 0);
+            if(child == 0) {
+                freopen("/dev/null", "w", stderr);
+                for(i = 0; i < 1000; ++i) core_vec_append(&vec, &arena, i);
+                _exit(0);
+            }
+            assert(waitpid(child, &status, 0) == child);
+            assert(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+        }
+#endif /*CORE_UNIX*/
+    }
+
+    /*bulk vec operations*/
+    {
+        core_Arena arena = {0};
+        core_Vec(int) vec = {0};
+        core_Vec(int) copy = {0};
+        int nums[10];
+        int * items;
+        for(i = 0; i < 10; ++i) nums[i] = i;
+
+        core_vec_reserve(&vec, &arena, 100);
+        assert(vec.len == 0 && vec.cap >= 100);
+        items = vec.items;
+        core_vec_extend(&vec, &arena, nums, 10);
+        core_vec_extend(&vec, &arena, nums, 10);
+        assert(vec.items == items && vec.len == 20 && vec.items[19] == 9);
+        core_vec_insert_n(&vec, &arena, 5, nums + 7, 3);    /*0 1 2 3 4 7 8 9 5 ...*/
+        assert(vec.len == 23 && vec.items[5] == 7 && vec.items[7] == 9 && vec.items[8] == 5);
+        core_vec_remove_range(&vec, 5, 3);
+        assert(vec.len == 20);
+        for(i = 0; i < 20; ++i) assert(vec.items[i] == i % 10);
+        core_vec_swap_remove(&vec, 0);
+        assert(vec.len == 19 && vec.items[0] == 9 && vec.items[18] == 8);
+        core_vec_resize(&vec, &arena, 200);
+        assert(vec.len == 200 && vec.items[18] == 8 && vec.items[19] == 0 && vec.items[199] == 0);
+        core_vec_resize(&vec, &arena, 3);
+        assert(vec.len == 3);
+        core_vec_copy_items(&copy, &vec, &arena);
+        assert(copy.len == 3 && copy.items[0] == 9 && copy.items[2] == 2);
+        core_vec_insert_n(&copy, &arena, 3, nums, 10);
+        assert(copy.len == 13 && copy.items[3] == 0 && copy.items[12] == 9);
+        core_arena_free(&arena);
+    }
+
+    /*staged introsort and radix sort agree with qsort, bounds find runs of equal keys*/
+    {
+        IntVec vec = {0};
+        int expected[1000];
+        int scratch[1000];
+        long longs[300];
+        unsigned long seed = 12345;
+        unsigned long lo;
+        unsigned long hi;
+        for(i = 0; i < 1000; ++i) {
+            seed = seed * 1103515245UL + 12345UL;
+            expected[i] = (int)((seed >> 16) % 200) - 100;
+            intvec_append(&vec, expected[i]);
+        }
+        qsort(expected, 1000, sizeof(expected[0]), core_compare_int);
+        intvec_sort(&vec);
+        assert(memcmp(vec.items, expected, sizeof(expected)) == 0);
+        lo = intvec_lower_bound(&vec, 7);
+        hi = intvec_upper_bound(&vec, 7);
+        assert(lo < hi && vec.items[lo] == 7 && vec.items[hi - 1] == 7);
+        assert(vec.items[lo - 1] < 7 && vec.items[hi] > 7);
+        assert(intvec_lower_bound(&vec, -1000) == 0 && intvec_lower_bound(&vec, 1000) == vec.len);
+
+        /*values spread over every byte, including negative ones*/
+        for(i = 0; i < 1000; ++i) vec.items[i] = expected[999 - i] * 1000003 + i;
+        memcpy(expected, vec.items, sizeof(expected));
+        qsort(expected, 1000, sizeof(expected[0]), core_compare_int);
+        intarray_radix_sort(vec.items, vec.len, scratch);
+        assert(memcmp(vec.items, expected, sizeof(expected)) == 0);
+        intvec_radix_sort(&vec);
+        assert(memcmp(vec.items, expected, sizeof(expected)) == 0);
+        for(i = 0; i < 1000; ++i) vec.items[i] = 42;
+        intvec_radix_sort(&vec);
+        for(i = 0; i < 1000; ++i) assert(vec.items[i] == 42);
+        intvec_free(&vec);
+
+        /*a custom less sorts descending*/
+        for(i = 0; i < 300; ++i) longs[i] = (long)((i * 37) % 101);
+        longarray_sort(longs, 300);
+        for(i = 1; i < 300; ++i) assert(longs[i - 1] >= longs[i]);
+        assert(longs[0] == 100 && longs[299] == 0);
+    }
+
+    /*staged numeric kernels, with lengths that are not a multiple of the 8 lanes*/
+    {
+        IntVec ints = {0};
+        DoubleVec lhs = {0};
+        DoubleVec rhs = {0};
+        double zero = 0.0;
+        double nan = zero / zero;
+        for(i = 0; i < 37; ++i) intvec_append(&ints, i % 10);
+        assert(intvec_find(&ints, 9) == 9 && intvec_find(&ints, 10) == ints.len);
+        assert(intvec_count(&ints, 3) == 4 && intvec_count(&ints, 7) == 3);
+        assert(intvec_min(&ints) == 0 && intvec_max(&ints) == 9 && intvec_sum(&ints) == 156);
+        ints.items[36] = -5;
+        assert(intvec_min(&ints) == -5 && intvec_find(&ints, -5) == 36);
+        intvec_fill(&ints, 2);
+        intvec_scale(&ints, 3);
+        assert(intvec_count(&ints, 6) == ints.len);
+        intvec_free(&ints);
+
+        for(i = 0; i < 21; ++i) {
+            doublevec_append(&lhs, (double)i);
+            doublevec_append(&rhs, 0.5);
+        }
+        doublevec_add(&lhs, &lhs, &rhs);
+        doublevec_scale(&lhs, 2.0);
+        assert(doublevec_min(&lhs) > 0.5 && doublevec_min(&lhs) < 1.5);
+        assert(doublevec_max(&lhs) > 40.5 && doublevec_max(&lhs) < 41.5);
+        assert(doublevec_sum(&lhs) > 440.5 && doublevec_sum(&lhs) < 441.5);
+        assert(doublevec_find(&lhs, 41.0) == 20 && doublevec_count(&rhs, 0.5) == 21);
+        rhs.items[3] = -0.0;
+        assert(doublevec_find(&rhs, 0.0) == 3);
+        rhs.items[4] = nan;
+        assert(doublevec_find(&rhs, nan) == rhs.len && doublevec_count(&rhs, nan) == 0);
+        doublevec_free(&lhs);
+        doublevec_free(&rhs);
+    }
+
+    /*small vecs stay inline until they outgrow it and keep their items when they spill*/
+    {
+        core_Arena arena = {0};
+        core_SmallVec(int, 4) small = {0};
+        IntSmallVec staged = {0};
+        IntSmallVec staged_arena = {0};
+        for(i = 0; i < 4; ++i) {
+            core_smallvec_append(&small, &arena, i);
+            intsmallvec_append(&staged, i);
+            intsmallvec_append_via_arena(&staged_arena, &arena, i);
+        }
+        assert(core_smallvec_is_inline(&small) && core_smallvec_capacity(&small) == 4);
+        assert(staged.items == NULL && intsmallvec_items(&staged) == staged.inline_items);
+        for(i = 4; i < 100; ++i) {
+            core_smallvec_append(&small, &arena, i);
+            intsmallvec_append(&staged, i);
+            intsmallvec_append_via_arena(&staged_arena, &arena, i);
+        }
+        assert(!core_smallvec_is_inline(&small) && core_smallvec_capacity(&small) >= 100);
+        assert(staged.items != NULL && intsmallvec_capacity(&staged) >= 100);
+        for(i = 0; i < 100; ++i) {
+            assert(core_smallvec_items(&small)[i] == i);
+            assert(intsmallvec_get(&staged, (unsigned long)i) == i);
+            assert(intsmallvec_get(&staged_arena, (unsigned long)i) == i);
+        }
+        assert(core_smallvec_pop(&small) == 99 && small.len == 99);
+        assert(intsmallvec_pop(&staged) == 99 && staged.len == 99);
+        intsmallvec_free(&staged);
+        assert(staged.len == 0 && intsmallvec_capacity(&staged) == 4);
+        core_arena_free(&arena);
+    }
+
+    /*struct of arrays keeps every field in its own array and records in step*/
+    {
+        core_Arena arena = {0};
+        ParticleSoa soa = {0};
+        ParticleSoa soa_arena = {0};
+        Particle p;
+        for(i = 0; i < 50; ++i) {
+            p.id = i;
+            p.weight = (long)i * 1000;
+            p.x = (double)i + 0.25;
+            particlesoa_push(&soa, p);
+            particlesoa_push_via_arena(&soa_arena, &arena, p);
+        }
+        assert(soa.len == 50 && soa.cap >= 50 && soa_arena.len == 50);
+        for(i = 0; i < 50; ++i) {
+            assert(soa.id[i] == i && soa.weight[i] == (long)i * 1000 && (int)soa.x[i] == i);
+            assert(soa_arena.weight[i] == (long)i * 1000);
+        }
+        p = particlesoa_get(&soa, 7);
+        assert(p.id == 7 && p.weight == 7000 && p.x > 7.0 && p.x < 7.5);
+        particlesoa_swap_remove(&soa, 7);
+        p = particlesoa_get(&soa, 7);
+        assert(soa.len == 49 && p.id == 49 && p.weight == 49000 && (int)p.x == 49);
+        particlesoa_swap_remove(&soa, 48);
+        assert(soa.len == 48 && soa.id[47] == 47);
+        particlesoa_free(&soa);
+        assert(soa.len == 0 && soa.id == NULL && soa.x == NULL);
+        core_arena_free(&arena);
+    }
+
+    /*deques keep their order when the span wraps around the end of the buffer*/
+    {
+        IntDeque deque = {0};
+        IntDeque fixed = {0};
+        int buffer[8];
+        int span[12];
+        int popped[12];
+        int item = 0;
+        for(i = 0; i < 12; ++i) span[i] = 100 + i;
+
+        /*head at 6 of 8, so a push of 5 wraps and pop_front_n reads back across the end*/
+        intdeque_init_fixed(&fixed, buffer, 8);
+        assert(intdeque_push_back_n(&fixed, span, 6) == 0);
+        assert(intdeque_pop_front_n(&fixed, popped, 6) == 6 && popped[5] == 105);
+        assert(intdeque_push_back_n(&fixed, span, 5) == 0 && fixed.head == 6);
+        assert(intdeque_get(&fixed, 2) == 102 && buffer[0] == 102);
+        assert(intdeque_push_back_n(&fixed, span, 4) == 1 && fixed.len == 5);
+        assert(intdeque_push_front(&fixed, 99) == 0 && intdeque_get(&fixed, 0) == 99);
+        assert(intdeque_pop_front_n(&fixed, popped, 12) == 6);
+        assert(popped[0] == 99 && popped[1] == 100 && popped[5] == 104);
+        assert(intdeque_pop_front(&fixed, &item) == 1 && intdeque_pop_back(&fixed, &item) == 1);
+        for(i = 0; i < 8; ++i) assert(intdeque_push_back(&fixed, i) == 0);
+        assert(intdeque_push_back(&fixed, 8) == 1 && intdeque_push_front(&fixed, -1) == 1);
+        intdeque_free(&fixed);
+
+        /*growing while wrapped unwraps the items into the new buffer*/
+        for(i = 0; i < 6; ++i) intdeque_push_back(&deque, i);
+        assert(deque.cap == 8 && intdeque_pop_front_n(&deque, popped, 5) == 5);
+        assert(intdeque_push_back_n(&deque, span, 6) == 0 && deque.head == 5 && deque.len == 7);
+        assert(intdeque_push_back_n(&deque, span, 12) == 0 && deque.cap == 32 && deque.head == 0);
+        assert(intdeque_get(&deque, 0) == 5 && intdeque_get(&deque, 6) == 105 && intdeque_get(&deque, 18) == 111);
+        for(i = 0; i < 10; ++i) intdeque_push_front(&deque, -i);
+        assert(deque.len == 29 && intdeque_get(&deque, 0) == -9 && intdeque_get(&deque, 10) == 5);
+        assert(intdeque_pop_back(&deque, &item) == 0 && item == 111);
+        assert(intdeque_pop_front(&deque, &item) == 0 && item == -9);
+        intdeque_free(&deque);
+    }
+
+    /*staged slices use the same unsigned long length as the containers they view*/
+    {
+        ParticleSoa soa = {0};
+        Particle p = {0};
+        int nums[10];
+        IntSlice all;
+        IntSlice part;
+        LongSlice weights;
+        for(i = 0; i < 10; ++i) nums[i] = i;
+        all = INTSLICE_FROM_ARRAY(nums);
+        assert(all.len == 10);
+        part = intslice_get_first_n_items(all, 3);
+        assert(part.len == 3 && part.ptr[2] == 2);
+        part = intslice_get_last_n_items(all, 3);
+        assert(part.len == 3 && part.ptr[0] == 7);
+        part = intslice_trim_first_n_items(all, 4);
+        assert(part.len == 6 && part.ptr[0] == 4 && part.ptr[5] == 9);
+        part = intslice_trim_last_n_items(all, 4);
+        assert(part.len == 6 && part.ptr[5] == 5);
+
+        for(i = 0; i < 20; ++i) {
+            p.weight = (long)i;
+            particlesoa_push(&soa, p);
+        }
+        weights = particlesoa_weight(&soa);
+        assert(weights.len == soa.len && weights.ptr == soa.weight && weights.ptr[19] == 19);
+        assert(particlesoa_id(&soa).len == 20);
+        particlesoa_free(&soa);
+    }
+
+    /*vec growth doubles, fits what is needed and stops at what the length type can index*/
+    {
+        assert(core_vec_next_capacity(0, 1, sizeof(int)) == 1);
+        assert(core_vec_next_capacity(8, 9, sizeof(int)) == 17);
+        assert(core_vec_next_capacity(8, 100, sizeof(int)) == 100);
+        assert(core_vec_next_capacity(CORE_VEC_LEN_MAX / 2 + 1, CORE_VEC_LEN_MAX / 2 + 2, 1) == CORE_VEC_LEN_MAX);
+        assert(core_vec_len_add(10, 5) == 15);
+        assert(core_vec_len_add(CORE_VEC_LEN_MAX - 1, 1) == CORE_VEC_LEN_MAX);
+    }
+
+#ifdef CORE_THREADS_AVAILABLE
+    /*parallel sorts are stable and prefix sums are bit for bit the same for every pool size*/
+    {
+        enum { PAIRS = 3 * CORE_PARALLEL_GRAIN + 77, SUMS = 5 * CORE_PARALLEL_GRAIN + 123 };
+        const unsigned long pool_sizes[] = {1, 2, 5};
+        core_ThreadPool pool;
+        unsigned long p;
+        int sum;
+        Pair * pairs = malloc(sizeof(Pair) * PAIRS);
+        Pair * expected = malloc(sizeof(Pair) * PAIRS);
+        Pair * sorted = malloc(sizeof(Pair) * PAIRS);
+        double * in = malloc(sizeof(double) * SUMS);
+        double * reference = malloc(sizeof(double) * SUMS);
+        double * staged_reference = malloc(sizeof(double) * SUMS);
+        double * exclusive = malloc(sizeof(double) * SUMS);
+        double * result = malloc(sizeof(double) * SUMS);
+        int * ints = malloc(sizeof(int) * SUMS);
+        int * int_result = malloc(sizeof(int) * SUMS);
+        assert(pairs && expected && sorted && in && reference && staged_reference && exclusive && result && ints && int_result);
+        for(i = 0; i < PAIRS; ++i) {
+            pairs[i].key = (i * 7919) % 97;
+            pairs[i].index = i;
+        }
+        memcpy(expected, pairs, sizeof(Pair) * PAIRS);
+        qsort(expected, PAIRS, sizeof(Pair), compare_pair_key_index);
+        for(i = 0; i < SUMS; ++i) {
+            in[i] = (i % 3 == 0 ? 1e8 : 0.1) * (double)(i % 7 + 1);
+            ints[i] = i % 11 - 5;
+        }
+        core_parallel_prefix_sum(in, reference, SUMS, sizeof(double), add_double, CORE_TRUE, NULL);
+        doublearray_prefix_sum(in, staged_reference, SUMS, CORE_TRUE);
+        assert(memcmp(reference, staged_reference, sizeof(double) * SUMS) == 0);
+        core_parallel_prefix_sum(in, exclusive, SUMS, sizeof(double), add_double, CORE_FALSE, NULL);
+        doublearray_prefix_sum(in, staged_reference, SUMS, CORE_FALSE);
+        assert(memcmp(exclusive, staged_reference, sizeof(double) * SUMS) == 0);
+
+        memcpy(sorted, pairs, sizeof(Pair) * PAIRS);
+        pairarray_stable_sort(sorted, PAIRS);
+        assert(memcmp(sorted, expected, sizeof(Pair) * PAIRS) == 0);
+
+        for(p = 0; p < CORE_ARRAY_LEN(pool_sizes); ++p) {
+            core_thread_pool_init(&pool, pool_sizes[p]);
+            assert(core_thread_pool_thread_count(&pool) == pool_sizes[p]);
+
+            memcpy(sorted, pairs, sizeof(Pair) * PAIRS);
+            core_parallel_sort(sorted, PAIRS, sizeof(Pair), compare_pair_key, &pool);
+            assert(memcmp(sorted, expected, sizeof(Pair) * PAIRS) == 0);
+            memcpy(sorted, pairs, sizeof(Pair) * PAIRS);
+            pairarray_parallel_sort(sorted, PAIRS, &pool);
+            assert(memcmp(sorted, expected, sizeof(Pair) * PAIRS) == 0);
+
+            core_parallel_prefix_sum(in, result, SUMS, sizeof(double), add_double, CORE_TRUE, &pool);
+            assert(memcmp(result, reference, sizeof(double) * SUMS) == 0);
+            doublearray_parallel_prefix_sum(in, result, SUMS, CORE_TRUE, &pool);
+            assert(memcmp(result, reference, sizeof(double) * SUMS) == 0);
+            memcpy(result, in, sizeof(double) * SUMS);
+            doublearray_parallel_prefix_sum(result, result, SUMS, CORE_FALSE, &pool);
+            assert(memcmp(result, exclusive, sizeof(double) * SUMS) == 0);
+
+            core_parallel_prefix_sum(ints, ints, SUMS, sizeof(int), core_add_int, CORE_FALSE, &pool);
+            for(i = 0, sum = 0; i < SUMS; ++i) {
+                assert(ints[i] == sum);
+                sum += i % 11 - 5;
+                ints[i] = i % 11 - 5;
+            }
+            /*the single pass integer scan equals the blocked parallel one*/
+            intarray_parallel_prefix_sum(ints, int_result, SUMS, CORE_TRUE, &pool);
+            intarray_prefix_sum(ints, ints, SUMS, CORE_TRUE);
+            assert(memcmp(ints, int_result, sizeof(int) * SUMS) == 0);
+            for(i = 0, sum = 0; i < SUMS; ++i) {
+                sum += i % 11 - 5;
+                assert(ints[i] == sum);
+                ints[i] = i % 11 - 5;
+            }
+            core_thread_pool_free(&pool);
+        }
+        free(pairs);
+        free(expected);
+        free(sorted);
+        free(in);
+        free(reference);
+        free(staged_reference);
+        free(exclusive);
+        free(result);
+        free(ints);
+        free(int_result);
+    }
+
+    /*pool workers release their scratch arenas when they exit, the leak checker catches it if not*/
+    {
+        core_ThreadPool pool;
+        ScratchTasks tasks = {0};
+        pthread_mutex_init(&tasks.mutex, NULL);
+        pthread_cond_init(&tasks.all_started, NULL);
+        core_thread_pool_init(&pool, SCRATCH_TASKS);
+        core_thread_pool_run(&pool, scratch_task, &tasks, SCRATCH_TASKS);
+        core_thread_pool_free(&pool);
+        for(i = 0; i < SCRATCH_TASKS; ++i) assert(tasks.sums[i] == 1000L * (i + 1) * (1000L * (i + 1) - 1) / 2);
+        pthread_cond_destroy(&tasks.all_started);
+        pthread_mutex_destroy(&tasks.mutex);
+        core_arena_scratch_free();
+    }
+#endif /*CORE_THREADS_AVAILABLE*/
+
+    /*the open addressing table keeps one slot per key next to the insertion ordered keys*/
+    {
+        core_Arena arena = {0};
+        core_Hashmap(int) h = {0};
+        char buf[16];
+        long used = 0;
+        long slot;
+        int * seen;
+
+        for(i = 0; i < 1000; ++i) {
+            sprintf(buf, "key%d", i);
+            core_hashmap_set(&h, &arena, buf, i);
+        }
+        core_hashmap_set(&h, &arena, "key500", -500);
+        assert(h.keys.len == 1000 && h.values.len == 1000);
+        assert(h.buckets.table.cap >= CORE_HASHMAP_MIN_CAP && (h.buckets.table.cap & (h.buckets.table.cap - 1)) == 0);
+        assert(!core_hashmap_needs_resize((long)h.keys.len, h.buckets.table.cap));
+        for(i = 0; i < 1000; ++i) {
+            sprintf(buf, "key%d", i);
+            assert(core_hashmap_get(&h, buf) != NULL && h.index == i);
+            assert(core_streql(h.keys.items[i], buf) && h.values.items[i] == (i == 500 ? -500 : i));
+            sprintf(buf, "miss%d", i);
+            assert(core_hashmap_get(&h, buf) == NULL && h.index == -1);
+        }
+
+        /*every key index is in exactly one slot*/
+        seen = core_arena_alloc(&arena, 1000 * sizeof(*seen));
+        memset(seen, 0, 1000 * sizeof(*seen));
+        for(slot = 0; slot < h.buckets.table.cap; ++slot) {
+            if(h.buckets.table.ctrl[slot] == CORE_HASHMAP_CTRL_EMPTY) continue;
+            assert(h.buckets.table.slots[slot].index >= 0 && h.buckets.table.slots[slot].index < 1000);
+            seen[h.buckets.table.slots[slot].index]++;
+            used++;
+        }
+        assert(used == 1000);
+        for(i = 0; i < 1000; ++i) assert(seen[i] == 1);
+        core_arena_free(&arena);
+    }
+
+    /*slots cache the full hash and its top bits as the control byte, growing never reads the keys*/
+    {
+        core_Arena arena = {0};
+        core_Hashmap(int) h = {0};
+        const char ** saved;
+        char buf[16];
+        long slot;
+        long cap;
+
+        for(i = 0; i < 100; ++i) {
+            sprintf(buf, "cached%d", i);
+            core_hashmap_set(&h, &arena, buf, i);
+        }
+        for(slot = 0; slot < h.buckets.table.cap; ++slot) {
+            const core_HashmapSlot * s = &h.buckets.table.slots[slot];
+            if(h.buckets.table.ctrl[slot] == CORE_HASHMAP_CTRL_EMPTY) continue;
+            assert(s->hash == core_hash_string(h.keys.items[s->index]));
+            assert(h.buckets.table.ctrl[slot] == _CORE_HASHMAP_CTRL(s->hash) && (h.buckets.table.ctrl[slot] & 0x80));
+        }
+
+        /*hide the key strings while rehashing, then every key must still be found*/
+        saved = core_arena_alloc(&arena, (size_t)h.keys.len * sizeof(*saved));
+        memcpy(saved, h.keys.items, (size_t)h.keys.len * sizeof(*saved));
+        memset(h.keys.items, 0, (size_t)h.keys.len * sizeof(*saved));
+        cap = h.buckets.table.cap;
+        core_hashmap_rehash(&h.buckets, &arena, &h.keys);
+        assert(h.buckets.table.cap == cap * 2);
+        memcpy(h.keys.items, saved, (size_t)h.keys.len * sizeof(*saved));
+        for(i = 0; i < 100; ++i) {
+            sprintf(buf, "cached%d", i);
+            assert(core_hashmap_get(&h, buf) != NULL && *core_hashmap_get(&h, buf) == i);
+        }
+        core_arena_free(&arena);
+    }
+
+    /*remove shifts the rest of a probe run back across the end of the table, reinserting finds the hole*/
+    {
+        core_Arena arena = {0};
+        core_Hashmap(int) h = {0};
+        char names[5][16];
+        int reference[64];
+        int found_last = 0;
+        int found_first = 0;
+        char buf[16];
+        long slot;
+
+        /*three keys homed in the last slot of a 16 slot table, two in the first*/
+        for(i = 0; found_last < 3 || found_first < 2; ++i) {
+            unsigned long home;
+            sprintf(buf, "w%d", i);
+            home = core_hash_string(buf) & 15;
+            if(home == 15 && found_last < 3) strcpy(names[found_last++], buf);
+            else if(home == 0 && found_first < 2) strcpy(names[3 + found_first++], buf);
+        }
+        for(i = 0; i < 5; ++i) core_hashmap_set(&h, &arena, names[i], i);
+        assert(h.buckets.table.cap == 16);
+        assert(h.buckets.table.slots[15].index == 0 && h.buckets.table.slots[0].index == 1);
+        assert(h.buckets.table.slots[3].index == 4 && h.buckets.table.ctrl[4] == CORE_HASHMAP_CTRL_EMPTY);
+
+        assert(core_hashmap_remove(&h, &arena, names[0]) && h.index == 0);
+        assert(!core_hashmap_remove(&h, &arena, names[0]));
+        assert(h.keys.len == 4 && h.values.len == 4 && core_streql(h.keys.items[0], names[4]) && h.values.items[0] == 4);
+        assert(h.buckets.table.slots[15].index == 1 && h.buckets.table.slots[0].index == 2);
+        assert(h.buckets.table.ctrl[3] == CORE_HASHMAP_CTRL_EMPTY);
+        for(i = 1; i < 5; ++i) assert(core_hashmap_get(&h, names[i]) != NULL && *core_hashmap_get(&h, names[i]) == i);
+        assert(core_hashmap_get(&h, names[0]) == NULL);
+
+        core_hashmap_set(&h, &arena, names[0], 10);
+        assert(h.buckets.table.slots[3].index == 4 && *core_hashmap_get(&h, names[0]) == 10);
+        for(i = 1; i < 5; ++i) assert(*core_hashmap_get(&h, names[i]) == i);
+
+        /*churn against a reference, removal must never leave tombstones behind*/
+        for(i = 0; i < 64; ++i) reference[i] = -1;
+        for(i = 0; i < 20000; ++i) {
+            const int k = rand() % 64;
+            sprintf(buf, "churn%d", k);
+            if(rand() % 2) {
+                core_hashmap_set(&h, &arena, buf, i);
+                reference[k] = i;
+            } else {
+                assert(core_hashmap_remove(&h, &arena, buf) == (reference[k] >= 0));
+                reference[k] = -1;
+            }
+        }
+        for(i = 0; i < 64; ++i) {
+            sprintf(buf, "churn%d", i);
+            assert(reference[i] < 0 ? core_hashmap_get(&h, buf) == NULL : *core_hashmap_get(&h, buf) == reference[i]);
+        }
+        assert(h.buckets.table.cap <= 128 && h.buckets.hashes.len == h.keys.len);
+        for(i = 0; i < (long)h.keys.len; ++i) assert(h.buckets.hashes.items[i] == core_hash_string(h.keys.items[i]));
+        for(slot = 0; slot < h.buckets.table.cap; ++slot) {
+            if(h.buckets.table.ctrl[slot] == CORE_HASHMAP_CTRL_EMPTY) continue;
+            assert(h.buckets.table.slots[slot].hash == h.buckets.hashes.items[h.buckets.table.slots[slot].index]);
+        }
+        core_arena_free(&arena);
+    }
+
+    /*staged maps store keys inline, removal shifts probe runs back across the end of the table*/
+    {
+        IntToIntMap map = {0};
+        PairToDoubleMap pairs = {0};
+        Pair pair = {0};
+        int homed[4];
+        int reference[256];
+        int found = 0;
+        unsigned long slot;
+
+        assert(inttointmap_get(&map, 1) == NULL && !inttointmap_remove(&map, 1));
+        for(i = 0; found < 4; ++i) {
+            if((INTTOINT_MAP_HASH(i) & 15) == 15) homed[found++] = i;
+        }
+        for(i = 0; i < 4; ++i) inttointmap_set(&map, homed[i], i);
+        assert(map.cap == 16 && map.len == 4 && map.entries[15].key == homed[0] && map.entries[2].key == homed[3]);
+        assert(inttointmap_remove(&map, homed[0]) && !inttointmap_remove(&map, homed[0]));
+        assert(map.len == 3 && map.entries[15].key == homed[1] && map.entries[1].key == homed[3] && map.ctrl[2] == 0);
+        for(i = 1; i < 4; ++i) assert(*inttointmap_get(&map, homed[i]) == i);
+        assert(inttointmap_get(&map, homed[0]) == NULL);
+        inttointmap_set(&map, homed[0], 10);
+        assert(map.entries[2].key == homed[0] && *inttointmap_get(&map, homed[0]) == 10);
+        inttointmap_set(&map, homed[1], 11);
+        assert(map.len == 4 && *inttointmap_get(&map, homed[1]) == 11);
+
+        /*churn and growth against a reference*/
+        for(i = 0; i < 256; ++i) reference[i] = -1;
+        for(i = 0; i < 50000; ++i) {
+            const int k = rand() % 256;
+            if(rand() % 3) {
+                inttointmap_set(&map, k * 1000, i);
+                reference[k] = i;
+            } else {
+                assert(inttointmap_remove(&map, k * 1000) == (reference[k] >= 0));
+                reference[k] = -1;
+            }
+        }
+        for(i = 0; i < 256; ++i) {
+            assert(reference[i] < 0 ? inttointmap_get(&map, i * 1000) == NULL : *inttointmap_get(&map, i * 1000) == reference[i]);
+        }
+        for(slot = 0; slot < map.cap; ++slot) {
+            if(map.ctrl[slot] != 0) assert(map.entries[slot].hash == INTTOINT_MAP_HASH(map.entries[slot].key));
+        }
+        inttointmap_reserve(&map, 1000);
+        assert(map.cap == 2048 && *inttointmap_get(&map, homed[0]) == 10);
+        inttointmap_clear(&map);
+        assert(map.len == 0 && inttointmap_get(&map, homed[0]) == NULL);
+        inttointmap_free(&map);
+
+        /*struct keys go through the given hash and equality*/
+        for(i = 0; i < 100; ++i) {
+            pair.key = i % 10;
+            pair.index = i;
+            pairtodoublemap_set(&pairs, pair, i * 0.5);
+        }
+        assert(pairs.len == 100);
+        for(i = 0; i < 100; i += 2) {
+            pair.key = i % 10;
+            pair.index = i;
+            assert(pairtodoublemap_remove(&pairs, pair));
+        }
+        for(i = 0; i < 100; ++i) {
+            const double * value;
+            pair.key = i % 10;
+            pair.index = i;
+            value = pairtodoublemap_get(&pairs, pair);
+            assert(i % 2 == 0 ? value == NULL : (*value >= i * 0.5 && *value <= i * 0.5));
+        }
+        pairtodoublemap_free(&pairs);
+    }
+
+    /*incremental resize keeps both tables searchable while get, set and remove move old slots over*/
+    {
+        enum { KEYS = 2000 };
+        core_Arena arena = {0};
+        core_Hashmap(int) h = {0};
+        int * reference = malloc(KEYS * sizeof(int));
+        char buf[16];
+        long ops = 0;
+        long slot;
+
+        core_hashmap_enable_incremental_resize(&h);
+        for(i = 0; i < KEYS; ++i) reference[i] = -1;
+        for(i = 0; i <= 768; ++i) {
+            sprintf(buf, "inc%d", i);
+            core_hashmap_set(&h, &arena, buf, i);
+            reference[i] = i;
+        }
+        /*the 769th key grew 1024 slots to 2048 and left the old table to migrate*/
+        assert(h.buckets.table.cap == 2048 && h.buckets.old.cap == 1024 && _CORE_HASHMAP_MIGRATING(&h.buckets));
+
+        while(h.buckets.old.slots != NULL) {
+            const int k = rand() % KEYS;
+            long occupied = 0;
+            sprintf(buf, "inc%d", k);
+            switch(rand() % 3) {
+            case 0:
+                assert(reference[k] < 0 ? core_hashmap_get(&h, buf) == NULL : *core_hashmap_get(&h, buf) == reference[k]);
+                break;
+            case 1:
+                core_hashmap_set(&h, &arena, buf, KEYS + k);
+                reference[k] = KEYS + k;
+                break;
+            default:
+                assert(core_hashmap_remove(&h, &arena, buf) == (reference[k] != -1));
+                reference[k] = -1;
+                break;
+            }
+            /*each key is in exactly one of the tables*/
+            for(slot = 0; slot < h.buckets.table.cap; ++slot) occupied += h.buckets.table.ctrl[slot] != CORE_HASHMAP_CTRL_EMPTY;
+            for(slot = 0; slot < h.buckets.old.cap; ++slot) occupied += h.buckets.old.ctrl[slot] != CORE_HASHMAP_CTRL_EMPTY;
+            assert(occupied == (long)h.keys.len);
+            ops++;
+        }
+        /*every access takes at most CORE_HASHMAP_MIGRATE_STEP steps, one per old slot passed or entry moved*/
+        assert(ops >= 1024 / CORE_HASHMAP_MIGRATE_STEP / 2 && ops <= 4 * 1024 / CORE_HASHMAP_MIGRATE_STEP);
+        assert(h.buckets.old.cap == 0 && h.buckets.migrated == 0);
+        for(i = 0; i < KEYS; ++i) {
+            sprintf(buf, "inc%d", i);
+            assert(reference[i] == -1 ? core_hashmap_get(&h, buf) == NULL : *core_hashmap_get(&h, buf) == reference[i]);
+        }
+        free(reference);
+        core_arena_free(&arena);
+    }
+
+#if defined(CORE_THREADS_AVAILABLE) && defined(CORE_ATOMICS_AVAILABLE)
+    /*concurrent hashmap values too big for the stack copy in get*/
+    {
+        core_ConcurrentHashmap map;
+        char big[CORE_CONCURRENT_HASHMAP_STACK_VALUE * 2];
+        char out[sizeof(big)];
+
+        memset(big, 'x', sizeof(big));
+        memset(out, 0, sizeof(out));
+        core_concurrent_hashmap_init(&map, sizeof(big), 0);
+        core_concurrent_hashmap_set(&map, "big", big);
+        assert(!core_concurrent_hashmap_get(&map, "small", out) && out[0] == 0);
+        assert(core_concurrent_hashmap_get(&map, "big", out) && memcmp(out, big, sizeof(big)) == 0);
+        core_concurrent_hashmap_free(&map);
+    }
+
+    /*concurrent hashmap under writers churning their own keys, readers checking for torn values
+      and a reclaim racing both*/
+    {
+        core_ConcurrentHashmap map;
+        MapWorker * workers = calloc(MAP_WRITERS + MAP_READERS, sizeof(*workers));
+        pthread_t threads[MAP_WRITERS + MAP_READERS];
+        int writers_done = 0;
+        long live = 0;
+        long found = 0;
+        char key[32];
+        long w, k;
+
+        core_concurrent_hashmap_init(&map, sizeof(MapValue), 8);
+        for(i = 0; i < MAP_WRITERS + MAP_READERS; ++i) {
+            workers[i].map = &map;
+            workers[i].writers_done = &writers_done;
+            workers[i].id = i < MAP_WRITERS ? i : i - MAP_WRITERS;
+            workers[i].rng = (unsigned long)i * 7919 + 1;
+        }
+        for(i = MAP_WRITERS; i < MAP_WRITERS + MAP_READERS; ++i) pthread_create(&threads[i], NULL, map_reader, &workers[i]);
+        for(i = 0; i < MAP_WRITERS; ++i) pthread_create(&threads[i], NULL, map_writer, &workers[i]);
+        for(i = 0; i < MAP_WRITERS; ++i) pthread_join(threads[i], NULL);
+        CORE_ATOMIC_STORE(&writers_done, 1);
+        for(i = MAP_WRITERS; i < MAP_WRITERS + MAP_READERS; ++i) {
+            pthread_join(threads[i], NULL);
+            found += workers[i].found;
+        }
+        assert(found > 0);
+
+        /*the map ends up holding exactly the last write of every writer*/
+        for(w = 0; w < MAP_WRITERS; ++w) {
+            for(k = 0; k < MAP_WRITER_KEYS; ++k) {
+                MapValue value;
+                core_Bool got;
+                sprintf(key, "w%ld_k%ld", w, k);
+                got = core_concurrent_hashmap_get(&map, key, &value);
+                assert(got == (workers[w].reference[k] >= 0));
+                if(got) {
+                    assert(value.serial == workers[w].reference[k] && value.id == w * MAP_WRITER_KEYS + k);
+                    live++;
+                }
+            }
+        }
+        assert(core_concurrent_hashmap_len(&map) == live);
+        core_concurrent_hashmap_reclaim(&map);
+        for(i = 0; i < (long)map.segment_count; ++i) assert(map.segments[i].retired_len == 0);
+        core_concurrent_hashmap_free(&map);
+        free(workers);
+    }
+#endif /*defined(CORE_THREADS_AVAILABLE) && defined(CORE_ATOMICS_AVAILABLE)*/
+
     /* { */
     /*     core_Arena arena = {0}; */
     /*     core_Symbols syms = {0}; */
@@ -88,3 +1341,4 @@ int main(void) {
 
     return 0;
 }
+#endif /*STAGE_1*/
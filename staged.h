@@ -84,6 +84,27 @@ void _core_staged_name_cases_derive(const char * prefix, const char * typename,
 }
 #endif /*CORE_IMPLEMENTATION*/
 
+#ifdef CORE_IMPLEMENTATION
+/*emits CORE_STAGED_CHECK once per file, an always on check for overflow and failed
+  allocations that stays in NDEBUG builds. it dies through CORE_FATAL_ERROR when core.h
+  was included before the generated code*/
+void _core_staged_check_generate(FILE * out) {
+    fprintf(
+        out,
+        "#ifndef CORE_STAGED_CHECK\n"
+        "#   ifdef _CORE_H_\n"
+        "#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) CORE_FATAL_ERROR(msg); } while(0)\n"
+        "#   else\n"
+        "#       include <stdio.h>\n"
+        "#       include <stdlib.h>\n"
+        "#       define CORE_STAGED_CHECK(cond, msg) do { if(!(cond)) { fprintf(stderr, \"%%s:%%d: %%s\\n\", __FILE__, __LINE__, msg); abort(); } } while(0)\n"
+        "#   endif\n"
+        "#endif /*CORE_STAGED_CHECK*/\n"
+        "\n"
+    );
+}
+#endif /*CORE_IMPLEMENTATION*/
+
 void core_staged_slice_generate(FILE * out, const char * prefix, const char * typename)
 #ifdef CORE_IMPLEMENTATION
 {
@@ -98,7 +119,7 @@ void core_staged_slice_generate(FILE * out, const char * prefix, const char * ty
         out,
         "typedef struct {\n"
         "   %s * ptr;\n"
-        "   int len;\n"
+        "   unsigned long len;\n"
         "} %sSlice;\n"
         "\n",
         cases.typename,
@@ -128,7 +149,7 @@ void core_staged_slice_generate(FILE * out, const char * prefix, const char * ty
     );
     fprintf(
         out,
-        "%sSlice %sslice_get_first_n_items(%sSlice slice, int n) {\n"
+        "%sSlice %sslice_get_first_n_items(%sSlice slice, unsigned long n) {\n"
         "    %sSlice result = slice;\n"
         "    assert(n <= slice.len);\n"
         "    result.len = n;\n"
@@ -142,7 +163,7 @@ void core_staged_slice_generate(FILE * out, const char * prefix, const char * ty
     );
     fprintf(
         out,
-        "%sSlice %sslice_get_last_n_items(%sSlice slice, int n) {\n"
+        "%sSlice %sslice_get_last_n_items(%sSlice slice, unsigned long n) {\n"
         "    %sSlice result = slice;\n"
         "    assert(n <= slice.len);\n"
         "    result.len = n;\n"
@@ -157,11 +178,11 @@ void core_staged_slice_generate(FILE * out, const char * prefix, const char * ty
     );
     fprintf(
         out,
-        "%sSlice %sslice_trim_first_n_items(%sSlice slice, int n) {\n"
+        "%sSlice %sslice_trim_first_n_items(%sSlice slice, unsigned long n) {\n"
         "    %sSlice result = slice;\n"
         "    assert(n <= slice.len);\n"
         "    result.len = slice.len - n;\n"
-        "    result.ptr += slice.len - n;\n"
+        "    result.ptr += n;\n"
         "    return result;\n"
         "}\n"
         "\n",
@@ -172,7 +193,7 @@ void core_staged_slice_generate(FILE * out, const char * prefix, const char * ty
     );
     fprintf(
         out,
-        "%sSlice %sslice_trim_last_n_items(%sSlice slice, int n) {\n"
+        "%sSlice %sslice_trim_last_n_items(%sSlice slice, unsigned long n) {\n"
         "    %sSlice result = slice;\n"
         "    assert(n <= slice.len);\n"
         "    result.len = slice.len - n;\n"
@@ -205,6 +226,7 @@ void core_staged_vec_generate(FILE * out, const char * prefix, const char * type
         "#include <stdlib.h>\n"
         "#include <assert.h>\n\n"
     );
+    _core_staged_check_generate(out);
 
     fprintf(
         out,
@@ -221,36 +243,61 @@ void core_staged_vec_generate(FILE * out, const char * prefix, const char * type
         out,
         "void %svec_ensure_capacity(%sVec * vec, unsigned long capacity) {\n"
         "    if(vec->items == NULL || vec->cap <= 0) {\n"
+        "        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), \"vec capacity overflow\");\n"
         "        vec->cap = capacity;\n"
         "        vec->items = malloc(vec->cap * sizeof(vec->items[0]));\n"
-        "        assert(vec->items);\n"
-        "        vec->len = 0;\n"
+        "        CORE_STAGED_CHECK(vec->items != NULL || capacity == 0, \"vec allocation failed\");\n"
+        "        vec->len = 0;\n",
+        cases.all_lower,
+        cases.pascal
+    );
+    fprintf(
+        out,
         "    } else if(vec->cap < capacity) {\n"
+        "        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / 2 / sizeof(vec->items[0]), \"vec capacity overflow\");\n"
         "        vec->cap = capacity * 2;\n"
         "        vec->items = realloc(vec->items, vec->cap * sizeof(vec->items[0]));\n"
-        "        assert(vec->items);\n"
+        "        CORE_STAGED_CHECK(vec->items != NULL, \"vec allocation failed\");\n"
         "    }\n"
         "    assert(vec->cap >= capacity);\n"
         "}\n"
-        "\n",
-        cases.all_lower,
-        cases.pascal
+        "\n"
     );
     fprintf(
         out,
         "#ifdef _CORE_H_\n"
         "void %svec_ensure_capacity_via_arena(%sVec * vec, core_Arena * arena, unsigned long capacity) {\n"
         "    if(vec->items == NULL || vec->cap <= 0) {\n"
+        "        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), \"vec capacity overflow\");\n"
         "        vec->cap = capacity;\n"
-        "        vec->items = core_arena_alloc(arena, vec->cap * sizeof(vec->items[0]));\n"
-        "        vec->len = 0;\n"
+        "        vec->items = core_arena_check_alloc(core_arena_alloc(arena, vec->cap * sizeof(vec->items[0])));\n"
+        "        vec->len = 0;\n",
+        cases.all_lower,
+        cases.pascal
+    );
+    fprintf(
+        out,
         "    } else if(vec->cap < capacity) {\n"
+        "        CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / 2 / sizeof(vec->items[0]), \"vec capacity overflow\");\n"
         "        vec->cap = capacity * 2;\n"
-        "        vec->items = core_arena_realloc(arena, vec->items, vec->cap * sizeof(vec->items[0]));\n"
+        "        vec->items = core_arena_check_alloc(core_arena_realloc(arena, vec->items, vec->cap * sizeof(vec->items[0])));\n"
         "    }\n"
         "    assert(vec->cap >= capacity);\n"
         "}\n"
         "#endif /*_CORE_H_*/\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "#ifdef _CORE_H_\n"
+        "void %svec_init_aligned_via_arena(%sVec * vec, core_Arena * arena, unsigned long capacity, unsigned long align) {\n"
+        "    assert(vec->items == NULL || vec->cap <= 0);\n"
+        "    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), \"vec capacity overflow\");\n"
+        "    vec->cap = capacity;\n"
+        "    vec->items = core_arena_check_alloc(core_arena_alloc_aligned(arena, vec->cap * sizeof(vec->items[0]), align));\n"
+        "    vec->len = 0;\n"
+        "}\n"
+        "#endif /*_CORE_H_*/\n"
         "\n",
         cases.all_lower,
         cases.pascal
@@ -302,14 +349,14 @@ void core_staged_vec_generate(FILE * out, const char * prefix, const char * type
         "    unsigned long i = 0;\n"
         "    %svec_ensure_capacity(vec, vec->len + times);\n"
         "    for(i = 0; i < times; ++i) {\n"
-        "        %svec_append(vec, item);\n"
+        "        vec->items[vec->len + i] = item;\n"
         "    }\n"
+        "    vec->len += times;\n"
         "}\n"
         "\n",
         cases.all_lower,
         cases.pascal,
         cases.typename,
-        cases.all_lower,
         cases.all_lower
     );
     fprintf(
@@ -385,25 +432,31 @@ void core_staged_sset_generate(FILE * out, const char * prefix, const char * typ
         "void %ssset_insert(%sSSet * sset, unsigned long index, %s item) {\n"
         "    unsigned long dense_index = 0;\n"
         "    %sunsignedlongvec_ensure_length(&sset->sparse, 0, index + 1);\n"
-        "    dense_index = sset->sparse.items[index];\n"
+        "    dense_index = sset->sparse.items[index];\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        prefix
+    );
+    fprintf(
+        out,
         "    if(dense_index == 0) {\n"
         "        assert(sset->dense.len == sset->dense_to_sparse.len);\n"
         "        dense_index = sset->dense.len;\n"
         "        %svec_append(&sset->dense, item);\n"
         "        %sunsignedlongvec_append(&sset->dense_to_sparse, index);\n"
-        "        sset->sparse.items[index] = dense_index + 1; /*dense index is incremented by 1 so that zero is the NULL value*/\n"
+        "        sset->sparse.items[index] = dense_index + 1; /*dense index is incremented by 1 so that zero is the NULL value*/\n",
+        cases.all_lower,
+        prefix
+    );
+    fprintf(
+        out,
         "    } else {\n"
         "        dense_index -= 1; /*adjust the dense index back to baseline (the dense_index in the sparse array is always 1 higher than the actual index)*/\n"
         "        sset->dense.items[dense_index] = item;\n"
         "    }\n"
         "}\n"
-        "\n",
-        cases.all_lower,
-        cases.pascal,
-        cases.typename,
-        prefix,
-        cases.all_lower,
-        prefix
+        "\n"
     );
     fprintf(
         out,
@@ -442,7 +495,13 @@ void core_staged_sset_generate(FILE * out, const char * prefix, const char * typ
         "    assert(sset->dense.len == sset->dense_to_sparse.len);\n"
         "    assert(sset->dense.len > 0);\n"
         "    if(index >= sset->sparse.len) return;\n"
-        "    if(sset->sparse.items[index] == 0) return;\n"
+        "    if(sset->sparse.items[index] == 0) return;\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename
+    );
+    fprintf(
+        out,
         "    top = %svec_pop(&sset->dense);\n"
         "    top_index = %sunsignedlongvec_pop(&sset->dense_to_sparse);\n"
         "    sset->dense.items[sset->sparse.items[index] - 1] = top;\n"
@@ -452,9 +511,6 @@ void core_staged_sset_generate(FILE * out, const char * prefix, const char * typ
         "}\n"
         "\n",
         cases.all_lower,
-        cases.pascal,
-        cases.typename,
-        cases.all_lower,
         prefix
     );
 
@@ -488,9 +544,9 @@ void core_staged_enum_generate(FILE * out, const char * prefix, const char * enu
     unsigned int i = 0;
     size_t fill_tracker = 0;
     /*    assert(prefix_len + enum_name_len + 1 < sizeof(prefix_and_name));*/
-    core_strfmt(prefix_and_name, sizeof(prefix_and_name), &fill_tracker, prefix, strlen(prefix));
-    core_strfmt(prefix_and_name, sizeof(prefix_and_name), &fill_tracker, enum_name, strlen(enum_name));
-    core_strfmt(prefix_and_name, sizeof(prefix_and_name), &fill_tracker, "_", strlen("_"));
+    core_strnfmt(prefix_and_name, sizeof(prefix_and_name), &fill_tracker, prefix, strlen(prefix));
+    core_strnfmt(prefix_and_name, sizeof(prefix_and_name), &fill_tracker, enum_name, strlen(enum_name));
+    core_strnfmt(prefix_and_name, sizeof(prefix_and_name), &fill_tracker, "_", strlen("_"));
     
     /*sprintf(prefix_and_name, "%s%s_", prefix, enum_name);*/
     _core_staged_name_cases_derive(prefix, enum_name, &cases);
@@ -542,8 +598,8 @@ void core_staged_taggedunion_generate(FILE * out, const char * prefix, const cha
     unsigned long i = 0;
     size_t fill_pointer = 0;
     assert(strlen(name) + 4 < sizeof(buf));
-    core_strfmt(buf, sizeof(buf), &fill_pointer, name, strlen(name));
-    core_strfmt(buf, sizeof(buf), &fill_pointer, "Tag", strlen("Tag"));
+    core_strnfmt(buf, sizeof(buf), &fill_pointer, name, strlen(name));
+    core_strnfmt(buf, sizeof(buf), &fill_pointer, "Tag", strlen("Tag"));
     /*sprintf(buf, "%sTag", name);*/
     core_staged_enum_generate(out, prefix, buf, len, field_names);
 
@@ -613,3 +669,1867 @@ void core_staged_taggedunion_generate(FILE * out, const char * prefix, const cha
 ;
 #endif /*CORE_IMPLEMENTATION*/
 
+
+/*less is the name of a function or function-like macro taking two items, NULL compares with <.
+  if a vec of the same type was generated first, vec wrappers are emitted too*/
+void core_staged_sort_generate(FILE * out, const char * prefix, const char * typename, const char * less)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_StagedNameCases cases = {0};
+    _core_staged_name_cases_derive(prefix, typename, &cases);
+
+    fprintf(out, "#ifndef _%sSORT_\n", cases.all_caps);
+    fprintf(out, "#define _%sSORT_\n\n", cases.all_caps);
+
+    if(less == NULL) {
+        fprintf(out, "#define %s_SORT_LESS(a, b) ((a) < (b))\n\n", cases.all_caps);
+    } else {
+        fprintf(out, "#define %s_SORT_LESS(a, b) (%s(a, b))\n\n", cases.all_caps, less);
+    }
+
+    fprintf(
+        out,
+        "void _%sarray_insertion_sort(%s * items, long lo, long hi) {\n"
+        "    long i = 0;\n"
+        "    long j = 0;\n"
+        "    %s tmp;\n"
+        "    for(i = lo + 1; i <= hi; ++i) {\n"
+        "        tmp = items[i];\n"
+        "        for(j = i; j > lo && %s_SORT_LESS(tmp, items[j - 1]); --j) {\n"
+        "            items[j] = items[j - 1];\n"
+        "        }\n"
+        "        items[j] = tmp;\n"
+        "    }\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "void _%sarray_sift_down(%s * items, long root, long len) {\n"
+        "    %s tmp = items[root];\n"
+        "    long child = 0;\n"
+        "    while((child = 2 * root + 1) < len) {\n"
+        "        if(child + 1 < len && %s_SORT_LESS(items[child], items[child + 1])) ++child;\n"
+        "        if(!%s_SORT_LESS(tmp, items[child])) break;\n"
+        "        items[root] = items[child];\n"
+        "        root = child;\n"
+        "    }\n"
+        "    items[root] = tmp;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.all_caps,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "void _%sarray_heap_sort(%s * items, long len) {\n"
+        "    long i = 0;\n"
+        "    %s tmp;\n"
+        "    for(i = len / 2 - 1; i >= 0; --i) {\n"
+        "        _%sarray_sift_down(items, i, len);\n"
+        "    }\n"
+        "    for(i = len - 1; i > 0; --i) {\n"
+        "        tmp = items[0];\n"
+        "        items[0] = items[i];\n"
+        "        items[i] = tmp;\n"
+        "        _%sarray_sift_down(items, 0, i);\n"
+        "    }\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.all_lower,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "/*quicksort that falls back to heapsort when the recursion gets too deep and to insertion sort for short ranges*/\n"
+        "void _%sarray_intro_sort(%s * items, long lo, long hi, int depth) {\n"
+        "    long i = 0;\n"
+        "    long j = 0;\n"
+        "    long mid = 0;\n"
+        "    %s pivot;\n"
+        "    %s tmp;\n"
+        "    while(hi - lo > 16) {\n"
+        "        if(depth-- == 0) {\n"
+        "            _%sarray_heap_sort(items + lo, hi - lo + 1);\n"
+        "            return;\n"
+        "        }\n"
+        "        mid = lo + (hi - lo) / 2;\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "        if(%s_SORT_LESS(items[mid], items[lo])) { tmp = items[mid]; items[mid] = items[lo]; items[lo] = tmp; }\n"
+        "        if(%s_SORT_LESS(items[hi], items[mid])) { tmp = items[hi]; items[hi] = items[mid]; items[mid] = tmp; }\n"
+        "        if(%s_SORT_LESS(items[mid], items[lo])) { tmp = items[mid]; items[mid] = items[lo]; items[lo] = tmp; }\n"
+        "        pivot = items[mid];\n",
+        cases.all_caps,
+        cases.all_caps,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "        i = lo - 1;\n"
+        "        j = hi + 1;\n"
+        "        for(;;) {\n"
+        "            do ++i; while(%s_SORT_LESS(items[i], pivot));\n"
+        "            do --j; while(%s_SORT_LESS(pivot, items[j]));\n"
+        "            if(i >= j) break;\n"
+        "            tmp = items[i];\n"
+        "            items[i] = items[j];\n"
+        "            items[j] = tmp;\n"
+        "        }\n",
+        cases.all_caps,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "        /*recurse into the smaller half so the stack stays O(log n)*/\n"
+        "        if(j - lo < hi - j) {\n"
+        "            _%sarray_intro_sort(items, lo, j, depth);\n"
+        "            lo = j + 1;\n"
+        "        } else {\n"
+        "            _%sarray_intro_sort(items, j + 1, hi, depth);\n"
+        "            hi = j;\n"
+        "        }\n"
+        "    }\n"
+        "    _%sarray_insertion_sort(items, lo, hi);\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.all_lower,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "void %sarray_sort(%s * items, unsigned long len) {\n"
+        "    int depth = 0;\n"
+        "    unsigned long n = 0;\n"
+        "    for(n = len; n > 1; n >>= 1) depth += 2;\n"
+        "    if(len > 1) _%sarray_intro_sort(items, 0, (long)len - 1, depth);\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "/*index of the first item not less than key*/\n"
+        "unsigned long %sarray_lower_bound(%s * items, unsigned long len, %s key) {\n"
+        "    unsigned long lo = 0;\n"
+        "    unsigned long step = 0;\n"
+        "    while(len > 0) {\n"
+        "        step = len / 2;\n"
+        "        if(%s_SORT_LESS(items[lo + step], key)) {\n"
+        "            lo += step + 1;\n"
+        "            len -= step + 1;\n"
+        "        } else {\n"
+        "            len = step;\n"
+        "        }\n"
+        "    }\n"
+        "    return lo;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "/*index of the first item greater than key*/\n"
+        "unsigned long %sarray_upper_bound(%s * items, unsigned long len, %s key) {\n"
+        "    unsigned long lo = 0;\n"
+        "    unsigned long step = 0;\n"
+        "    while(len > 0) {\n"
+        "        step = len / 2;\n"
+        "        if(!%s_SORT_LESS(key, items[lo + step])) {\n"
+        "            lo += step + 1;\n"
+        "            len -= step + 1;\n"
+        "        } else {\n"
+        "            len = step;\n"
+        "        }\n"
+        "    }\n"
+        "    return lo;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "#ifdef _%sVEC_\n"
+        "void %svec_sort(%sVec * vec) {\n"
+        "    %sarray_sort(vec->items, vec->len);\n"
+        "}\n"
+        "\n"
+        "unsigned long %svec_lower_bound(%sVec * vec, %s key) {\n"
+        "    return %sarray_lower_bound(vec->items, vec->len, key);\n"
+        "}\n"
+        "\n"
+        "unsigned long %svec_upper_bound(%sVec * vec, %s key) {\n"
+        "    return %sarray_upper_bound(vec->items, vec->len, key);\n"
+        "}\n"
+        "#endif /*_%sVEC_*/\n"
+        "\n",
+        cases.all_caps,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower,
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower,
+        cases.all_caps
+    );
+
+    fprintf(out, "#endif /*_%sSORT_*/\n\n", cases.all_caps);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*least significant digit radix sort for integer types, linear in the number of items.
+  the generated sort takes a scratch array that holds len items*/
+void core_staged_radix_sort_generate(FILE * out, const char * prefix, const char * typename, core_Bool is_signed)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_StagedNameCases cases = {0};
+    _core_staged_name_cases_derive(prefix, typename, &cases);
+
+    fprintf(out, "#ifndef _%sRADIXSORT_\n", cases.all_caps);
+    fprintf(out, "#define _%sRADIXSORT_\n\n", cases.all_caps);
+    fprintf(
+        out,
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "#include <assert.h>\n\n"
+    );
+    _core_staged_check_generate(out);
+
+    fprintf(
+        out,
+        "void %sarray_radix_sort(%s * items, unsigned long len, %s * scratch) {\n"
+        "    unsigned long counts[256];\n"
+        "    unsigned long i = 0;\n"
+        "    unsigned long total = 0;\n"
+        "    unsigned long count = 0;\n"
+        "    unsigned int pass = 0;\n"
+        "    unsigned int shift = 0;\n"
+        "    unsigned int flip = 0;\n"
+        "    %s * src = items;\n"
+        "    %s * dst = scratch;\n"
+        "    %s * tmp = NULL;\n"
+        "    if(len < 2) return;\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "    for(pass = 0; pass < sizeof(%s); ++pass) {\n"
+        "        shift = pass * 8;\n"
+        "        /*flipping the sign bit orders negative numbers first*/\n"
+        "        flip = pass + 1 == sizeof(%s) ? %uU : 0U;\n"
+        "        memset(counts, 0, sizeof(counts));\n",
+        cases.typename,
+        cases.typename,
+        is_signed ? 0x80U : 0U
+    );
+    fprintf(
+        out,
+        "        for(i = 0; i < len; ++i) {\n"
+        "            ++counts[(((unsigned int)(src[i] >> shift)) & 0xffU) ^ flip];\n"
+        "        }\n"
+        "        /*skip the pass if every key has the same digit*/\n"
+        "        if(counts[(((unsigned int)(src[0] >> shift)) & 0xffU) ^ flip] == len) continue;\n"
+        "        for(i = 0, total = 0; i < 256; ++i) {\n"
+        "            count = counts[i];\n"
+        "            counts[i] = total;\n"
+        "            total += count;\n"
+        "        }\n"
+    );
+    fprintf(
+        out,
+        "        for(i = 0; i < len; ++i) {\n"
+        "            dst[counts[(((unsigned int)(src[i] >> shift)) & 0xffU) ^ flip]++] = src[i];\n"
+        "        }\n"
+        "        tmp = src;\n"
+        "        src = dst;\n"
+        "        dst = tmp;\n"
+        "    }\n"
+        "    if(src != items) memcpy(items, src, len * sizeof(items[0]));\n"
+        "}\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "#ifdef _%sVEC_\n"
+        "void %svec_radix_sort(%sVec * vec) {\n"
+        "    %s * scratch = NULL;\n"
+        "    if(vec->len < 2) return;\n"
+        "    scratch = malloc(vec->len * sizeof(vec->items[0]));\n"
+        "    CORE_STAGED_CHECK(scratch != NULL, \"radix sort allocation failed\");\n"
+        "    %sarray_radix_sort(vec->items, vec->len, scratch);\n"
+        "    free(scratch);\n"
+        "}\n"
+        "\n",
+        cases.all_caps,
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "#ifdef _CORE_H_\n"
+        "void %svec_radix_sort_via_arena(%sVec * vec, core_Arena * arena) {\n"
+        "    %s * scratch = NULL;\n"
+        "    if(vec->len < 2) return;\n"
+        "    scratch = core_arena_check_alloc(core_arena_alloc(arena, vec->len * sizeof(vec->items[0])));\n"
+        "    %sarray_radix_sort(vec->items, vec->len, scratch);\n"
+        "    core_arena_reclaim_memory(arena, scratch);\n"
+        "}\n"
+        "#endif /*_CORE_H_*/\n"
+        "#endif /*_%sVEC_*/\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower,
+        cases.all_caps
+    );
+
+    fprintf(out, "#endif /*_%sRADIXSORT_*/\n\n", cases.all_caps);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*bulk kernels for numeric element types. the loops work on blocks of 8 independent
+  lanes so compilers auto vectorise them at -O2/-O3 without any intrinsics.
+  find and count compare with <= and >= instead of ==, which means the same for every
+  numeric type without tripping -Wfloat-equal: NaN is never found and -0.0 matches 0.0*/
+void core_staged_vec_numeric_generate(FILE * out, const char * prefix, const char * typename)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_StagedNameCases cases = {0};
+    _core_staged_name_cases_derive(prefix, typename, &cases);
+
+    fprintf(out, "#ifndef _%sNUMERIC_\n", cases.all_caps);
+    fprintf(out, "#define _%sNUMERIC_\n\n", cases.all_caps);
+    fprintf(out, "#include <assert.h>\n\n");
+    fprintf(out, "#define %s_NUMERIC_EQ(a, b) ((a) <= (b) && (a) >= (b))\n\n", cases.all_caps);
+
+    fprintf(
+        out,
+        "void %sarray_fill(%s * items, unsigned long len, %s value) {\n"
+        "    unsigned long i = 0;\n"
+        "    for(i = 0; i < len; ++i) {\n"
+        "        items[i] = value;\n"
+        "    }\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "/*returns len when value is not found*/\n"
+        "unsigned long %sarray_find(%s * items, unsigned long len, %s value) {\n"
+        "    unsigned long i = 0;\n"
+        "    unsigned long k = 0;\n"
+        "    int hit = 0;\n"
+        "    for(; i + 8 <= len; i += 8) {\n"
+        "        for(k = 0, hit = 0; k < 8; ++k) hit |= %s_NUMERIC_EQ(items[i + k], value);\n"
+        "        if(hit) break;\n"
+        "    }\n"
+        "    for(; i < len; ++i) {\n"
+        "        if(%s_NUMERIC_EQ(items[i], value)) return i;\n"
+        "    }\n"
+        "    return len;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.all_caps,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "unsigned long %sarray_count(%s * items, unsigned long len, %s value) {\n"
+        "    unsigned long i = 0;\n"
+        "    unsigned long result = 0;\n"
+        "    for(i = 0; i < len; ++i) {\n"
+        "        result += (unsigned long)%s_NUMERIC_EQ(items[i], value);\n"
+        "    }\n"
+        "    return result;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "%s %sarray_min(%s * items, unsigned long len) {\n"
+        "    %s lanes[8];\n"
+        "    unsigned long i = 0;\n"
+        "    unsigned long k = 0;\n"
+        "    assert(len > 0);\n"
+        "    for(k = 0; k < 8; ++k) lanes[k] = items[0];\n"
+        "    for(; i + 8 <= len; i += 8) {\n"
+        "        for(k = 0; k < 8; ++k) lanes[k] = items[i + k] < lanes[k] ? items[i + k] : lanes[k];\n"
+        "    }\n"
+        "    for(; i < len; ++i) lanes[0] = items[i] < lanes[0] ? items[i] : lanes[0];\n"
+        "    for(k = 1; k < 8; ++k) lanes[0] = lanes[k] < lanes[0] ? lanes[k] : lanes[0];\n"
+        "    return lanes[0];\n"
+        "}\n"
+        "\n",
+        cases.typename,
+        cases.all_lower,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "%s %sarray_max(%s * items, unsigned long len) {\n"
+        "    %s lanes[8];\n"
+        "    unsigned long i = 0;\n"
+        "    unsigned long k = 0;\n"
+        "    assert(len > 0);\n"
+        "    for(k = 0; k < 8; ++k) lanes[k] = items[0];\n"
+        "    for(; i + 8 <= len; i += 8) {\n"
+        "        for(k = 0; k < 8; ++k) lanes[k] = items[i + k] > lanes[k] ? items[i + k] : lanes[k];\n"
+        "    }\n"
+        "    for(; i < len; ++i) lanes[0] = items[i] > lanes[0] ? items[i] : lanes[0];\n"
+        "    for(k = 1; k < 8; ++k) lanes[0] = lanes[k] > lanes[0] ? lanes[k] : lanes[0];\n"
+        "    return lanes[0];\n"
+        "}\n"
+        "\n",
+        cases.typename,
+        cases.all_lower,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "/*summed in the element type, so integer sums can overflow*/\n"
+        "%s %sarray_sum(%s * items, unsigned long len) {\n"
+        "    %s lanes[8] = {0};\n"
+        "    unsigned long i = 0;\n"
+        "    unsigned long k = 0;\n"
+        "    for(; i + 8 <= len; i += 8) {\n"
+        "        for(k = 0; k < 8; ++k) lanes[k] = (%s)(lanes[k] + items[i + k]);\n"
+        "    }\n"
+        "    for(; i < len; ++i) lanes[0] = (%s)(lanes[0] + items[i]);\n"
+        "    for(k = 1; k < 8; ++k) lanes[0] = (%s)(lanes[0] + lanes[k]);\n"
+        "    return lanes[0];\n"
+        "}\n"
+        "\n",
+        cases.typename,
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "/*dst may be the same array as lhs or rhs*/\n"
+        "void %sarray_add(%s * dst, %s * lhs, %s * rhs, unsigned long len) {\n"
+        "    unsigned long i = 0;\n"
+        "    for(i = 0; i < len; ++i) {\n"
+        "        dst[i] = (%s)(lhs[i] + rhs[i]);\n"
+        "    }\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "void %sarray_scale(%s * items, unsigned long len, %s factor) {\n"
+        "    unsigned long i = 0;\n"
+        "    for(i = 0; i < len; ++i) {\n"
+        "        items[i] = (%s)(items[i] * factor);\n"
+        "    }\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.typename
+    );
+
+    fprintf(
+        out,
+        "#ifdef _%sVEC_\n"
+        "void %svec_fill(%sVec * vec, %s value) {\n"
+        "    %sarray_fill(vec->items, vec->len, value);\n"
+        "}\n"
+        "\n"
+        "unsigned long %svec_find(%sVec * vec, %s value) {\n"
+        "    return %sarray_find(vec->items, vec->len, value);\n"
+        "}\n"
+        "\n"
+        "unsigned long %svec_count(%sVec * vec, %s value) {\n"
+        "    return %sarray_count(vec->items, vec->len, value);\n"
+        "}\n"
+        "\n",
+        cases.all_caps,
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower,
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower,
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "%s %svec_min(%sVec * vec) {\n"
+        "    return %sarray_min(vec->items, vec->len);\n"
+        "}\n"
+        "\n"
+        "%s %svec_max(%sVec * vec) {\n"
+        "    return %sarray_max(vec->items, vec->len);\n"
+        "}\n"
+        "\n"
+        "%s %svec_sum(%sVec * vec) {\n"
+        "    return %sarray_sum(vec->items, vec->len);\n"
+        "}\n"
+        "\n",
+        cases.typename,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.typename,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.typename,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "void %svec_add(%sVec * dst, %sVec * lhs, %sVec * rhs) {\n"
+        "    assert(dst->len == lhs->len && lhs->len == rhs->len);\n"
+        "    %sarray_add(dst->items, lhs->items, rhs->items, dst->len);\n"
+        "}\n"
+        "\n"
+        "void %svec_scale(%sVec * vec, %s factor) {\n"
+        "    %sarray_scale(vec->items, vec->len, factor);\n"
+        "}\n"
+        "#endif /*_%sVEC_*/\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.pascal,
+        cases.pascal,
+        cases.all_lower,
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower,
+        cases.all_caps
+    );
+
+    fprintf(out, "#endif /*_%sNUMERIC_*/\n\n", cases.all_caps);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*vec that keeps its first inline_count items inside the struct and only allocates once
+  they are outgrown. items is NULL while the inline storage is used*/
+void core_staged_smallvec_generate(FILE * out, const char * prefix, const char * typename, unsigned long inline_count)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_StagedNameCases cases = {0};
+    _core_staged_name_cases_derive(prefix, typename, &cases);
+    assert(inline_count > 0);
+
+    fprintf(out, "#ifndef _%sSMALLVEC_\n", cases.all_caps);
+    fprintf(out, "#define _%sSMALLVEC_\n\n", cases.all_caps);
+    fprintf(
+        out,
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "#include <assert.h>\n\n"
+    );
+    _core_staged_check_generate(out);
+
+    fprintf(
+        out,
+        "typedef struct {\n"
+        "    %s * items;\n"
+        "    unsigned long len;\n"
+        "    unsigned long cap;\n"
+        "    %s inline_items[%lu];\n"
+        "} %sSmallVec;\n"
+        "\n",
+        cases.typename,
+        cases.typename,
+        inline_count,
+        cases.pascal
+    );
+    fprintf(
+        out,
+        "%s * %ssmallvec_items(%sSmallVec * vec) {\n"
+        "    return vec->items == NULL ? vec->inline_items : vec->items;\n"
+        "}\n"
+        "\n"
+        "unsigned long %ssmallvec_capacity(%sSmallVec * vec) {\n"
+        "    return vec->items == NULL ? %luUL : vec->cap;\n"
+        "}\n"
+        "\n",
+        cases.typename,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.pascal,
+        inline_count
+    );
+    fprintf(
+        out,
+        "void %ssmallvec_ensure_capacity(%sSmallVec * vec, unsigned long capacity) {\n"
+        "    if(capacity <= %ssmallvec_capacity(vec)) return;\n"
+        "    if(capacity < %ssmallvec_capacity(vec) * 2) capacity = %ssmallvec_capacity(vec) * 2;\n"
+        "    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), \"smallvec capacity overflow\");\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.all_lower,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "    if(vec->items == NULL) {\n"
+        "        vec->items = malloc(capacity * sizeof(vec->items[0]));\n"
+        "        CORE_STAGED_CHECK(vec->items != NULL, \"smallvec allocation failed\");\n"
+        "        memcpy(vec->items, vec->inline_items, vec->len * sizeof(vec->items[0]));\n"
+        "    } else {\n"
+        "        vec->items = realloc(vec->items, capacity * sizeof(vec->items[0]));\n"
+        "        CORE_STAGED_CHECK(vec->items != NULL, \"smallvec allocation failed\");\n"
+        "    }\n"
+        "    vec->cap = capacity;\n"
+        "}\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "#ifdef _CORE_H_\n"
+        "void %ssmallvec_ensure_capacity_via_arena(%sSmallVec * vec, core_Arena * arena, unsigned long capacity) {\n"
+        "    if(capacity <= %ssmallvec_capacity(vec)) return;\n"
+        "    if(capacity < %ssmallvec_capacity(vec) * 2) capacity = %ssmallvec_capacity(vec) * 2;\n"
+        "    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(vec->items[0]), \"smallvec capacity overflow\");\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.all_lower,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "    if(vec->items == NULL) {\n"
+        "        vec->items = core_arena_check_alloc(core_arena_alloc(arena, capacity * sizeof(vec->items[0])));\n"
+        "        memcpy(vec->items, vec->inline_items, vec->len * sizeof(vec->items[0]));\n"
+        "    } else {\n"
+        "        vec->items = core_arena_check_alloc(core_arena_realloc(arena, vec->items, capacity * sizeof(vec->items[0])));\n"
+        "    }\n"
+        "    vec->cap = capacity;\n"
+        "}\n"
+        "#endif /*_CORE_H_*/\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "void %ssmallvec_append(%sSmallVec * vec, %s item) {\n"
+        "    %ssmallvec_ensure_capacity(vec, vec->len + 1);\n"
+        "    %ssmallvec_items(vec)[vec->len++] = item;\n"
+        "}\n"
+        "\n"
+        "#ifdef _CORE_H_\n"
+        "void %ssmallvec_append_via_arena(%sSmallVec * vec, core_Arena * arena, %s item) {\n"
+        "    %ssmallvec_ensure_capacity_via_arena(vec, arena, vec->len + 1);\n"
+        "    %ssmallvec_items(vec)[vec->len++] = item;\n"
+        "}\n"
+        "#endif /*_CORE_H_*/\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower,
+        cases.all_lower,
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "%s %ssmallvec_get(%sSmallVec * vec, unsigned long index) {\n"
+        "    assert(index < vec->len);\n"
+        "    return %ssmallvec_items(vec)[index];\n"
+        "}\n"
+        "\n"
+        "%s %ssmallvec_pop(%sSmallVec * vec) {\n"
+        "    assert(vec->len > 0);\n"
+        "    return %ssmallvec_items(vec)[--vec->len];\n"
+        "}\n"
+        "\n",
+        cases.typename,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.typename,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "/*only for vecs grown with smallvec_append, arena backed ones are freed with the arena*/\n"
+        "void %ssmallvec_free(%sSmallVec * vec) {\n"
+        "    free(vec->items);\n"
+        "    vec->items = NULL;\n"
+        "    vec->len = 0;\n"
+        "    vec->cap = 0;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal
+    );
+
+    fprintf(out, "#endif /*_%sSMALLVEC_*/\n\n", cases.all_caps);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*struct of arrays container, one contiguous array per field with a shared len and cap.
+  the record struct is emitted too so whole records can be pushed and read back*/
+void core_staged_soa_generate(FILE * out, const char * prefix, const char * name, unsigned long len, const char ** field_types, const char ** field_names)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_StagedNameCases cases = {0};
+    core_StagedNameCases field_cases = {0};
+    unsigned long i = 0;
+    _core_staged_name_cases_derive(prefix, name, &cases);
+    assert(len > 0);
+
+    fprintf(out, "#ifndef _%s_SOA_\n", cases.all_caps);
+    fprintf(out, "#define _%s_SOA_\n", cases.all_caps);
+    fprintf(out, "\n");
+    fprintf(out, "#include <stdlib.h>\n");
+    fprintf(out, "#include <assert.h>\n");
+    fprintf(out, "\n");
+    _core_staged_check_generate(out);
+
+    fprintf(out, "typedef struct {\n");
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    %s %s;\n", field_types[i], field_names[i]);
+    }
+    fprintf(out, "} %s;\n", cases.pascal);
+    fprintf(out, "\n");
+
+    fprintf(out, "typedef struct {\n");
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    %s * %s;\n", field_types[i], field_names[i]);
+    }
+    fprintf(out, "    unsigned long len;\n");
+    fprintf(out, "    unsigned long cap;\n");
+    fprintf(out, "} %sSoa;\n", cases.pascal);
+    fprintf(out, "\n");
+
+    /*growth*/
+    fprintf(out, "void %ssoa_ensure_capacity(%sSoa * soa, unsigned long capacity) {\n", cases.all_lower, cases.pascal);
+    fprintf(out, "    if(soa->cap >= capacity) return;\n");
+    fprintf(out, "    CORE_STAGED_CHECK(soa->cap <= (unsigned long)-1 / 2, \"soa capacity overflow\");\n");
+    fprintf(out, "    if(capacity < soa->cap * 2) capacity = soa->cap * 2;\n");
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(soa->%s[0]), \"soa capacity overflow\");\n", field_names[i]);
+    }
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    soa->%s = realloc(soa->%s, capacity * sizeof(soa->%s[0]));\n", field_names[i], field_names[i], field_names[i]);
+        fprintf(out, "    CORE_STAGED_CHECK(soa->%s != NULL, \"soa allocation failed\");\n", field_names[i]);
+    }
+    fprintf(out, "    soa->cap = capacity;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "\n");
+
+    fprintf(out, "#ifdef _CORE_H_\n");
+    fprintf(out, "void %ssoa_ensure_capacity_via_arena(%sSoa * soa, core_Arena * arena, unsigned long capacity) {\n", cases.all_lower, cases.pascal);
+    fprintf(out, "    if(soa->cap >= capacity) return;\n");
+    fprintf(out, "    CORE_STAGED_CHECK(soa->cap <= (unsigned long)-1 / 2, \"soa capacity overflow\");\n");
+    fprintf(out, "    if(capacity < soa->cap * 2) capacity = soa->cap * 2;\n");
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    CORE_STAGED_CHECK(capacity <= (unsigned long)-1 / sizeof(soa->%s[0]), \"soa capacity overflow\");\n", field_names[i]);
+    }
+    for(i = 0; i < len; ++i) {
+        fprintf(
+            out,
+            "    soa->%s = soa->cap == 0\n"
+            "        ? core_arena_check_alloc(core_arena_alloc(arena, capacity * sizeof(soa->%s[0])))\n"
+            "        : core_arena_check_alloc(core_arena_realloc(arena, soa->%s, capacity * sizeof(soa->%s[0])));\n",
+            field_names[i],
+            field_names[i],
+            field_names[i],
+            field_names[i]
+        );
+    }
+    fprintf(out, "    soa->cap = capacity;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "#endif /*_CORE_H_*/\n");
+    fprintf(out, "\n");
+
+    /*records*/
+    fprintf(out, "void %ssoa_push(%sSoa * soa, %s item) {\n", cases.all_lower, cases.pascal, cases.pascal);
+    fprintf(out, "    %ssoa_ensure_capacity(soa, soa->len + 1);\n", cases.all_lower);
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    soa->%s[soa->len] = item.%s;\n", field_names[i], field_names[i]);
+    }
+    fprintf(out, "    ++soa->len;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "\n");
+
+    fprintf(out, "#ifdef _CORE_H_\n");
+    fprintf(out, "void %ssoa_push_via_arena(%sSoa * soa, core_Arena * arena, %s item) {\n", cases.all_lower, cases.pascal, cases.pascal);
+    fprintf(out, "    %ssoa_ensure_capacity_via_arena(soa, arena, soa->len + 1);\n", cases.all_lower);
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    soa->%s[soa->len] = item.%s;\n", field_names[i], field_names[i]);
+    }
+    fprintf(out, "    ++soa->len;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "#endif /*_CORE_H_*/\n");
+    fprintf(out, "\n");
+
+    fprintf(out, "%s %ssoa_get(%sSoa * soa, unsigned long index) {\n", cases.pascal, cases.all_lower, cases.pascal);
+    fprintf(out, "    %s result;\n", cases.pascal);
+    fprintf(out, "    assert(index < soa->len);\n");
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    result.%s = soa->%s[index];\n", field_names[i], field_names[i]);
+    }
+    fprintf(out, "    return result;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "\n");
+
+    fprintf(out, "/*moves the last record into the hole, so order is not kept*/\n");
+    fprintf(out, "void %ssoa_swap_remove(%sSoa * soa, unsigned long index) {\n", cases.all_lower, cases.pascal);
+    fprintf(out, "    assert(index < soa->len);\n");
+    fprintf(out, "    --soa->len;\n");
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    soa->%s[index] = soa->%s[soa->len];\n", field_names[i], field_names[i]);
+    }
+    fprintf(out, "}\n");
+    fprintf(out, "\n");
+
+    fprintf(out, "/*only for containers grown with soa_push, arena backed ones are freed with the arena*/\n");
+    fprintf(out, "void %ssoa_free(%sSoa * soa) {\n", cases.all_lower, cases.pascal);
+    for(i = 0; i < len; ++i) {
+        fprintf(out, "    free(soa->%s);\n", field_names[i]);
+        fprintf(out, "    soa->%s = NULL;\n", field_names[i]);
+    }
+    fprintf(out, "    soa->len = 0;\n");
+    fprintf(out, "    soa->cap = 0;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "\n");
+
+    /*per field slices, only when a slice of the field type was generated with the same prefix*/
+    for(i = 0; i < len; ++i) {
+        memset(&field_cases, 0, sizeof(field_cases));
+        _core_staged_name_cases_derive(prefix, field_types[i], &field_cases);
+        fprintf(
+            out,
+            "#ifdef _%sSLICE_\n"
+            "%sSlice %ssoa_%s(%sSoa * soa) {\n"
+            "    %sSlice result;\n"
+            "    result.ptr = soa->%s;\n"
+            "    result.len = soa->len;\n"
+            "    return result;\n"
+            "}\n"
+            "#endif /*_%sSLICE_*/\n"
+            "\n",
+            field_cases.all_caps,
+            field_cases.pascal,
+            cases.all_lower,
+            field_names[i],
+            cases.pascal,
+            field_cases.pascal,
+            field_names[i],
+            field_cases.all_caps
+        );
+    }
+
+    fprintf(out, "#endif /*_%s_SOA_*/\n", cases.all_caps);
+    fprintf(out, "\n");
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*power of two ring buffer that works as a growable deque or, after deque_init_fixed,
+  as a bounded queue over a caller supplied buffer that never allocates.
+  functions returning int return 0 on success and 1 when full or empty*/
+void core_staged_deque_generate(FILE * out, const char * prefix, const char * typename)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_StagedNameCases cases = {0};
+    _core_staged_name_cases_derive(prefix, typename, &cases);
+
+    fprintf(out, "#ifndef _%sDEQUE_\n", cases.all_caps);
+    fprintf(out, "#define _%sDEQUE_\n\n", cases.all_caps);
+    fprintf(
+        out,
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "#include <assert.h>\n\n"
+    );
+    _core_staged_check_generate(out);
+
+    fprintf(
+        out,
+        "typedef struct {\n"
+        "    %s * items;\n"
+        "    unsigned long head;\n"
+        "    unsigned long len;\n"
+        "    unsigned long cap;\n"
+        "    int fixed;\n"
+        "} %sDeque;\n"
+        "\n",
+        cases.typename,
+        cases.pascal
+    );
+    fprintf(
+        out,
+        "void %sdeque_init_fixed(%sDeque * deque, %s * buffer, unsigned long capacity) {\n"
+        "    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);\n"
+        "    deque->items = buffer;\n"
+        "    deque->head = 0;\n"
+        "    deque->len = 0;\n"
+        "    deque->cap = capacity;\n"
+        "    deque->fixed = 1;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "/*grows to a power of two and unwraps the items to the start of the new buffer*/\n"
+        "int %sdeque_ensure_capacity(%sDeque * deque, unsigned long capacity) {\n"
+        "    %s * items = NULL;\n"
+        "    unsigned long cap = deque->cap == 0 ? 8 : deque->cap;\n"
+        "    unsigned long first = 0;\n"
+        "    if(capacity <= deque->cap) return 0;\n"
+        "    if(deque->fixed) return 1;\n"
+        "    CORE_STAGED_CHECK(capacity <= ((unsigned long)-1 / 2 + 1) / sizeof(items[0]), \"deque capacity overflow\");\n"
+        "    while(cap < capacity) cap *= 2;\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "    items = malloc(cap * sizeof(items[0]));\n"
+        "    CORE_STAGED_CHECK(items != NULL, \"deque allocation failed\");\n"
+        "    if(deque->len > 0) {\n"
+        "        first = deque->cap - deque->head < deque->len ? deque->cap - deque->head : deque->len;\n"
+        "        memcpy(items, deque->items + deque->head, first * sizeof(items[0]));\n"
+        "        memcpy(items + first, deque->items, (deque->len - first) * sizeof(items[0]));\n"
+        "    }\n"
+        "    free(deque->items);\n"
+        "    deque->items = items;\n"
+        "    deque->head = 0;\n"
+        "    deque->cap = cap;\n"
+        "    return 0;\n"
+        "}\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "int %sdeque_push_back(%sDeque * deque, %s item) {\n"
+        "    if(%sdeque_ensure_capacity(deque, deque->len + 1)) return 1;\n"
+        "    deque->items[(deque->head + deque->len) & (deque->cap - 1)] = item;\n"
+        "    ++deque->len;\n"
+        "    return 0;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "int %sdeque_push_front(%sDeque * deque, %s item) {\n"
+        "    if(%sdeque_ensure_capacity(deque, deque->len + 1)) return 1;\n"
+        "    deque->head = (deque->head - 1) & (deque->cap - 1);\n"
+        "    deque->items[deque->head] = item;\n"
+        "    ++deque->len;\n"
+        "    return 0;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "int %sdeque_pop_front(%sDeque * deque, %s * result) {\n"
+        "    if(deque->len == 0) return 1;\n"
+        "    if(result != NULL) *result = deque->items[deque->head];\n"
+        "    deque->head = (deque->head + 1) & (deque->cap - 1);\n"
+        "    --deque->len;\n"
+        "    return 0;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "int %sdeque_pop_back(%sDeque * deque, %s * result) {\n"
+        "    if(deque->len == 0) return 1;\n"
+        "    --deque->len;\n"
+        "    if(result != NULL) *result = deque->items[(deque->head + deque->len) & (deque->cap - 1)];\n"
+        "    return 0;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "/*index 0 is the front*/\n"
+        "%s %sdeque_get(%sDeque * deque, unsigned long index) {\n"
+        "    assert(index < deque->len);\n"
+        "    return deque->items[(deque->head + index) & (deque->cap - 1)];\n"
+        "}\n"
+        "\n",
+        cases.typename,
+        cases.all_lower,
+        cases.pascal
+    );
+    fprintf(
+        out,
+        "/*all or nothing, the span is copied with at most two memcpys*/\n"
+        "int %sdeque_push_back_n(%sDeque * deque, %s * items, unsigned long count) {\n"
+        "    unsigned long tail = 0;\n"
+        "    unsigned long first = 0;\n"
+        "    if(count == 0) return 0;\n"
+        "    if(%sdeque_ensure_capacity(deque, deque->len + count)) return 1;\n"
+        "    tail = (deque->head + deque->len) & (deque->cap - 1);\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "    first = deque->cap - tail < count ? deque->cap - tail : count;\n"
+        "    memcpy(deque->items + tail, items, first * sizeof(items[0]));\n"
+        "    memcpy(deque->items, items + first, (count - first) * sizeof(items[0]));\n"
+        "    deque->len += count;\n"
+        "    return 0;\n"
+        "}\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "/*pops up to count items off the front into result and returns how many were popped*/\n"
+        "unsigned long %sdeque_pop_front_n(%sDeque * deque, %s * result, unsigned long count) {\n"
+        "    unsigned long first = 0;\n"
+        "    if(count > deque->len) count = deque->len;\n"
+        "    if(count == 0) return 0;\n"
+        "    first = deque->cap - deque->head < count ? deque->cap - deque->head : count;\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "    memcpy(result, deque->items + deque->head, first * sizeof(result[0]));\n"
+        "    memcpy(result + first, deque->items, (count - first) * sizeof(result[0]));\n"
+        "    deque->head = (deque->head + count) & (deque->cap - 1);\n"
+        "    deque->len -= count;\n"
+        "    return count;\n"
+        "}\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "/*fixed deques leave the caller's buffer alone*/\n"
+        "void %sdeque_free(%sDeque * deque) {\n"
+        "    if(!deque->fixed) free(deque->items);\n"
+        "    deque->items = NULL;\n"
+        "    deque->head = 0;\n"
+        "    deque->len = 0;\n"
+        "    deque->cap = 0;\n"
+        "    deque->fixed = 0;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal
+    );
+
+    fprintf(out, "#endif /*_%sDEQUE_*/\n\n", cases.all_caps);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*stable merge sort spread over a core_ThreadPool, so core.h has to be included before the generated code.
+  core_staged_sort_generate must have been called for the type first since its less is reused*/
+void core_staged_parallel_sort_generate(FILE * out, const char * prefix, const char * typename)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_StagedNameCases cases = {0};
+    _core_staged_name_cases_derive(prefix, typename, &cases);
+
+    fprintf(out, "#ifndef _%sPARALLEL_SORT_\n", cases.all_caps);
+    fprintf(out, "#define _%sPARALLEL_SORT_\n\n", cases.all_caps);
+    fprintf(out, "#ifdef CORE_THREADS_AVAILABLE\n");
+    fprintf(
+        out,
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "#include <assert.h>\n\n"
+    );
+
+    fprintf(
+        out,
+        "void _%sarray_merge(%s * dst, const %s * lhs, unsigned long lhs_len, const %s * rhs, unsigned long rhs_len) {\n"
+        "    unsigned long i = 0;\n"
+        "    unsigned long j = 0;\n"
+        "    while(i < lhs_len && j < rhs_len) {\n"
+        "        if(%s_SORT_LESS(rhs[j], lhs[i])) *dst++ = rhs[j++];\n"
+        "        else *dst++ = lhs[i++];\n"
+        "    }\n"
+        "    while(i < lhs_len) *dst++ = lhs[i++];\n"
+        "    while(j < rhs_len) *dst++ = rhs[j++];\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "/*how many of the first k items of the merge of lhs and rhs come from lhs*/\n"
+        "unsigned long _%sarray_merge_split(const %s * lhs, unsigned long lhs_len, const %s * rhs, unsigned long rhs_len, unsigned long k) {\n"
+        "    unsigned long lo = k > rhs_len ? k - rhs_len : 0;\n"
+        "    unsigned long hi = k < lhs_len ? k : lhs_len;\n"
+        "    unsigned long i = 0;\n"
+        "    while(lo < hi) {\n"
+        "        i = lo + (hi - lo) / 2;\n"
+        "        if(!%s_SORT_LESS(rhs[k - i - 1], lhs[i])) lo = i + 1;\n"
+        "        else hi = i;\n"
+        "    }\n"
+        "    return lo;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "void _%sarray_merge_sort(%s * items, %s * scratch, unsigned long len) {\n"
+        "    unsigned long width = 16;\n"
+        "    unsigned long lo = 0;\n"
+        "    unsigned long mid = 0;\n"
+        "    unsigned long hi = 0;\n"
+        "    %s * src = items;\n"
+        "    %s * dst = scratch;\n"
+        "    %s * tmp = NULL;\n"
+        "    for(lo = 0; lo < len; lo += width) {\n"
+        "        hi = lo + width < len ? lo + width : len;\n"
+        "        _%sarray_insertion_sort(items, (long)lo, (long)hi - 1);\n"
+        "    }\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "    for(; width < len; width *= 2) {\n"
+        "        for(lo = 0; lo < len; lo += 2 * width) {\n"
+        "            mid = lo + width < len ? lo + width : len;\n"
+        "            hi = mid + width < len ? mid + width : len;\n"
+        "            _%sarray_merge(dst + lo, src + lo, mid - lo, src + mid, hi - mid);\n"
+        "        }\n"
+        "        tmp = src;\n"
+        "        src = dst;\n"
+        "        dst = tmp;\n"
+        "    }\n"
+        "    if(src != items) memcpy(items, src, len * sizeof(items[0]));\n"
+        "}\n"
+        "\n",
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "typedef struct {\n"
+        "    %s * items;\n"
+        "    %s * scratch;\n"
+        "    %s * src;\n"
+        "    %s * dst;\n"
+        "    unsigned long len;\n"
+        "    unsigned long width;\n"
+        "    unsigned long pieces;\n"
+        "} _%sParallelSort;\n"
+        "\n",
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.pascal
+    );
+    fprintf(
+        out,
+        "void _%sarray_parallel_sort_runs(void * ctx, unsigned long index) {\n"
+        "    _%sParallelSort * sort = ctx;\n"
+        "    unsigned long lo = index * sort->width;\n"
+        "    unsigned long hi = lo + sort->width < sort->len ? lo + sort->width : sort->len;\n"
+        "    _%sarray_merge_sort(sort->items + lo, sort->scratch + lo, hi - lo);\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "void _%sarray_parallel_sort_merge(void * ctx, unsigned long index) {\n"
+        "    _%sParallelSort * sort = ctx;\n"
+        "    unsigned long lo = index / sort->pieces * 2 * sort->width;\n"
+        "    unsigned long mid = lo + sort->width < sort->len ? lo + sort->width : sort->len;\n"
+        "    unsigned long hi = mid + sort->width < sort->len ? mid + sort->width : sort->len;\n"
+        "    unsigned long piece = index %% sort->pieces;\n",
+        cases.all_lower,
+        cases.pascal
+    );
+    fprintf(
+        out,
+        "    unsigned long k0 = (unsigned long)_core_parallel_split(hi - lo, sort->pieces, piece);\n"
+        "    unsigned long k1 = (unsigned long)_core_parallel_split(hi - lo, sort->pieces, piece + 1);\n"
+    );
+    fprintf(
+        out,
+        "    unsigned long i0 = _%sarray_merge_split(sort->src + lo, mid - lo, sort->src + mid, hi - mid, k0);\n"
+        "    unsigned long i1 = _%sarray_merge_split(sort->src + lo, mid - lo, sort->src + mid, hi - mid, k1);\n"
+        "    _%sarray_merge(sort->dst + lo + k0, sort->src + lo + i0, i1 - i0, sort->src + mid + (k0 - i0), (k1 - i1) - (k0 - i0));\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.all_lower,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "void _%sarray_parallel_sort_copy_back(void * ctx, unsigned long index) {\n"
+        "    _%sParallelSort * sort = ctx;\n"
+        "    unsigned long lo = (unsigned long)_core_parallel_split(sort->len, sort->pieces, index);\n"
+        "    unsigned long hi = (unsigned long)_core_parallel_split(sort->len, sort->pieces, index + 1);\n"
+        "    memcpy(sort->items + lo, sort->src + lo, (hi - lo) * sizeof(sort->items[0]));\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal
+    );
+    fprintf(
+        out,
+        "/*stable merge sort, a NULL pool sorts on the calling thread. the result is the same for any pool*/\n"
+        "void %sarray_parallel_sort(%s * items, unsigned long len, core_ThreadPool * pool) {\n"
+        "    unsigned long threads = core_thread_pool_thread_count(pool);\n"
+        "    unsigned long runs = len / CORE_PARALLEL_GRAIN < threads ? len / CORE_PARALLEL_GRAIN : threads;\n"
+        "    _%sParallelSort sort;\n"
+        "    %s * tmp = NULL;\n"
+        "    if(len < 2) return;\n",
+        cases.all_lower,
+        cases.typename,
+        cases.pascal,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "    if(len > (unsigned long)-1 / sizeof(items[0])) {\n"
+        "        CORE_FATAL_ERROR(\"parallel sort size overflow\");\n"
+        "    }\n"
+        "    memset(&sort, 0, sizeof(sort));\n"
+        "    sort.items = items;\n"
+        "    sort.scratch = malloc(len * sizeof(items[0]));\n"
+        "    if(sort.scratch == NULL) {\n"
+        "        CORE_FATAL_ERROR(\"parallel sort out of memory\");\n"
+        "    }\n"
+    );
+    fprintf(
+        out,
+        "    sort.len = len;\n"
+        "    if(runs == 0) runs = 1;\n"
+        "    sort.width = (len + runs - 1) / runs;\n"
+        "    runs = (len + sort.width - 1) / sort.width;\n"
+        "    core_thread_pool_run(pool, _%sarray_parallel_sort_runs, &sort, runs);\n"
+        "    sort.src = items;\n"
+        "    sort.dst = sort.scratch;\n",
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "    while(sort.width < len) {\n"
+        "        runs = (len - 1) / (2 * sort.width) + 1;\n"
+        "        sort.pieces = (threads + runs - 1) / runs;\n"
+        "        core_thread_pool_run(pool, _%sarray_parallel_sort_merge, &sort, runs * sort.pieces);\n"
+        "        tmp = sort.src;\n"
+        "        sort.src = sort.dst;\n"
+        "        sort.dst = tmp;\n"
+        "        sort.width = sort.width > (len + 1) / 2 ? len : sort.width * 2;\n"
+        "    }\n",
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "    if(sort.src != items) {\n"
+        "        sort.pieces = threads;\n"
+        "        core_thread_pool_run(pool, _%sarray_parallel_sort_copy_back, &sort, threads);\n"
+        "    }\n"
+        "    free(sort.scratch);\n"
+        "}\n"
+        "\n"
+        "void %sarray_stable_sort(%s * items, unsigned long len) {\n"
+        "    %sarray_parallel_sort(items, len, NULL);\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.all_lower,
+        cases.typename,
+        cases.all_lower
+    );
+
+    fprintf(
+        out,
+        "#ifdef _%sVEC_\n"
+        "void %svec_parallel_sort(%sVec * vec, core_ThreadPool * pool) {\n"
+        "    %sarray_parallel_sort(vec->items, vec->len, pool);\n"
+        "}\n"
+        "\n"
+        "void %svec_stable_sort(%sVec * vec) {\n"
+        "    %sarray_stable_sort(vec->items, vec->len);\n"
+        "}\n"
+        "#endif /*_%sVEC_*/\n"
+        "\n",
+        cases.all_caps,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.all_caps
+    );
+
+    fprintf(out, "#endif /*CORE_THREADS_AVAILABLE*/\n");
+    fprintf(out, "#endif /*_%sPARALLEL_SORT_*/\n\n", cases.all_caps);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*inclusive and exclusive prefix sums spread over a core_ThreadPool, for types with + and 0.
+  the parallel version adds in blocks of CORE_PARALLEL_GRAIN items, so the results are identical
+  for every pool. integer sums do not depend on the grouping and the sequential version scans
+  them in one pass, floating point types are scanned in the same blocks as the parallel version*/
+void core_staged_parallel_prefix_sum_generate(FILE * out, const char * prefix, const char * typename)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_StagedNameCases cases = {0};
+    _core_staged_name_cases_derive(prefix, typename, &cases);
+
+    fprintf(out, "#ifndef _%sPARALLEL_PREFIX_SUM_\n", cases.all_caps);
+    fprintf(out, "#define _%sPARALLEL_PREFIX_SUM_\n\n", cases.all_caps);
+    fprintf(out, "#ifdef CORE_THREADS_AVAILABLE\n");
+    fprintf(
+        out,
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "#include <assert.h>\n\n"
+    );
+
+    fprintf(
+        out,
+        "/*out[i] is the sum of in[0..i] when inclusive and of in[0..i) otherwise. in may equal out.\n"
+        "  floating point blocks are totalled before they are scanned, the same additions the parallel\n"
+        "  version does. integer types, where 0.5 truncates to 0, take a single pass*/\n"
+        "void %sarray_prefix_sum(const %s * in, %s * out, unsigned long len, core_Bool inclusive) {\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "    const core_Bool blocked = (%s)0.5 > 0;\n"
+        "    unsigned long lo = 0;\n"
+        "    unsigned long hi = 0;\n"
+        "    unsigned long i = 0;\n"
+        "    %s offset = 0;\n"
+        "    %s total;\n"
+        "    %s acc;\n"
+        "    %s item;\n",
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "    for(lo = 0; lo < len; lo = hi) {\n"
+        "        hi = !blocked || len - lo < CORE_PARALLEL_GRAIN ? len : lo + CORE_PARALLEL_GRAIN;\n"
+        "        total = 0;\n"
+        "        if(blocked) for(i = lo; i < hi; ++i) total += in[i];\n"
+        "        acc = offset;\n"
+        "        for(i = lo; i < hi; ++i) {\n"
+        "            item = in[i];\n"
+        "            if(inclusive) acc += item;\n"
+        "            out[i] = acc;\n"
+        "            if(!inclusive) acc += item;\n"
+        "        }\n"
+        "        offset += total;\n"
+        "    }\n"
+        "}\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "typedef struct {\n"
+        "    const %s * in;\n"
+        "    %s * out;\n"
+        "    unsigned long len;\n"
+        "    unsigned long blocks;\n"
+        "    core_Bool inclusive;\n"
+        "    %s * sums;\n"
+        "} _%sParallelPrefixSum;\n"
+        "\n",
+        cases.typename,
+        cases.typename,
+        cases.typename,
+        cases.pascal
+    );
+    fprintf(
+        out,
+        "void _%sarray_parallel_prefix_sum_total(void * ctx, unsigned long index) {\n"
+        "    _%sParallelPrefixSum * scan = ctx;\n"
+        "    unsigned long lo = index * CORE_PARALLEL_GRAIN;\n"
+        "    unsigned long hi = scan->len - lo < CORE_PARALLEL_GRAIN ? scan->len : lo + CORE_PARALLEL_GRAIN;\n"
+        "    %s acc = 0;\n"
+        "    for(; lo < hi; ++lo) acc += scan->in[lo];\n"
+        "    scan->sums[index] = acc;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "/*carries on from the sum of every block before this one*/\n"
+        "void _%sarray_parallel_prefix_sum_scan(void * ctx, unsigned long index) {\n"
+        "    _%sParallelPrefixSum * scan = ctx;\n"
+        "    unsigned long lo = index * CORE_PARALLEL_GRAIN;\n"
+        "    unsigned long hi = scan->len - lo < CORE_PARALLEL_GRAIN ? scan->len : lo + CORE_PARALLEL_GRAIN;\n"
+        "    %s acc = scan->sums[index];\n"
+        "    %s item;\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "    for(; lo < hi; ++lo) {\n"
+        "        item = scan->in[lo];\n"
+        "        if(scan->inclusive) acc += item;\n"
+        "        scan->out[lo] = acc;\n"
+        "        if(!scan->inclusive) acc += item;\n"
+        "    }\n"
+        "}\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "void %sarray_parallel_prefix_sum(const %s * in, %s * out, unsigned long len, core_Bool inclusive, core_ThreadPool * pool) {\n"
+        "    _%sParallelPrefixSum scan;\n"
+        "    unsigned long i = 0;\n"
+        "    %s running = 0;\n"
+        "    %s tmp;\n"
+        "    if(len == 0) return;\n"
+        "    memset(&scan, 0, sizeof(scan));\n"
+        "    scan.in = in;\n"
+        "    scan.out = out;\n"
+        "    scan.len = len;\n"
+        "    scan.inclusive = inclusive;\n",
+        cases.all_lower,
+        cases.typename,
+        cases.typename,
+        cases.pascal,
+        cases.typename,
+        cases.typename
+    );
+    fprintf(
+        out,
+        "    scan.blocks = (len - 1) / CORE_PARALLEL_GRAIN + 1;\n"
+        "    scan.sums = malloc(scan.blocks * sizeof(scan.sums[0]));\n"
+        "    if(scan.sums == NULL) {\n"
+        "        CORE_FATAL_ERROR(\"parallel prefix sum out of memory\");\n"
+        "    }\n"
+        "    core_thread_pool_run(pool, _%sarray_parallel_prefix_sum_total, &scan, scan.blocks - 1);\n"
+        "    for(i = 0; i + 1 < scan.blocks; ++i) {\n"
+        "        tmp = scan.sums[i];\n"
+        "        scan.sums[i] = running;\n"
+        "        running += tmp;\n"
+        "    }\n",
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "    scan.sums[scan.blocks - 1] = running;\n"
+        "    core_thread_pool_run(pool, _%sarray_parallel_prefix_sum_scan, &scan, scan.blocks);\n"
+        "    free(scan.sums);\n"
+        "}\n"
+        "\n",
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "#ifdef _%sVEC_\n"
+        "void %svec_parallel_prefix_sum(%sVec * vec, core_Bool inclusive, core_ThreadPool * pool) {\n"
+        "    %sarray_parallel_prefix_sum(vec->items, vec->items, vec->len, inclusive, pool);\n"
+        "}\n"
+        "\n"
+        "void %svec_prefix_sum(%sVec * vec, core_Bool inclusive) {\n"
+        "    %sarray_prefix_sum(vec->items, vec->items, vec->len, inclusive);\n"
+        "}\n"
+        "#endif /*_%sVEC_*/\n"
+        "\n",
+        cases.all_caps,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.all_caps
+    );
+
+    fprintf(out, "#endif /*CORE_THREADS_AVAILABLE*/\n");
+    fprintf(out, "#endif /*_%sPARALLEL_PREFIX_SUM_*/\n\n", cases.all_caps);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
+
+/*typed open addressing hashmap with keys and values stored inline, named <prefix><Key>To<Value>Map.
+  hash_fn takes a key and returns an unsigned long, NULL casts the key itself so it suits integer and
+  pointer keys. eq_fn compares two keys, NULL compares with ==. hashes get a finalizer mixed in, so a
+  weak hash_fn still spreads over the table. entries keep their hash, so growing and removal never
+  rehash keys. removal uses backward shift deletion, no tombstones*/
+void core_staged_hashmap_generate(FILE * out, const char * prefix, const char * key_type, const char * value_type, const char * hash_fn, const char * eq_fn)
+#ifdef CORE_IMPLEMENTATION
+{
+    core_StagedNameCases cases = {0};
+    char name[CORE_STAGED_NAME_LEN_MAX];
+    assert(strlen(key_type) + strlen(value_type) + strlen(" to ") < CORE_STAGED_NAME_LEN_MAX);
+    sprintf(name, "%s to %s", key_type, value_type);
+    _core_staged_name_cases_derive(prefix, name, &cases);
+
+    fprintf(out, "#ifndef _%sMAP_\n", cases.all_caps);
+    fprintf(out, "#define _%sMAP_\n\n", cases.all_caps);
+    fprintf(
+        out,
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "#include <limits.h>\n"
+        "#include <assert.h>\n\n"
+    );
+    _core_staged_check_generate(out);
+
+    if(hash_fn == NULL) {
+        fprintf(out, "#define %s_MAP_HASH(key) (_%smap_hash_mix((unsigned long)(size_t)(key)))\n", cases.all_caps, cases.all_lower);
+    } else {
+        fprintf(out, "#define %s_MAP_HASH(key) (_%smap_hash_mix((unsigned long)%s(key)))\n", cases.all_caps, cases.all_lower, hash_fn);
+    }
+    if(eq_fn == NULL) {
+        fprintf(out, "#define %s_MAP_EQ(a, b) ((a) == (b))\n", cases.all_caps);
+    } else {
+        fprintf(out, "#define %s_MAP_EQ(a, b) (%s(a, b))\n", cases.all_caps, eq_fn);
+    }
+    fprintf(
+        out,
+        "/*0 marks an empty slot, full ones hold the high bit and the top 7 bits of the hash*/\n"
+        "#define %s_MAP_CTRL(hash) ((unsigned char)(0x80 | ((hash) >> (sizeof(unsigned long) * CHAR_BIT - 7))))\n\n",
+        cases.all_caps
+    );
+
+    fprintf(
+        out,
+        "typedef struct {\n"
+        "    unsigned long hash;\n"
+        "    %s key;\n"
+        "    %s value;\n"
+        "} %sMapEntry;\n"
+        "\n"
+        "/*entries and ctrl share one block, cap is 0 or a power of two*/\n"
+        "typedef struct {\n"
+        "    unsigned char * ctrl;\n"
+        "    %sMapEntry * entries;\n"
+        "    unsigned long len;\n"
+        "    unsigned long cap;\n"
+        "} %sMap;\n"
+        "\n",
+        key_type,
+        value_type,
+        cases.pascal,
+        cases.pascal,
+        cases.pascal
+    );
+    fprintf(
+        out,
+        "unsigned long _%smap_hash_mix(unsigned long hash) {\n"
+        "#if ULONG_MAX > 0xffffffffUL\n"
+        "    hash ^= hash >> 33;\n"
+        "    hash *= 0xff51afd7ed558ccdUL;\n"
+        "    hash ^= hash >> 33;\n"
+        "    hash *= 0xc4ceb9fe1a85ec53UL;\n"
+        "    hash ^= hash >> 33;\n"
+        "#else\n"
+        "    hash ^= hash >> 16;\n"
+        "    hash *= 0x85ebca6bUL;\n"
+        "    hash ^= hash >> 13;\n"
+        "    hash *= 0xc2b2ae35UL;\n"
+        "    hash ^= hash >> 16;\n"
+        "#endif\n"
+        "    return hash;\n"
+        "}\n"
+        "\n",
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "/*slot holding key, or the empty slot where it would go*/\n"
+        "unsigned long _%smap_probe(const %sMap * map, %s key, unsigned long hash) {\n"
+        "    const unsigned long mask = map->cap - 1;\n"
+        "    const unsigned char ctrl = %s_MAP_CTRL(hash);\n"
+        "    unsigned long i = hash & mask;\n"
+        "    for(; map->ctrl[i] != 0; i = (i + 1) & mask) {\n"
+        "        if(map->ctrl[i] != ctrl || map->entries[i].hash != hash) continue;\n"
+        "        if(%s_MAP_EQ(map->entries[i].key, key)) break;\n"
+        "    }\n"
+        "    return i;\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        key_type,
+        cases.all_caps,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "/*grows the table so count entries fit below 3/4 full*/\n"
+        "void %smap_reserve(%sMap * map, unsigned long count) {\n"
+        "    %sMap new = {0};\n"
+        "    unsigned long i = 0;\n"
+        "    unsigned long j = 0;\n"
+        "    CORE_STAGED_CHECK(count <= (unsigned long)-1 / 4, \"map capacity overflow\");\n"
+        "    if(map->cap != 0 && count * 4 <= map->cap * 3) return;\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.pascal
+    );
+    fprintf(
+        out,
+        "    new.cap = map->cap == 0 ? 16 : map->cap;\n"
+        "    while(count * 4 > new.cap * 3) {\n"
+        "        CORE_STAGED_CHECK(new.cap <= (unsigned long)-1 / 2 / (sizeof(new.entries[0]) + 1), \"map capacity overflow\");\n"
+        "        new.cap *= 2;\n"
+        "    }\n"
+        "    new.len = map->len;\n"
+        "    new.entries = malloc(new.cap * (sizeof(new.entries[0]) + 1));\n"
+        "    CORE_STAGED_CHECK(new.entries != NULL, \"map allocation failed\");\n"
+        "    new.ctrl = (unsigned char *)(new.entries + new.cap);\n"
+        "    memset(new.ctrl, 0, new.cap);\n"
+    );
+    fprintf(
+        out,
+        "    for(i = 0; i < map->cap; ++i) {\n"
+        "        if(map->ctrl[i] == 0) continue;\n"
+        "        for(j = map->entries[i].hash & (new.cap - 1); new.ctrl[j] != 0; j = (j + 1) & (new.cap - 1));\n"
+        "        new.ctrl[j] = map->ctrl[i];\n"
+        "        new.entries[j] = map->entries[i];\n"
+        "    }\n"
+        "    free(map->entries);\n"
+        "    *map = new;\n"
+        "}\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "%s * %smap_get(const %sMap * map, %s key) {\n"
+        "    unsigned long i = 0;\n"
+        "    if(map->len == 0) return NULL;\n"
+        "    i = _%smap_probe(map, key, %s_MAP_HASH(key));\n"
+        "    return map->ctrl[i] == 0 ? NULL : &map->entries[i].value;\n"
+        "}\n"
+        "\n",
+        value_type,
+        cases.all_lower,
+        cases.pascal,
+        key_type,
+        cases.all_lower,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "void %smap_set(%sMap * map, %s key, %s value) {\n"
+        "    const unsigned long hash = %s_MAP_HASH(key);\n"
+        "    unsigned long i = 0;\n"
+        "    if(map->cap != 0) {\n"
+        "        i = _%smap_probe(map, key, hash);\n"
+        "        if(map->ctrl[i] != 0) {\n"
+        "            map->entries[i].value = value;\n"
+        "            return;\n"
+        "        }\n"
+        "    }\n"
+        "    if(map->cap == 0 || (map->len + 1) * 4 > map->cap * 3) {\n"
+        "        %smap_reserve(map, map->len + 1);\n"
+        "        i = _%smap_probe(map, key, hash);\n"
+        "    }\n",
+        cases.all_lower,
+        cases.pascal,
+        key_type,
+        value_type,
+        cases.all_caps,
+        cases.all_lower,
+        cases.all_lower,
+        cases.all_lower
+    );
+    fprintf(
+        out,
+        "    map->ctrl[i] = %s_MAP_CTRL(hash);\n"
+        "    map->entries[i].hash = hash;\n"
+        "    map->entries[i].key = key;\n"
+        "    map->entries[i].value = value;\n"
+        "    map->len++;\n"
+        "}\n"
+        "\n",
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "/*returns 1 if key was there. later entries of the probe run are shifted back into the hole\n"
+        "  unless that would put them before their home slot*/\n"
+        "int %smap_remove(%sMap * map, %s key) {\n"
+        "    unsigned long mask = 0;\n"
+        "    unsigned long home = 0;\n"
+        "    unsigned long i = 0;\n"
+        "    unsigned long j = 0;\n"
+        "    if(map->len == 0) return 0;\n"
+        "    i = _%smap_probe(map, key, %s_MAP_HASH(key));\n"
+        "    if(map->ctrl[i] == 0) return 0;\n"
+        "    mask = map->cap - 1;\n",
+        cases.all_lower,
+        cases.pascal,
+        key_type,
+        cases.all_lower,
+        cases.all_caps
+    );
+    fprintf(
+        out,
+        "    for(j = (i + 1) & mask; map->ctrl[j] != 0; j = (j + 1) & mask) {\n"
+        "        home = map->entries[j].hash & mask;\n"
+        "        if(((j - home) & mask) >= ((j - i) & mask)) {\n"
+        "            map->ctrl[i] = map->ctrl[j];\n"
+        "            map->entries[i] = map->entries[j];\n"
+        "            i = j;\n"
+        "        }\n"
+        "    }\n"
+        "    map->ctrl[i] = 0;\n"
+        "    map->len--;\n"
+        "    return 1;\n"
+        "}\n"
+        "\n"
+    );
+    fprintf(
+        out,
+        "void %smap_clear(%sMap * map) {\n"
+        "    if(map->cap != 0) memset(map->ctrl, 0, map->cap);\n"
+        "    map->len = 0;\n"
+        "}\n"
+        "\n"
+        "void %smap_free(%sMap * map) {\n"
+        "    free(map->entries);\n"
+        "    memset(map, 0, sizeof(*map));\n"
+        "}\n"
+        "\n",
+        cases.all_lower,
+        cases.pascal,
+        cases.all_lower,
+        cases.pascal
+    );
+
+    fprintf(out, "#endif /*_%sMAP_*/\n\n", cases.all_caps);
+}
+#else
+;
+#endif /*CORE_IMPLEMENTATION*/
@@ -56,7 +56,7 @@ int main(void) {
     core_StrVec strs = {0};
     core_Arena a = {0};
     char * file = core_file_read_all_arena(&a, "core.h");
-    int i;
+    core_VecLen i;
     core_indentifier_match(&a, file, "core_", &strs);
     core_indentifier_match(&a, file, "CORE_", &strs);
     qsort(&strs.items[0], (size_t)strs.len, sizeof(strs.items[0]), core_compare_string);